@@ -6,6 +6,7 @@
 #include <memory>
 #include <multibeep/util/posteriors.hpp>
 #include <multibeep/util/reward_predictor.hpp>
+#include <multibeep/util/serialization.hpp>
 
 namespace multibeep{ namespace arms{
 
@@ -14,6 +15,15 @@ namespace multibeep{ namespace arms{
 		public:
 			/*\brief pulls arm and returns reward */
 			virtual num_t pull() = 0;
+			/*\brief pulls the arm n times and writes the rewards into the provided array
+			 *
+			 * Arms that can produce several rewards cheaper at once (e.g. arms calling
+			 * into Python) should override this.
+			 */
+			virtual void pull_batch(unsigned int n, num_t * rewards){
+				for (auto i=0u; i < n; ++i)
+					rewards[i] = pull();
+			}
 			/*\brief known real mean of the arm to compute regrets*/
 			virtual num_t real_mean() const = 0;
 			/*\brief known variance of the arm; not really necessary*/
@@ -22,6 +32,9 @@ namespace multibeep{ namespace arms{
 			virtual std::string get_ident() const = 0;
 			
 			virtual bool provides_posterior() const { return(false);}
+
+			/* \brief whether pulling the arm calls back into Python, i.e. needs the GIL*/
+			virtual bool calls_python() const { return(false);}
 			
 			virtual std::shared_ptr<multibeep::util::posteriors::base<num_t, rng_t> > posterior() const {
 				//TODO: insert ident into the string for better error messages
@@ -30,6 +43,14 @@ namespace multibeep{ namespace arms{
 			
 			/* \brief function allowing some tear-down when the arm is deactivated*/
 			virtual void deactivate () {}
+
+			/* \brief writes the internal state of the arm (not its parameters) for a checkpoint of the bandit
+			 *
+			 * Random number generators are shared between arms and are not part of the state.
+			 */
+			virtual void save(multibeep::util::serialization::writer &) const {}
+			/* \brief restores the state written by save into an arm constructed with the same parameters*/
+			virtual void load(multibeep::util::serialization::reader &) {}
 			
 			virtual ~base() {}
 	};
@@ -31,6 +31,12 @@ class bernoulli_arm: public multibeep::arms::base< num_t, rng_t >{
 		virtual num_t real_mean()		const	{return(rand_dist.p());	}
 		virtual num_t real_variance()	const	{return(rand_dist.p() * (1-rand_dist.p()));}
 		virtual std::string get_ident()	const	{return("Bernoulli");}
+
+		virtual void save(multibeep::util::serialization::writer &w) const {w.write(N0); w.write(N1);}
+		virtual void load(multibeep::util::serialization::reader &r){
+			N0 = r.read<unsigned long long int>();
+			N1 = r.read<unsigned long long int>();
+		}
 		
 		virtual bool provides_posterior()	const	final {return(true);}
 
@@ -53,6 +59,11 @@ class bernoulli_arm: public multibeep::arms::base< num_t, rng_t >{
 					else ++N1;
 					update_posteriors();
 				} 
+
+				virtual multibeep::util::posteriors::family get_family() const {return(multibeep::util::posteriors::family::beta);}
+				virtual std::pair<num_t, num_t> family_parameters() const {
+					return(std::pair<num_t, num_t>(base_t::posterior_dist.alpha(), base_t::posterior_dist.beta()));
+				}
 		};
 
 
@@ -2,56 +2,73 @@
 #define MULTIBEEP_ARM_DATA
 #include <algorithm>
 #include <random>
+#include <vector>
+#include <memory>
+#include <limits>
+#include <stdexcept>
 
 #include "multibeep/arm/arm.hpp"
 #include "multibeep/util/statistics.hpp"
+#include "multibeep/util/data_matrix.hpp"
 
 namespace multibeep{ namespace arms{
+	/* \brief arm returning the values of one column of a data matrix
+	 *
+	 * The arm only views the column; the matrix is shared by all arms created
+	 * from it and stays alive as long as any of them exists.
+	 */
 	template< bool bootstrap, typename num_t = double, typename rng_t = std::default_random_engine>
-	class data_arm: public base<num_t>{	
+	class data_arm: public base<num_t, rng_t>{	
 
 		std::shared_ptr<rng_t> rng_ptr;
 		std::uniform_int_distribution<unsigned int> u;
 
+		std::shared_ptr<const multibeep::util::data_matrix<num_t> > matrix_ptr;
+		const num_t * values;
+		unsigned int num_values;
+
 		num_t real_mean_ = NAN;
 		num_t real_variance_ = NAN;
 		unsigned int idx = std::numeric_limits<unsigned int>::max();
 		
-		std::vector<num_t> data;
 		std::string name;
 
 	public:
-		data_arm(	num_t * values, unsigned int num_values, std::string name,
-					std::shared_ptr<rng_t> r_ptr): rng_ptr(r_ptr),name(name){
-						
+		/* \brief views column j of a shared matrix without copying it*/
+		data_arm(	std::shared_ptr<const multibeep::util::data_matrix<num_t> > m_ptr, unsigned int j, std::string name,
+					std::shared_ptr<rng_t> r_ptr): rng_ptr(r_ptr), matrix_ptr(m_ptr), name(name){
+
+			if (j >= matrix_ptr->number_of_columns())
+				throw std::out_of_range("Column index exceeds the number of columns of the matrix");
+			if (matrix_ptr->number_of_rows() == 0)
+				throw std::invalid_argument("A data arm needs at least one value");
+
+			values = matrix_ptr->column(j);
+			num_values = matrix_ptr->number_of_rows();
 			u = std::uniform_int_distribution<unsigned int> (0, num_values-1);
-			data.reserve(num_values);
-			
-			multibeep::util::statistics::running_statistics<num_t> stat;
-			
-			for (auto i=0u; i < num_values; i++){
-				stat(values[i]);
-				data.push_back(values[i]);
-			}
 
-			real_mean_ = stat.mean();
-			real_variance_ = stat.variance();
+			real_mean_ = matrix_ptr->column_mean(j);
+			real_variance_ = matrix_ptr->column_variance(j);
 		}
+
+		/* \brief copies the values into a private one column matrix*/
+		data_arm(	num_t * values, unsigned int num_values, std::string name,
+					std::shared_ptr<rng_t> r_ptr):
+			data_arm(std::make_shared<multibeep::util::data_matrix<num_t> > (std::vector<num_t>(values, values+num_values), num_values, 1, 1),
+					0, name, r_ptr) {}
 	
 		
 		data_arm(	std::vector<double>& data,	std::string name,
 					std::shared_ptr<rng_t> r_ptr): data_arm( data.data(), data.size(), name, r_ptr){}
 		
 		virtual num_t pull(){
-			num_t v;
 			if (bootstrap){
 				idx = u(*rng_ptr);
 
 			}else{
-				idx = (idx+1)%data.size();
+				idx = (idx+1)%num_values;
 			}
-			v = data.at(idx);
-			return v;
+			return(values[idx]);
 		};
 		virtual num_t real_mean()		const	{return(real_mean_);}
 		virtual num_t real_variance()	const	{return(real_variance_);}
@@ -59,6 +76,10 @@ namespace multibeep{ namespace arms{
 		virtual bool provides_posterior()	const { return(false);}
 
 		std::string get_ident() const { return std::string("Data") + std::string(" ") + name;}
+
+		// the position in the column for sequential arms
+		virtual void save(multibeep::util::serialization::writer &w) const {w.write(idx);}
+		virtual void load(multibeep::util::serialization::reader &r) {idx = r.read<unsigned int>();}
 		
 	};
 	
@@ -77,6 +98,9 @@ namespace multibeep{ namespace arms{
 
 			data_arm_bootstrap(	num_t * data, unsigned int num_values, std::string name, std::shared_ptr<rng_t> r_ptr):
 				base_t(data, num_values, name, r_ptr){}
+
+			data_arm_bootstrap(	std::shared_ptr<const multibeep::util::data_matrix<num_t> > m_ptr, unsigned int j, std::string name, std::shared_ptr<rng_t> r_ptr):
+				base_t(m_ptr, j, name, r_ptr){}
 		
 	};
 
@@ -93,11 +117,32 @@ namespace multibeep{ namespace arms{
 
 			data_arm_sequential(	num_t * data, unsigned int num_values, std::string name, std::shared_ptr<rng_t> r_ptr):
 				base_t(data, num_values, name, r_ptr){}
+
+			data_arm_sequential(	std::shared_ptr<const multibeep::util::data_matrix<num_t> > m_ptr, unsigned int j, std::string name, std::shared_ptr<rng_t> r_ptr):
+				base_t(m_ptr, j, name, r_ptr){}
 		
 	};
 
 
 
+	/* \brief one arm per column of the matrix, all sharing its memory
+	 *
+	 * The arms are named after the columns.
+	 */
+	template<typename num_t = double, typename rng_t = std::default_random_engine>
+	std::vector<std::shared_ptr<base<num_t, rng_t> > > data_arms_from_matrix(
+				std::shared_ptr<const multibeep::util::data_matrix<num_t> > m_ptr, bool bootstrap, std::shared_ptr<rng_t> r_ptr){
+
+		std::vector<std::shared_ptr<base<num_t, rng_t> > > arms;
+		arms.reserve(m_ptr->number_of_columns());
+		for (auto j=0u; j < m_ptr->number_of_columns(); ++j){
+			if (bootstrap)
+				arms.emplace_back(new data_arm_bootstrap<num_t, rng_t> (m_ptr, j, m_ptr->column_name(j), r_ptr));
+			else
+				arms.emplace_back(new data_arm_sequential<num_t, rng_t> (m_ptr, j, m_ptr->column_name(j), r_ptr));
+		}
+		return(arms);
+	}
 
 }}
 #endif
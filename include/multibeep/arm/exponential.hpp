@@ -62,6 +62,9 @@ class exponential_arm: public multibeep::arms::base<num_t, rng_t>{
 		virtual double real_mean()		const	{return 1./(rand_dist.lambda());}
 		virtual double real_variance()	const	{return(1./(rand_dist.lambda()*rand_dist.lambda()));	}
 		virtual std::string get_ident()	const	{return "Exponential"; }
+
+		virtual void save(multibeep::util::serialization::writer &w) const {stats.save(w);}
+		virtual void load(multibeep::util::serialization::reader &r) {stats.load(r);}
 		virtual bool provides_posterior()	const {return(true);}
 
 
@@ -86,6 +86,9 @@ class normal_arm: public multibeep::arms::base<num_t, rng_t>{
 		virtual double real_mean()		const	{return (rand_dist.mean());}
 		virtual double real_variance()	const	{return (rand_dist.sigma()*rand_dist.sigma());}
 		virtual std::string get_ident()	const	{return "Normal";};
+
+		virtual void save(multibeep::util::serialization::writer &w) const {stats.save(w);}
+		virtual void load(multibeep::util::serialization::reader &r) {stats.load(r);}
 		
 		virtual bool provides_posterior() 	const	{return(true);}
 
@@ -2,6 +2,7 @@
 #define MULTIBEEP_ARM_PYTHONARM
 
 #include <string>
+#include <stdexcept>
 #include "arm.hpp"
 #include <multibeep/util/posteriors.hpp>
 
@@ -18,6 +19,9 @@ namespace multibeep{ namespace arms{
 			typedef std::shared_ptr<multibeep::util::posteriors::base<num_t, rng_t> > (*python_posterior_wrapper)(void*);
 			
 			typedef void (*python_deactivate_wrapper)(void*);
+
+			// wrapper for batched pulls; optional, returns 0 if python raised an exception
+			typedef int (*python_pull_batch_wrapper)(void*, unsigned int, num_t*);
 			
 			std::string name;
 			void * python_object;
@@ -26,6 +30,7 @@ namespace multibeep{ namespace arms{
 			python_pull_wrapper python_variance;	// here, but adding more types seems a bit too much
 			python_posterior_wrapper python_posterior;
 			python_deactivate_wrapper python_deactivate;
+			python_pull_batch_wrapper python_pull_batch;
 		
 		public:
 			python_arm( std::string n, void * po,
@@ -33,13 +38,28 @@ namespace multibeep{ namespace arms{
 						python_pull_wrapper p_mean,
 						python_pull_wrapper p_variance,
 						python_posterior_wrapper p_post,
-						python_deactivate_wrapper p_deactivate
+						python_deactivate_wrapper p_deactivate,
+						python_pull_batch_wrapper p_pull_batch = nullptr
 						):
 				name(n), python_object(po), python_pull(p_pull),
 				python_mean(p_mean), python_variance(p_variance),
-				python_posterior(p_post), python_deactivate(p_deactivate) {}
+				python_posterior(p_post), python_deactivate(p_deactivate),
+				python_pull_batch(p_pull_batch) {}
 		
 			virtual num_t pull(){ return(python_pull(python_object));}
+			/*\brief one call into python for all n rewards, if the python object supports it
+			 *
+			 * Throws if the python method failed, so the bandit does not record the rewards.
+			 * The python exception stays set and is raised by the python caller.
+			 */
+			virtual void pull_batch(unsigned int n, num_t * rewards){
+				if (python_pull_batch){
+					if (!python_pull_batch(python_object, n, rewards))
+						throw std::runtime_error("pull_batch of the python arm '" + name + "' failed");
+				}
+				else
+					base<num_t>::pull_batch(n, rewards);
+			}
 			/*\brief known real mean of the arm to compute regrets*/
 			virtual num_t real_mean() const {return(python_mean(python_object));};
 			/*\brief known variance of the arm; not really necessary*/
@@ -48,6 +68,7 @@ namespace multibeep{ namespace arms{
 			virtual std::string get_ident() const {return(name);};
 			
 			virtual bool provides_posterior()	const	final {return(true);}
+			virtual bool calls_python()			const	final {return(true);}
 			
 			virtual std::shared_ptr<typename multibeep::util::posteriors::base<num_t, rng_t> > posterior () const
 				{return(python_posterior(python_object));}
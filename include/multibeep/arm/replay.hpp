@@ -0,0 +1,89 @@
+#ifndef MULTIBEEP_ARM_REPLAY
+#define MULTIBEEP_ARM_REPLAY
+
+#include <vector>
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <stdexcept>
+
+#include "multibeep/arm/arm.hpp"
+#include "multibeep/util/statistics.hpp"
+#include "multibeep/util/pull_log.hpp"
+
+namespace multibeep{ namespace arms{
+
+	/* \brief thrown by a replay arm that has no recorded rewards left*/
+	class replay_exhausted: public std::runtime_error{
+		public:
+			replay_exhausted(): std::runtime_error("All recorded rewards of this arm have been replayed") {}
+	};
+
+
+	/* \brief arm returning previously recorded rewards in their original order
+	 *
+	 * Allows to play a policy offline against the rewards of an earlier run
+	 * without evaluating the arms again. A pull beyond the recorded rewards
+	 * throws replay_exhausted; the bandit is left unchanged in that case.
+	 */
+	template <typename num_t = double, typename rng_t = std::default_random_engine>
+	class replay_arm: public base<num_t, rng_t>{
+		std::vector<num_t> rewards;
+		unsigned int position;
+		std::string name;
+		multibeep::util::statistics::running_statistics<num_t> stats;
+
+	public:
+		replay_arm(std::vector<num_t> recorded_rewards, std::string name):
+			rewards(std::move(recorded_rewards)), position(0), name(name){
+			for (auto r: rewards) stats(r);
+		}
+
+		virtual num_t pull(){
+			if (position >= rewards.size()) throw replay_exhausted();
+			return(rewards[position++]);
+		}
+
+		virtual void pull_batch(unsigned int n, num_t * r){
+			if (position + n > rewards.size()) throw replay_exhausted();
+			std::copy(rewards.begin() + position, rewards.begin() + position + n, r);
+			position += n;
+		}
+
+		/* \brief mean of all recorded rewards*/
+		virtual num_t real_mean()		const {return(stats.mean());}
+		virtual num_t real_variance()	const {return(stats.variance());}
+
+		std::string get_ident() const {return(std::string("Replay ") + name);}
+
+		/* \brief number of recorded rewards not replayed yet*/
+		unsigned int remaining() const {return(rewards.size() - position);}
+
+		virtual void save(multibeep::util::serialization::writer &w) const {w.write(position);}
+		virtual void load(multibeep::util::serialization::reader &r) {position = r.read<unsigned int>();}
+	};
+
+
+	/* \brief one replay arm per identifier of the recorded bandit, in the order of the identifiers
+	 *
+	 * Adding the returned arms to an empty bandit reproduces the identifiers
+	 * of the recorded run. Arms that were never pulled get no rewards.
+	 */
+	template <typename num_t = double, typename rng_t = std::default_random_engine>
+	std::vector<std::shared_ptr<base<num_t, rng_t> > > replay_arms_from_log(const multibeep::util::pull_records<num_t> &records){
+		unsigned int n = 0;
+		for (auto id: records.identifier) n = std::max(n, id+1);
+
+		std::vector<std::vector<num_t> > rewards(n);
+		for (auto i=0u; i < records.size(); ++i)
+			rewards[records.identifier[i]].push_back(records.reward[i]);
+
+		std::vector<std::shared_ptr<base<num_t, rng_t> > > arms;
+		arms.reserve(n);
+		for (auto id=0u; id < n; ++id)
+			arms.emplace_back(new replay_arm<num_t, rng_t>(std::move(rewards[id]), std::to_string(id)));
+		return(arms);
+	}
+
+}}
+#endif
@@ -10,6 +10,7 @@
 #include <multibeep/util/statistics.hpp>
 #include <multibeep/util/posteriors.hpp>
 #include <multibeep/util/reward_predictor.hpp>
+#include <multibeep/util/latency_histogram.hpp>
 
 #include <multibeep/arm/arm.hpp>
 
@@ -21,14 +22,18 @@ template <typename num_t = double, typename rng_t = std::default_random_engine>
 class arm_info{
 	protected:
 		std::shared_ptr<multibeep::arms::base<num_t, rng_t> > arm_ptr;
+		// hands the arm to asynchronous workers, see base::arm_by_identifier
+		template <typename, typename> friend class base;
 	public:
 	
 		/* \brief a unique identifier for each arm*/
 		unsigned int identifier;
 		/* \brief indicator whether the arm is considered active*/
 		bool is_active;
-		/* \brief indicator whether the arm info needs to be updated*/
-		bool dirty;
+		/* \brief epoch of the bandit when the rewards last changed, see bandits::base::epoch*/
+		uint64_t version;
+		/* \brief the version the estimates and the posterior were computed for*/
+		uint64_t updated_version;
 		
 		/*\brief number of pulls for this arm. This could be an estimated number if a model-based bandit is used*/
 		long double num_pulls;
@@ -39,6 +44,16 @@ class arm_info{
 		
 		/* \brief probability that this arm has the highest mean reward*/
 		num_t p_max;
+
+		/* \brief which computation of the bandit p_max stems from, 0 if it was never computed*/
+		uint64_t p_max_version;
+
+		/* \brief number of pulls of the bandit since p_max was computed
+		 *
+		 * Only maintained while the bandit computes p_max in the background,
+		 * otherwise an outdated p_max is reported as NAN.
+		 */
+		unsigned int p_max_staleness;
 		
 		/* \brief access to the arms posterior via a pointer*/
 		std::shared_ptr<multibeep::util::posteriors::base<num_t, rng_t> > posterior;
@@ -59,16 +74,26 @@ class arm_info{
 		 */
 		num_t estimated_variance;
 
+		/* \brief wall-clock time of the pulls, if the bandit measures it
+		 *
+		 * See bandits::base::measure_pull_latency. The measurements are not part
+		 * of a checkpoint, they are only meaningful on the machine they were made.
+		 */
+		multibeep::util::latency_histogram pull_latency;
+
 
 		arm_info(std::shared_ptr<multibeep::arms::base<num_t, rng_t> >ptr, unsigned int ident): 
 			arm_ptr(ptr),
 			identifier(ident),
 			is_active(true),
-			dirty(true),
+			version(1),
+			updated_version(0),
 			num_pulls(0),
 			reward_stats(),
 			rewards(),
 			p_max(NAN),
+			p_max_version(0),
+			p_max_staleness(0),
 			estimated_mean(NAN),
 			estimated_variance(NAN)
 			{};
@@ -78,13 +103,34 @@ class arm_info{
 		 * Pulls and updates the rewards history and statistics*/
 		virtual double pull(){
 			double r = arm_ptr->pull();
+			add_reward(r);
+			return(r);
+		}
+
+		/* \brief records a reward that was obtained without calling pull, e.g. asynchronously */
+		virtual void add_reward(num_t r){
 			reward_stats(r);
 			rewards.push_back(r);
 			num_pulls++;
-			dirty = true;
-			return(r);
 		}
 
+		/* \brief pulls the underlying arm n times at once and updates the reward statistics
+		 *
+		 * The rewards are appended to the history in the order the arm returned them.
+		 */
+		virtual void pull_batch(unsigned int n, num_t * r){
+			arm_ptr->pull_batch(n, r);
+			rewards.reserve(rewards.size() + n);
+			for (auto i=0u; i < n; ++i){
+				reward_stats(r[i]);
+				rewards.push_back(r[i]);
+			}
+			num_pulls += n;
+		}
+
+		/* \brief whether the estimates and the posterior are outdated*/
+		bool dirty() const {return(updated_version != version);}
+
 		/*\brief access to the arm pointer for arm specific information
 		 * 
 		 * Note that the returned pointer is const, meaning the arm cannot
@@ -92,6 +138,42 @@ class arm_info{
 		 * bandit's pull method.
 		 */
 		std::shared_ptr<const multibeep::arms::base<num_t, rng_t> > get_arm_ptr() const {return(arm_ptr);}
+
+		/* \brief writes everything but the identifier (written by the bandit) and the posterior*/
+		void save(multibeep::util::serialization::writer &w) const {
+			w.write<uint8_t>(is_active);
+			w.write<double>(num_pulls);
+			reward_stats.save(w);
+			w.write_vector(rewards);
+			w.write(p_max);
+			w.write(estimated_mean);
+			w.write(estimated_variance);
+
+			// the arm's own state, length prefixed
+			multibeep::util::serialization::writer arm_state;
+			arm_ptr->save(arm_state);
+			w.write_string(arm_state.data());
+		}
+
+		/* \brief restores the state written by save
+		 *
+		 * The posterior is dropped; the bandit stamps a new version, so it is recomputed.
+		 */
+		void load(multibeep::util::serialization::reader &r){
+			is_active = r.read<uint8_t>();
+			num_pulls = r.read<double>();
+			reward_stats.load(r);
+			r.read_vector(rewards);
+			p_max = r.read<num_t>();
+			estimated_mean = r.read<num_t>();
+			estimated_variance = r.read<num_t>();
+
+			auto arm_state = r.read_string();
+			multibeep::util::serialization::reader arm_reader(arm_state);
+			arm_ptr->load(arm_reader);
+
+			posterior.reset();
+		}
 	
 };
 
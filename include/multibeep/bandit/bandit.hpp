@@ -6,10 +6,18 @@
 #include <memory>
 #include <algorithm>
 #include <limits>
+#include <stdexcept>
+#include <cmath>
 
 #include "multibeep/arm/arm.hpp"
 #include "multibeep/bandit/arm_info.hpp"
 #include "multibeep/util/p_max.hpp"
+#include "multibeep/util/serialization.hpp"
+#include "multibeep/util/pull_log.hpp"
+#include "multibeep/util/instrumentation.hpp"
+#include "multibeep/util/event_ring.hpp"
+#include "multibeep/util/background_pmax.hpp"
+#include "multibeep/recommender/recommender.hpp"
 
 
 namespace multibeep{ namespace bandits{
@@ -24,12 +32,123 @@ class base{
 		unsigned int num_pulled_arms;
 		num_t cummulative_reward;
 		std::vector<multibeep::bandits::arm_info<num_t, rng_t> >  arm_infos;
+		// increases with every change of an arm's rewards, stamped into its version
+		uint64_t current_epoch;
+		// number of active arms whose arm info is outdated
 		unsigned int num_dirty_arms;
+		// identifiers of the arms that became outdated or active since the last update_active_arm_infos, without duplicates
+		std::vector<unsigned int> changed_arms;
+		std::vector<bool> in_changed_arms;
+		// current index of every arm, by identifier
+		std::vector<unsigned int> positions;
+		// number of arms that call back into Python
+		unsigned int num_python_arms;
 		bool pmax_dirty;
+		// optional record of every pull
+		std::shared_ptr<multibeep::util::pull_log<num_t> > log_ptr;
+		// optional stream of events for an observer
+		std::shared_ptr<multibeep::util::event_ring<num_t> > events_ptr;
+		// optional computation of p_max on another thread
+		std::shared_ptr<multibeep::util::pmax::background_worker<num_t, rng_t> > pmax_worker_ptr;
+		// version of the latest p_max computation started, of the current p_max values, and the number of pulls they are based on
+		uint64_t pmax_counter, pmax_version, pmax_num_pulls;
+		// number of pulls when the latest snapshot was handed to the worker
+		int64_t snapshot_num_pulls;
+		// informed about every added arm, pull and p_max update
+		std::vector<std::shared_ptr<multibeep::recommender::base<num_t, rng_t> > > recommenders;
+		// whether the duration of every pull is recorded in the arm's latency histogram
+		bool measure_latency;
+		// optional counters and timings, see enable_stats
+		bool collect_stats;
+		multibeep::util::instrumentation::bandit_stats collected_stats;
+
+		/* \brief stores p_max values computed for the given identifiers in the arm infos*/
+		void set_p_max(const std::vector<unsigned int> &identifiers, const std::vector<num_t> &values, uint64_t version, uint64_t at_num_pulls){
+			std::vector<num_t> by_identifier(arm_infos.size(), NAN);
+			for (auto i=0u; i < identifiers.size(); ++i)
+				by_identifier[identifiers[i]] = values[i];
+			for (auto &ai: arm_infos){
+				ai.p_max = by_identifier[ai.identifier];
+				ai.p_max_version = version;
+			}
+			pmax_version = version;
+			pmax_num_pulls = at_num_pulls;
+			emit(multibeep::util::pmax_updated, identifiers.size());
+			for (auto &r: recommenders)
+				for (auto &ai: arm_infos)
+					r->pmax_updated(ai);
+		}
+
+		/* \brief hands the up-to-date arm info of a pulled arm to the recommenders*/
+		void report_pull(unsigned int index){
+			if (recommenders.empty()) return;
+			auto &ai = operator[](index);
+			for (auto &r: recommenders)
+				r->arm_pulled(ai);
+		}
+
+		/* \brief tells a recommender everything about all arms from scratch*/
+		void report_all(multibeep::recommender::base<num_t, rng_t> &r){
+			r.reset();
+			for (auto &ai: arm_infos)
+				r.arm_added(ai);
+			for (auto i=0u; i < arm_infos.size(); ++i){
+				if (arm_infos[i].num_pulls > 0)
+					r.arm_pulled(operator[](i));
+				r.pmax_updated(arm_infos[i]);
+			}
+		}
+
+		void emit(multibeep::util::event_type type, unsigned int identifier, num_t value = NAN){
+			if (events_ptr) events_ptr->push(num_pulls, type, identifier, value);
+		}
+
+		bool collecting_stats() const {return(multibeep::util::instrumentation::compiled_in && collect_stats);}
+
+		/* \brief remembers the arm for update_active_arm_infos*/
+		void mark_changed(unsigned int id){
+			if (in_changed_arms[id]) return;
+			in_changed_arms[id] = true;
+			changed_arms.push_back(id);
+		}
+
+		/* \brief records the indices of the arms in [first, last) after they were reordered*/
+		void update_positions(unsigned int first, unsigned int last){
+			for (auto i=first; i < last; ++i)
+				positions[arm_infos[i].identifier] = i;
+		}
+
+		/* \brief marks the arm info as outdated after its rewards changed*/
+		void touch(unsigned int index){
+			auto &ai = arm_infos[index];
+			if (!ai.dirty()){
+				if (ai.is_active) num_dirty_arms++;
+				mark_changed(ai.identifier);
+			}
+			ai.version = ++current_epoch;
+		}
+
+		/* \brief updates the arm info through update_arm_info if it is outdated*/
+		void refresh_arm_info(unsigned int index){
+			auto &ai = arm_infos.at(index);
+			if (!ai.dirty()) return;
+			if (collecting_stats()){
+				auto old_posterior = ai.posterior.get();
+				auto start = multibeep::util::instrumentation::clock::now();
+				update_arm_info(index);
+				collected_stats.arm_info_update_ns += multibeep::util::instrumentation::elapsed_ns(start);
+				collected_stats.num_arm_info_updates++;
+				if (ai.posterior && (ai.posterior.get() != old_posterior))
+					collected_stats.num_posterior_allocations++;
+			}
+			else update_arm_info(index);
+			ai.updated_version = ai.version;
+			if (ai.is_active) num_dirty_arms--;
+		}
 
 	public:
 	
-		base (): num_pulls(0), num_active_arms(0), num_pulled_arms(0), cummulative_reward(0), arm_infos(), num_dirty_arms(0), pmax_dirty(true) {}
+		base (): num_pulls(0), num_active_arms(0), num_pulled_arms(0), cummulative_reward(0), arm_infos(), current_epoch(0), num_dirty_arms(0), num_python_arms(0), pmax_dirty(true), pmax_counter(0), pmax_version(0), pmax_num_pulls(0), snapshot_num_pulls(-1), measure_latency(false), collect_stats(false) {}
 	
 		virtual ~base() {}
 	
@@ -43,14 +162,229 @@ class base{
 			unsigned int ident = arm_infos.size();
 			// add a copy of the arm
 			arm_infos.emplace_back(arm_ptr, ident);
+			arm_infos.back().version = ++current_epoch;
+			if (arm_ptr->calls_python()) num_python_arms++;
+			positions.push_back(ident);
+			in_changed_arms.push_back(false);
+			mark_changed(ident);
+			for (auto &r: recommenders)
+				r->arm_added(arm_infos.back());
 			// reorder arm_infos vector such that all active arms come first
 			std::partition(arm_infos.begin(), arm_infos.end(),
-						[] (multibeep::bandits::arm_info<num_t, rng_t> a) { return(a.is_active); });
+						[] (const multibeep::bandits::arm_info<num_t, rng_t> &a) { return(a.is_active); });
+			update_positions(0, arm_infos.size());
 			num_active_arms++;
 			num_dirty_arms++;
+			emit(multibeep::util::arm_added, ident);
 			return(ident);
 		}
+
+		/* \brief adds many arms at once
+		 *
+		 * Same as calling add_arm for every arm, but the arm infos are only
+		 * partitioned once. The arms get consecutive identifiers, the one of
+		 * the first arm is returned.
+		 */
+		unsigned int add_arms(const std::vector<std::shared_ptr<multibeep::arms::base<num_t,rng_t> > > &arm_ptrs){
+			unsigned int first = arm_infos.size();
+			arm_infos.reserve(first + arm_ptrs.size());
+			for (auto i=0u; i < arm_ptrs.size(); ++i){
+				arm_infos.emplace_back(arm_ptrs[i], first + i);
+				arm_infos.back().version = ++current_epoch;
+				if (arm_ptrs[i]->calls_python()) num_python_arms++;
+				positions.push_back(first + i);
+				in_changed_arms.push_back(false);
+				mark_changed(first + i);
+				for (auto &r: recommenders)
+					r->arm_added(arm_infos.back());
+			}
+			if (num_active_arms < first){
+				std::partition(arm_infos.begin(), arm_infos.end(),
+						[] (const multibeep::bandits::arm_info<num_t, rng_t> &a) { return(a.is_active); });
+				update_positions(0, arm_infos.size());
+			}
+			num_active_arms += arm_ptrs.size();
+			num_dirty_arms += arm_ptrs.size();
+			for (auto i=0u; i < arm_ptrs.size(); ++i)
+				emit(multibeep::util::arm_added, first + i);
+			return(first);
+		}
 		
+		/* \brief records every following pull (index, identifier, reward, time) in the given log
+		 *
+		 * The log can be shared by several bandits. Pass an empty pointer to stop recording.
+		 */
+		void set_pull_log(std::shared_ptr<multibeep::util::pull_log<num_t> > l_ptr){log_ptr = l_ptr;}
+
+		/* \brief pushes every following event (arm added, pulled, deactivated, reactivated, p_max updated) into the ring
+		 *
+		 * The ring is read by a single observer, possibly on another thread.
+		 * A full ring drops events, so observers never slow down the pulls.
+		 * The num_pulls of an event is the number of pulls before it happened.
+		 * Pass an empty pointer to stop.
+		 */
+		void set_event_ring(std::shared_ptr<multibeep::util::event_ring<num_t> > e_ptr){events_ptr = e_ptr;}
+
+		/* \brief computes p_max continuously with the given worker instead of on demand
+		 *
+		 * Whenever the worker is idle and the bandit was pulled since the last
+		 * snapshot, operator[] hands it the current posteriors, and it picks up
+		 * finished results, so the pulling thread never waits for an
+		 * integration. While a worker is set, operator[] keeps reporting the
+		 * latest p_max together with its version and staleness (number of pulls
+		 * since the snapshot) instead of NAN. A worker must only serve one
+		 * bandit. Pass an empty pointer to return to update_p_max.
+		 */
+		void set_background_pmax(std::shared_ptr<multibeep::util::pmax::background_worker<num_t, rng_t> > w_ptr){
+			pmax_worker_ptr = w_ptr;
+			snapshot_num_pulls = -1;
+		}
+
+		/* \brief picks up a finished background p_max computation and starts the next one if due
+		 *
+		 * Called by operator[]; the cost is one atomic load unless there is something to do.
+		 * If the computation failed, its exception is thrown once and the p_max
+		 * values stay as they were.
+		 */
+		void sync_background_pmax(){
+			if (!pmax_worker_ptr) return;
+			auto &w = *pmax_worker_ptr;
+			if (w.latest_version() > pmax_version){
+				auto s = w.take_result();
+				if (s && (s->version > pmax_version))
+					set_p_max(s->identifiers, s->p_max, s->version, s->num_pulls);
+			}
+			if ((snapshot_num_pulls != int64_t(num_pulls)) && (!w.is_busy())){
+				std::unique_ptr<multibeep::util::pmax::snapshot<num_t, rng_t> > s(new multibeep::util::pmax::snapshot<num_t, rng_t>());
+				s->version = ++pmax_counter;
+				s->num_pulls = num_pulls;
+				unsigned int n = (w.consider_inactive() ? arm_infos.size() : num_active_arms);
+				s->identifiers.reserve(n);
+				s->posteriors.reserve(n);
+				for (auto i=0u; i < n; ++i){
+					refresh_arm_info(i);
+					s->identifiers.push_back(arm_infos[i].identifier);
+					s->posteriors.push_back(arm_infos[i].posterior);
+				}
+				snapshot_num_pulls = num_pulls;
+				w.post(std::move(s));
+			}
+		}
+
+		/* \brief keeps the recommender up-to-date with every following change of the arms
+		 *
+		 * The recommender is told about all arms right away. It can be attached
+		 * to only one bandit at a time. While recommenders are attached, the
+		 * arm info of every pulled arm is updated immediately after the pull.
+		 */
+		void add_recommender(std::shared_ptr<multibeep::recommender::base<num_t, rng_t> > r_ptr){
+			report_all(*r_ptr);
+			recommenders.push_back(r_ptr);
+		}
+
+		/* \brief stops informing the recommender; nothing happens if it was not attached*/
+		void remove_recommender(std::shared_ptr<multibeep::recommender::base<num_t, rng_t> > r_ptr){
+			recommenders.erase(std::remove(recommenders.begin(), recommenders.end(), r_ptr), recommenders.end());
+		}
+
+		/* \brief starts/stops recording the wall-clock time of every pull in the arm_info's pull_latency
+		 *
+		 * Off by default; the cost-aware policies switch it on. Pulls of a batch
+		 * are recorded with the average duration, rewards added by identifier
+		 * are not timed.
+		 */
+		void measure_pull_latency(bool enable){measure_latency = enable;}
+
+		/* \brief starts/stops collecting counters and timings of the hot paths
+		 *
+		 * Off by default, because every timed section costs two clock reads.
+		 * Without effect if the library is compiled with MULTIBEEP_NO_STATS.
+		 */
+		void enable_stats(bool enable){collect_stats = enable;}
+
+		/* \brief the counters and timings collected so far*/
+		const multibeep::util::instrumentation::bandit_stats & get_stats() const {return(collected_stats);}
+
+		void reset_stats(){collected_stats = multibeep::util::instrumentation::bandit_stats();}
+
+		/* \brief writes the state of the bandit and all arm infos
+		 *
+		 * The arms themselves are not part of the state, only what they report
+		 * through their own save method. See checkpoint.
+		 */
+		virtual void save(multibeep::util::serialization::writer &w) const {
+			w.write(num_pulls);
+			w.write(num_active_arms);
+			w.write(num_pulled_arms);
+			w.write(cummulative_reward);
+			w.write<uint8_t>(pmax_dirty);
+
+			w.write<uint32_t>(arm_infos.size());
+			for (auto &ai: arm_infos){
+				w.write(ai.identifier);
+				ai.save(w);
+			}
+		}
+
+		/* \brief restores the state written by save
+		 *
+		 * The bandit must contain the same arms (constructed with the same
+		 * parameters and added in the same order) as the one that was saved.
+		 * If an exception is thrown, the bandit is left in an undefined state.
+		 */
+		virtual void load(multibeep::util::serialization::reader &r){
+			num_pulls = r.read<unsigned int>();
+			num_active_arms = r.read<unsigned int>();
+			num_pulled_arms = r.read<unsigned int>();
+			cummulative_reward = r.read<num_t>();
+			pmax_dirty = r.read<uint8_t>();
+
+			if (r.read<uint32_t>() != arm_infos.size())
+				throw std::invalid_argument("The snapshot belongs to a bandit with a different number of arms");
+
+			// bring the arm infos into the saved order
+			std::vector<unsigned int> index(arm_infos.size());
+			for (auto i=0u; i < arm_infos.size(); ++i)
+				index.at(arm_infos[i].identifier) = i;
+
+			std::vector<multibeep::bandits::arm_info<num_t, rng_t> > restored;
+			restored.reserve(arm_infos.size());
+			// a second occurrence would move from an arm info that was moved already
+			std::vector<bool> seen(arm_infos.size(), false);
+			for (auto i=0u; i < arm_infos.size(); ++i){
+				auto id = r.read<unsigned int>();
+				if ((id >= arm_infos.size()) || seen[id])
+					throw std::runtime_error("The snapshot contains an invalid identifier");
+				seen[id] = true;
+				restored.push_back(std::move(arm_infos[index[id]]));
+				restored.back().load(r);
+			}
+			arm_infos.swap(restored);
+			update_positions(0, arm_infos.size());
+			for (auto &ai: arm_infos){
+				ai.version = ++current_epoch;
+				if (ai.is_active) mark_changed(ai.identifier);
+			}
+			num_dirty_arms = num_active_arms;
+			for (auto &r: recommenders)
+				report_all(*r);
+		}
+
+		/* \brief a self-contained binary snapshot of the bandit's state, see save*/
+		std::string checkpoint() const {
+			multibeep::util::serialization::writer w;
+			w.write_header<num_t>(multibeep::util::serialization::bandit_snapshot);
+			save(w);
+			return(w.data());
+		}
+
+		/* \brief restores a snapshot created by checkpoint, e.g. directly from a memory mapped file*/
+		void restore(const char * data, size_t size){
+			multibeep::util::serialization::reader r(data, size);
+			r.read_header<num_t>(multibeep::util::serialization::bandit_snapshot);
+			load(r);
+		}
+
 		/* \brief deactivates an arm by the current index.
 		 * 
 		 * Inactive arms cannot be pulled, and most policies simply ignore them.
@@ -62,17 +396,21 @@ class base{
 			if (arm_infos.at(index).is_active){
 				// deactivate
 				arm_infos.at(index).is_active = false;
+				emit(multibeep::util::arm_deactivated, arm_infos[index].identifier);
+				for (auto &r: recommenders)
+					r->arm_deactivated(arm_infos[index]);
 
 				// adjust the number of dirty arms
-				if (arm_infos.at(index).dirty)	num_dirty_arms--;
+				if (arm_infos.at(index).dirty())	num_dirty_arms--;
 				
 				// reorder arm_infos vector such that all active arms come first
 				// only touch everything including and beyond the current arm
 				std::partition( arm_infos.begin() + index, arm_infos.begin() + num_active_arms,
-								[] (multibeep::bandits::arm_info<num_t, rng_t> a) { return(a.is_active); });				
-			}
+								[] (multibeep::bandits::arm_info<num_t, rng_t> a) { return(a.is_active); });
+				update_positions(index, num_active_arms);
 				// adjust number of active arms
 				--num_active_arms;
+			}
 		}
 		
 		/* \brief deactivates an arm by its unique identifier
@@ -90,6 +428,37 @@ class base{
 			}
 		}
 
+		/* \brief deactivates all arms with the given identifiers at once
+		 *
+		 * Cheaper than repeated calls to deactivate_by_identifier, because
+		 * the arms are partitioned only once. Unknown identifiers and already
+		 * inactive arms are ignored.
+		 */
+		void deactivate_by_identifiers (const std::vector<unsigned int> &ids){
+			if (ids.empty()) return;
+
+			// identifiers are assigned consecutively in add_arm
+			std::vector<bool> to_deactivate(arm_infos.size(), false);
+			for (auto id: ids)
+				if (id < to_deactivate.size()) to_deactivate[id] = true;
+
+			unsigned int n = num_active_arms;
+			for (auto i=0u; i < n; i++){
+				auto &ai = arm_infos[i];
+				if (to_deactivate[ai.identifier]){
+					ai.is_active = false;
+					emit(multibeep::util::arm_deactivated, ai.identifier);
+					for (auto &r: recommenders)
+						r->arm_deactivated(ai);
+					if (ai.dirty()) num_dirty_arms--;
+					--num_active_arms;
+				}
+			}
+			std::stable_partition( arm_infos.begin(), arm_infos.begin() + n,
+							[] (const multibeep::bandits::arm_info<num_t, rng_t> &a) { return(a.is_active); });
+			update_positions(0, n);
+		}
+
 		/* \brief deactivates all arms whose upper bound is lower than the highest lowest bond.
 		 * \param b_ptr a pointer to the bandit
 		 * \param delta the confidence value used to compute the lower and upper bounds from the posteriors
@@ -97,41 +466,27 @@ class base{
 		 */
 		void deactivate_by_confidence_gap (num_t delta, bool consider_inactive_arms){
 
-			// ids = identifiers
-			std::vector<unsigned int> ids(num_active_arms, 0);
-			// ubs = upper bounds
+			// ubs = upper bounds of the active arms
 			std::vector<num_t> ubs (num_active_arms, std::numeric_limits<num_t>::max());
 			// llb = largest lower bound
 			num_t llb = std::numeric_limits<num_t>::lowest();
 
-			unsigned int i;
+			unsigned int n = (consider_inactive_arms? number_of_arms() : num_active_arms);
 
-			for (i=0; i < num_active_arms; i++){
+			for (auto i=0u; i < n; i++){
 				const auto &ai = operator[](i);
-				ids[i] = ai.identifier;
-				num_t mew;
-				if (ai.posterior){
-					std::tie(mew, ubs[i]) = ai.posterior->support(delta);
-					llb = std::max(mew, llb);
-				}
-			}
-			
-			if (consider_inactive_arms){
-				for (; i < number_of_arms(); i++){
-					const auto &ai = operator[](i);
-					auto mew = ai.posterior->support(delta);
-					llb = std::max(mew.first, llb);
-				}
+				if (!ai.posterior) continue;
+				auto bounds = ai.posterior->support(delta);
+				llb = std::max(bounds.first, llb);
+				if (i < num_active_arms) ubs[i] = bounds.second;
 			}
-			
-			
-			
-			for (auto i=0u; i < ids.size(); i++){
-				if (ubs[i] < llb){
-					deactivate_by_identifier(ids[i]);
-				}
+
+			std::vector<unsigned int> ids;
+			for (auto i=0u; i < ubs.size(); i++){
+				if (ubs[i] < llb)
+					ids.push_back(arm_infos[i].identifier);
 			}
-			std::cout<<std::endl;
+			deactivate_by_identifiers(ids);
 		}
 
 		/* \brief deactivates all arms whose upper bound is lower than the highest lowest bond.
@@ -141,19 +496,18 @@ class base{
 		void deactivate_by_pmax_threshold (num_t delta){
 
 			// ids = identifiers
-			std::vector<unsigned int> ids();
+			std::vector<unsigned int> ids;
 			ids.reserve(num_active_arms);
 			
 			for (auto i=0u; i < num_active_arms; i++){
 				// only deactivate arms when pmax is actually computed
-				auto ai = operator[](i);
-				if (!std::isnan(ai.pmax))
-					if (ai.pmax < delta)
+				const auto &ai = operator[](i);
+				if (!std::isnan(ai.p_max))
+					if (ai.p_max < delta)
 						ids.push_back(ai.identifier);
 			}
 
-			for (auto i: ids)
-				deactivate_by_identifier(i);
+			deactivate_by_identifiers(ids);
 		}
 
 		/* \brief function to automatically remove the n arms with the lowest estimated mean*/
@@ -177,14 +531,25 @@ class base{
 			if (! arm_infos.at(index).is_active){
 				// reactivate
 				arm_infos.at(index).is_active = true;
+				emit(multibeep::util::arm_reactivated, arm_infos[index].identifier);
 				// adjust number of active arms
 				num_active_arms++;
 				
-				if (arm_infos.at(index).dirty) num_dirty_arms++;
+				if (arm_infos.at(index).dirty()){
+					num_dirty_arms++;
+					mark_changed(arm_infos[index].identifier);
+				}
+
+				if (!recommenders.empty()){
+					auto &ai = operator[](index);
+					for (auto &r: recommenders)
+						r->arm_reactivated(ai);
+				}
 				
 				// reorder arm_infos vector such that all active arms come first
 				std::partition(arm_infos.begin(), arm_infos.end(),
 					[] (multibeep::bandits::arm_info<num_t, rng_t> a) { return(a.is_active); } );
+				update_positions(0, arm_infos.size());
 			}
 		}
 
@@ -211,16 +576,67 @@ class base{
 		num_t pull_by_index (unsigned int index){
 			// only active arms can be pulled
 			if (!arm_infos.at(index).is_active) return(NAN);
-			if (arm_infos[index].num_pulls == 0) num_pulled_arms++;
+			// the arm is pulled first, so an arm throwing an exception leaves the bandit unchanged
+			bool first = (arm_infos[index].num_pulls == 0);
+			num_t r;
+			if (measure_latency || collecting_stats()){
+				auto start = multibeep::util::instrumentation::clock::now();
+				r = arm_infos[index].pull();
+				auto ns = multibeep::util::instrumentation::elapsed_ns(start);
+				if (measure_latency) arm_infos[index].pull_latency(ns);
+				if (collecting_stats()){
+					collected_stats.pull_ns += ns;
+					collected_stats.num_pulls++;
+				}
+			}
+			else r = arm_infos[index].pull();
+			if (first) num_pulled_arms++;
+			if (log_ptr) log_ptr->record(num_pulls, arm_infos[index].identifier, r);
+			emit(multibeep::util::arm_pulled, arm_infos[index].identifier, r);
 			num_pulls++;
-			num_t r = arm_infos[index].pull();
 			cummulative_reward += r;
-			num_dirty_arms++;
+			touch(index);
 			pmax_dirty = true;
+			report_pull(index);
 			return(r);
 		}
 
 
+		/* \brief pull selected arm n times in one go
+		 *
+		 * Equivalent to calling pull_by_index n times, but the arm can produce
+		 * the rewards in a single batch. Returns an empty vector if the arm is
+		 * inactive.
+		 */
+		std::vector<num_t> pull_batch_by_index (unsigned int index, unsigned int n){
+			std::vector<num_t> r;
+			if ((!arm_infos.at(index).is_active) || (n == 0)) return(r);
+			r.resize(n);
+			bool first = (arm_infos[index].num_pulls == 0);
+			if (measure_latency || collecting_stats()){
+				auto start = multibeep::util::instrumentation::clock::now();
+				arm_infos[index].pull_batch(n, r.data());
+				auto ns = multibeep::util::instrumentation::elapsed_ns(start);
+				if (measure_latency) arm_infos[index].pull_latency(ns/n, n);
+				if (collecting_stats()){
+					collected_stats.pull_ns += ns;
+					collected_stats.num_pulls += n;
+				}
+			}
+			else arm_infos[index].pull_batch(n, r.data());
+			if (first) num_pulled_arms++;
+			for (auto v: r){
+				if (log_ptr) log_ptr->record(num_pulls, arm_infos[index].identifier, v);
+				emit(multibeep::util::arm_pulled, arm_infos[index].identifier, v);
+				num_pulls++;
+				cummulative_reward += v;
+			}
+			touch(index);
+			pmax_dirty = true;
+			report_pull(index);
+			return(r);
+		}
+
 		/* \brief pull selected arm and receive reward.*/
 		num_t pull_by_identifier (unsigned int id){
 			for (auto i=0u; i < arm_infos.size(); i++)
@@ -229,22 +645,68 @@ class base{
 			return(NAN);
 		}
 
+		/* \brief records the reward of a pull that happened outside of the bandit
+		 *
+		 * Meant for arms evaluated asynchronously: the pull was started for this
+		 * arm earlier and its result arrives now. The reward counts like a regular
+		 * pull, even if the arm was deactivated in the meantime.
+		 */
+		void add_reward_by_identifier (unsigned int id, num_t r){
+			auto index = index_by_identifier(id);
+			if (index >= arm_infos.size())
+				throw std::invalid_argument("No arm with this identifier");
+			if (arm_infos[index].num_pulls == 0) num_pulled_arms++;
+			if (log_ptr) log_ptr->record(num_pulls, id, r);
+			emit(multibeep::util::arm_pulled, id, r);
+			num_pulls++;
+			arm_infos[index].add_reward(r);
+			cummulative_reward += r;
+			touch(index);
+			pmax_dirty = true;
+			report_pull(index);
+		}
+
+		/* \brief the arm with the given identifier, to be pulled outside of the bandit
+		 *
+		 * Pulling the returned arm records nothing; its reward has to be handed
+		 * to add_reward_by_identifier. This lets workers evaluate different arms
+		 * concurrently while the bandit itself is only accessed under a lock.
+		 * The pointer stays valid when the arms are reordered.
+		 */
+		std::shared_ptr<multibeep::arms::base<num_t,rng_t> > arm_by_identifier (unsigned int id){
+			auto index = index_by_identifier(id);
+			if (index >= arm_infos.size())
+				throw std::invalid_argument("No arm with this identifier");
+			return(arm_infos[index].arm_ptr);
+		}
+
+		/* \brief current index of the arm with the given identifier
+		 *
+		 * Returns number_of_arms() if there is no such arm. The index is only
+		 * valid until the next (de/re)activation or sort of the arms.
+		 */
+		unsigned int index_by_identifier (unsigned int id){
+			return(id < positions.size() ? positions[id] : arm_infos.size());
+		}
+
 		/* \brief makes sure each active arm is pulled a given number of times
 		 */
 		void min_pull_arms(unsigned int min_num_pulls){
 			for (auto i=0u; i < num_active_arms; i++){
 				while (operator[](i).num_pulls < min_num_pulls)
-					pull_by_index(i);
+					pull_batch_by_index(i, std::ceil(min_num_pulls - operator[](i).num_pulls));
 			}
 		}
 
+		/* \brief brings all active arm infos up-to-date, only visits the arms that changed since the last call*/
 		void update_active_arm_infos (){
-			for (auto i = 0u; i<num_active_arms; i++){
-				if (arm_infos[i].dirty)
-					update_arm_info(i);
-				if (num_dirty_arms == 0)
-					break;
+			// arms refreshed through operator[] or deactivated in the meantime are skipped
+			for (auto id: changed_arms){
+				in_changed_arms[id] = false;
+				auto index = positions[id];
+				if (index < num_active_arms) refresh_arm_info(index);
 			}
+			changed_arms.clear();
 		}
 
 		void sort_active_arms_by_mean(){
@@ -255,15 +717,52 @@ class base{
 				[] (const multibeep::bandits::arm_info<num_t, rng_t>& a, const multibeep::bandits::arm_info<num_t, rng_t> &b)
 				{return(a.estimated_mean > b.estimated_mean);}
 				);
+			update_positions(0, num_active_arms);
 		}
 
 		unsigned int number_of_arms() {return(arm_infos.size());}
 		unsigned int number_of_active_arms() {return(num_active_arms);}
 		
 		unsigned int number_of_pulls() {return(num_pulls);}
+
+		/* \brief increases whenever the rewards of an arm change
+		 *
+		 * An arm info is outdated while its version differs from the version
+		 * it was updated for, so observers can cache derived values and compare
+		 * the epoch to find out whether anything changed.
+		 */
+		uint64_t epoch() const {return(current_epoch);}
+
+		/* \brief number of active arms whose arm info is outdated*/
+		unsigned int number_of_dirty_arms() const {return(num_dirty_arms);}
 		unsigned int number_of_pulled_arms() {return(num_pulled_arms);}
-		
-		
+		/* \brief number of arms that call back into Python, see multibeep::arms::base::calls_python*/
+		unsigned int number_of_python_arms() const {return(num_python_arms);}
+
+		/* \brief writes the state of all arms into the given arrays in one pass
+		 *
+		 * Every array must hold number_of_arms() elements, which are filled in
+		 * the order of the current indices. Passing a nullptr skips that quantity.
+		 * Like operator[], p_max is NAN if it is not up-to-date.
+		 */
+		void get_state(	unsigned int *identifiers, bool *is_active, num_t *n_pulls,
+						num_t *estimated_means, num_t *estimated_variances, num_t *p_maxs){
+			for (auto i=0u; i < arm_infos.size(); ++i){
+				const auto &ai = operator[](i);
+				if (identifiers)			identifiers[i]			= ai.identifier;
+				if (is_active)				is_active[i]			= ai.is_active;
+				if (n_pulls)				n_pulls[i]				= ai.num_pulls;
+				if (estimated_means)		estimated_means[i]		= ai.estimated_mean;
+				if (estimated_variances)	estimated_variances[i]	= ai.estimated_variance;
+				if (p_maxs)					p_maxs[i]				= ai.p_max;
+			}
+		}
+
+		/* \brief recomputes the estimates and the posterior of the arm info at index
+		 *
+		 * Called through refresh_arm_info only if the arm info is outdated, which
+		 * also keeps track of its version.
+		 */
 		virtual void update_arm_info(unsigned int index) = 0;
 		
 		/* \brief only way to access the arm infos to decide which arm to pull next
@@ -273,19 +772,40 @@ class base{
 		 * doing batches of pulls from a stochastic policy without updating it
 		 */
 		const multibeep::bandits::arm_info<num_t, rng_t> &operator[] (unsigned int index){
-			if (num_dirty_arms > 0)
-				update_arm_info(index);
+			if (arm_infos[index].dirty())
+				refresh_arm_info(index);
+			if (pmax_worker_ptr){
+				sync_background_pmax();
+				arm_infos[index].p_max_staleness = num_pulls - pmax_num_pulls;
+			}
 			// overwrite the pmax value if it is not up-to-date
-			if (pmax_dirty)	arm_infos[index].p_max = NAN;
+			else if (pmax_dirty)	arm_infos[index].p_max = NAN;
 			return(arm_infos[index]);
 		}
 
+		/* \brief operator[] returning a pointer, for callers like Cython that cannot catch exceptions of functions returning references*/
+		const multibeep::bandits::arm_info<num_t, rng_t> * arm_info_ptr (unsigned int index){
+			return(&operator[](index));
+		}
+
+		/* \brief the rewards of the arm info at index, without refreshing its estimates
+		 *
+		 * The pointer is only valid until the next pull or reordering of the arms.
+		 */
+		const std::vector<num_t> * rewards_ptr (unsigned int index) const {
+			if (index >= arm_infos.size())
+				throw std::out_of_range("Arm index out of range");
+			return(&arm_infos[index].rewards);
+		}
+
 		/* \brief updates the p_max values of all (active) arms
 		 *
 		 * This computes the probability of every (active) arm of having
 		 * the largest mean based on the posteriors. This is computationally
 		 * quite expensive and is not called automatically after every pull or
-		 * before an arm_info is requested.
+		 * before an arm_info is requested. If all posteriors are Gaussian or all
+		 * are beta distributions, a faster specialized computation is used, see
+		 * multibeep::util::pmax::compute_pmax_all.
 		 *
 		 * \param consider_inactive	toggles whether the posteriors of the inactive arms are	also used, and their p_max value is computed
 		 * \param delta 			adjusts the integration interval. See multibeep::util::posterior::base::support for more information
@@ -293,10 +813,12 @@ class base{
 		 */
 		void update_p_max (bool consider_inactive, num_t delta, unsigned int GL_num_points){
 
+			auto start = multibeep::util::instrumentation::clock::now();
+
 			// make sure all arms are up-to-date and simultaniously
 			// overwrite the p_max entry with NAN
 			for (auto i=0u; i < arm_infos.size(); ++i){
-				update_arm_info(i);
+				refresh_arm_info(i);
 				arm_infos[i].p_max = NAN;
 			}
 
@@ -310,13 +832,25 @@ class base{
 				posts.emplace_back(arm_infos[i].posterior);
 			}
 
-			auto pmax_vector = multibeep::util::pmax::compute_pmax_all<num_t, rng_t> (posts, delta, GL_num_points);
+			multibeep::util::pmax::pmax_report report;
+			auto pmax_vector = multibeep::util::pmax::compute_pmax_all<num_t, rng_t> (posts, delta, GL_num_points, &report);
 
-			for (auto i=0u; i < n; ++i){
-				arm_infos[i].p_max = pmax_vector[i];
-			}
+			std::vector<unsigned int> identifiers(n);
+			for (auto i=0u; i < n; ++i)
+				identifiers[i] = arm_infos[i].identifier;
+			set_p_max(identifiers, pmax_vector, ++pmax_counter, num_pulls);
 
 			pmax_dirty = false;
+
+			if (collecting_stats()){
+				collected_stats.num_pmax_updates++;
+				collected_stats.pmax_ns += multibeep::util::instrumentation::elapsed_ns(start);
+				if (report.taken != multibeep::util::pmax::pmax_report::path::generic)
+					collected_stats.num_pmax_fast_paths++;
+				collected_stats.num_pmax_integrals += report.num_integrals;
+				collected_stats.num_quadrature_nodes += report.num_quadrature_nodes;
+				collected_stats.num_posterior_evaluations += report.num_posterior_evaluations;
+			}
 		}
 
 };
@@ -18,26 +18,21 @@ class empirical: public base<num_t, rng_t>{
 	public:
 		virtual void update_arm_info(unsigned int index){
 			auto &ai = base_t::arm_infos.at(index);
-			if (ai.dirty){
-				// empirical stats require at least 2 pulls to make sense :)
-				if (ai.reward_stats.number_of_points() >1) {
-					ai.estimated_mean = ai.reward_stats.mean();
-					ai.estimated_variance = std::max(1e-6, ai.reward_stats.variance()/ai.reward_stats.number_of_points());
+			// empirical stats require at least 2 pulls to make sense :)
+			if (ai.reward_stats.number_of_points() >1) {
+				ai.estimated_mean = ai.reward_stats.mean();
+				ai.estimated_variance = std::max(1e-6, ai.reward_stats.variance()/ai.reward_stats.number_of_points());
 
-					ai.posterior =
-						std::shared_ptr<multibeep::util::posteriors::base<num_t, rng_t> > (
-							new multibeep::util::posteriors::gaussian_posterior<num_t, rng_t> (
-								ai.reward_stats.mean(),
-								std::max(std::numeric_limits<num_t>::min(), ai.reward_stats.variance()/ai.reward_stats.number_of_points())
-							)
-					);
-				}
-				else 
-					ai.posterior = std::shared_ptr<multibeep::util::posteriors::base<num_t, rng_t> > (NULL);
-				
-				ai.dirty=false;
-				base_t::num_dirty_arms--;
+				ai.posterior =
+					std::shared_ptr<multibeep::util::posteriors::base<num_t, rng_t> > (
+						new multibeep::util::posteriors::gaussian_posterior<num_t, rng_t> (
+							ai.reward_stats.mean(),
+							std::max(std::numeric_limits<num_t>::min(), ai.reward_stats.variance()/ai.reward_stats.number_of_points())
+						)
+				);
 			}
+			else 
+				ai.posterior = std::shared_ptr<multibeep::util::posteriors::base<num_t, rng_t> > (NULL);
 		}
 };
 
@@ -57,30 +52,27 @@ class last_n_pulls: public base<num_t, rng_t>{
 		virtual void update_arm_info(unsigned int index){
 			auto &ai = base_t::arm_infos.at(index);
 
-			if (ai.dirty){
-				// compute empirical statistics from last n rewards
-				multibeep::util::statistics::running_statistics<num_t> stats;
-				for (auto it=ai.rewards.rbegin(); it!=ai.rewards.rend(); it++){
-					stats(*it);
-					if (stats.number_of_points() == n) break;
-				}
+			// compute empirical statistics from last n rewards
+			multibeep::util::statistics::running_statistics<num_t> stats;
+			for (auto it=ai.rewards.rbegin(); it!=ai.rewards.rend(); it++){
+				stats(*it);
+				if (stats.number_of_points() == n) break;
+			}
 
-				ai.estimated_mean = stats.mean();
-				ai.estimated_variance = stats.variance();
+			ai.estimated_mean = stats.mean();
+			ai.estimated_variance = stats.variance();
 
-				if ( std::isnan(stats.variance()))
-					ai.posterior = std::shared_ptr<multibeep::util::posteriors::base<num_t, rng_t> > (NULL);
-				else
-					ai.posterior =
-						std::shared_ptr<multibeep::util::posteriors::base<num_t, rng_t> > (
-							new multibeep::util::posteriors::gaussian_posterior<num_t, rng_t> (
-								stats.mean(),
-								std::max(std::numeric_limits<num_t>::min(), stats.variance()/stats.number_of_points())
-							)
-							
-					);
-				ai.dirty=false;
-			}
+			if ( std::isnan(stats.variance()))
+				ai.posterior = std::shared_ptr<multibeep::util::posteriors::base<num_t, rng_t> > (NULL);
+			else
+				ai.posterior =
+					std::shared_ptr<multibeep::util::posteriors::base<num_t, rng_t> > (
+						new multibeep::util::posteriors::gaussian_posterior<num_t, rng_t> (
+							stats.mean(),
+							std::max(std::numeric_limits<num_t>::min(), stats.variance()/stats.number_of_points())
+						)
+						
+				);
 		}
 };
 
@@ -0,0 +1,125 @@
+#ifndef MULTIBEEP_BANDIT_PMAX_SCHEDULER
+#define MULTIBEEP_BANDIT_PMAX_SCHEDULER
+
+#include <vector>
+#include <cmath>
+#include <chrono>
+#include <cstdint>
+
+#include "multibeep/bandit/bandit.hpp"
+#include "multibeep/util/instrumentation.hpp"
+
+namespace multibeep{ namespace bandits{
+
+/* \brief decides when the p_max values of a bandit are worth recomputing
+ *
+ * update_p_max recomputes everything, which is expensive compared to a pull.
+ * The scheduler is consulted after every round (see policies::base::play_round)
+ * and refreshes p_max only if
+ *  - at least refresh_every pulls happened since the last refresh, or
+ *  - the estimated mean of an active arm moved by more than max_drift of its
+ *    standard error since the last refresh (checked at most once every
+ *    number_of_active_arms pulls, so the check is amortized O(1) per pull),
+ * and only while the time spent in update_p_max stays below max_fraction of
+ * the time since the scheduler was created. Right after a refresh, arms can
+ * be deactivated by their p_max, so the deactivation always sees fresh values.
+ */
+template <typename num_t = double, typename rng_t = std::default_random_engine>
+class pmax_scheduler{
+	unsigned int refresh_every;
+	num_t max_drift;
+	double max_fraction;
+	num_t delta;
+	unsigned int GL_num_points;
+	bool consider_inactive;
+	num_t deactivation_threshold;
+
+	multibeep::util::instrumentation::clock::time_point start;
+	uint64_t pmax_ns;
+	unsigned int num_refreshes;
+	unsigned int last_seen, pulls_at_refresh, pulls_at_drift_check;
+	// estimated means at the last refresh, by identifier
+	std::vector<num_t> reference_means;
+
+	bool drifted(base<num_t, rng_t> &b){
+		for (auto i=0u; i < b.number_of_active_arms(); ++i){
+			auto &ai = b[i];
+			if (!ai.posterior) continue;
+			if ((ai.identifier >= reference_means.size()) || std::isnan(reference_means[ai.identifier]))
+				return(true);
+			if (std::abs(ai.estimated_mean - reference_means[ai.identifier]) > max_drift*std::sqrt(ai.estimated_variance))
+				return(true);
+		}
+		return(false);
+	}
+
+  public:
+	/* \brief constructs the scheduler
+	 *
+	 * \param refresh_every			number of pulls after which p_max is recomputed at the latest (0 disables this)
+	 * \param max_drift				change of an estimated mean, in standard errors, that triggers a refresh (0 disables this)
+	 * \param max_fraction			maximum fraction of the wall-clock time spent in update_p_max
+	 * \param delta					see bandits::base::update_p_max
+	 * \param GL_num_points			see bandits::base::update_p_max
+	 * \param consider_inactive		see bandits::base::update_p_max
+	 * \param deactivation_threshold	arms with a smaller p_max are deactivated after every refresh (0 disables this)
+	 */
+	pmax_scheduler(	unsigned int refresh_every, num_t max_drift = 0, double max_fraction = 0.1,
+					num_t delta = 0.01, unsigned int GL_num_points = 64, bool consider_inactive = false,
+					num_t deactivation_threshold = 0):
+		refresh_every(refresh_every), max_drift(max_drift), max_fraction(max_fraction), delta(delta),
+		GL_num_points(GL_num_points), consider_inactive(consider_inactive), deactivation_threshold(deactivation_threshold),
+		start(multibeep::util::instrumentation::clock::now()), pmax_ns(0), num_refreshes(0),
+		last_seen(0), pulls_at_refresh(0), pulls_at_drift_check(0) {}
+
+	/* \brief recomputes p_max (and deactivates arms) if it is due; returns whether it did
+	 *
+	 * Calling it repeatedly without a pull in between costs one comparison.
+	 */
+	bool update(base<num_t, rng_t> &b){
+		auto n = b.number_of_pulls();
+		if (n == last_seen) return(false);
+		last_seen = n;
+
+		bool due = (refresh_every > 0) && (n - pulls_at_refresh >= refresh_every);
+		if ((!due) && (max_drift > 0) && (n - pulls_at_drift_check >= b.number_of_active_arms())){
+			pulls_at_drift_check = n;
+			due = drifted(b);
+		}
+		if (!due) return(false);
+
+		// keep within the budget
+		if (pmax_ns > max_fraction*multibeep::util::instrumentation::elapsed_ns(start))
+			return(false);
+
+		refresh(b);
+		return(true);
+	}
+
+	/* \brief recomputes p_max and deactivates arms regardless of the schedule*/
+	void refresh(base<num_t, rng_t> &b){
+		auto t = multibeep::util::instrumentation::clock::now();
+		b.update_p_max(consider_inactive, delta, GL_num_points);
+		if (deactivation_threshold > 0)
+			b.deactivate_by_pmax_threshold(deactivation_threshold);
+
+		reference_means.assign(b.number_of_arms(), NAN);
+		for (auto i=0u; i < b.number_of_active_arms(); ++i){
+			auto &ai = b[i];
+			reference_means[ai.identifier] = ai.estimated_mean;
+		}
+		pmax_ns += multibeep::util::instrumentation::elapsed_ns(t);
+		pulls_at_refresh = pulls_at_drift_check = last_seen = b.number_of_pulls();
+		++num_refreshes;
+	}
+
+	unsigned int number_of_refreshes() const {return(num_refreshes);}
+
+	/* \brief fraction of the wall-clock time since construction spent refreshing*/
+	double time_fraction() const {
+		return(double(pmax_ns)/std::max<uint64_t>(1, multibeep::util::instrumentation::elapsed_ns(start)));
+	}
+};
+
+}}
+#endif
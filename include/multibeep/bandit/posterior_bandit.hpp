@@ -15,13 +15,10 @@ class posterior: public base<num_t, rng_t>{
 		virtual void update_arm_info(unsigned int index){
 			auto &ai = base_t::arm_infos.at(index);
 
-			if (ai.dirty){
-				ai.posterior = ai.get_arm_ptr()->posterior();
-				if (ai.posterior){ // only provide a mean and a variance if the posterior is valid
-					ai.estimated_mean = ai.posterior->mean();
-					ai.estimated_variance = ai.posterior->variance();
-				}
-				ai.dirty=false;
+			ai.posterior = ai.get_arm_ptr()->posterior();
+			if (ai.posterior){ // only provide a mean and a variance if the posterior is valid
+				ai.estimated_mean = ai.posterior->mean();
+				ai.estimated_variance = ai.posterior->variance();
 			}
 		}
 };
@@ -0,0 +1,287 @@
+#ifndef MULTIBEEP_POLICY_ASYNCHRONOUS_SUCCESSIVE_HALVING
+#define MULTIBEEP_POLICY_ASYNCHRONOUS_SUCCESSIVE_HALVING
+
+#include <cmath>
+#include <mutex>
+#include <algorithm>
+#include <limits>
+#include <vector>
+#include <stdexcept>
+
+#include "multibeep/policy/policy.hpp"
+#include "multibeep/bandit/bandit.hpp"
+
+namespace multibeep{ namespace policies{
+
+	/* \brief a unit of work handed out to a worker: pull the arm num_pulls times to complete the rung*/
+	struct rung_job{
+		unsigned int identifier;
+		unsigned int rung;
+		unsigned int num_pulls;
+
+		rung_job(): identifier(std::numeric_limits<unsigned int>::max()), rung(0), num_pulls(0) {}
+		rung_job(unsigned int id, unsigned int r, unsigned int n): identifier(id), rung(r), num_pulls(n) {}
+
+		/* \brief false if there was no work available */
+		bool valid() const {return(identifier != std::numeric_limits<unsigned int>::max());}
+	};
+
+
+	/* \brief asynchronous version of successive halving (ASHA)
+	 *
+	 * An arm that completed rung k (r*eta^k pulls in total) is promoted to rung k+1
+	 * as soon as it is among the top 1/eta of all arms that completed rung k so far.
+	 * If no arm can be promoted, a fresh arm is started in rung 0. There is no
+	 * synchronization barrier between rungs, so a free worker never waits for
+	 * stragglers as long as fresh arms are left.
+	 *
+	 * The bandit's activation state mirrors the schedule: fresh and running arms are
+	 * active, an arm is deactivated after completing a rung and reactivated when it
+	 * gets promoted. Jobs refer to arms by identifier, as indices change on every
+	 * (de)activation.
+	 *
+	 * next_job, job_arm, record_pull and complete_job can be called from multiple
+	 * worker threads. They take the policy's mutex for the bookkeeping, but the
+	 * arm itself is pulled outside of it, so workers evaluate their arms
+	 * concurrently: a worker pulls the arm returned by job_arm and hands the
+	 * reward to record_pull (pull_job does both). Workers must not access the
+	 * bandit directly, as (de)activations reorder its arms. Arms running
+	 * concurrently must not share state, e.g. a random number generator.
+	 *
+	 * Reference:
+	 * Li, Jamieson, Rostamizadeh, Gonina, Hardt, Recht, Talwalkar: A System for Massively Parallel Hyperparameter Tuning. MLSys 2020
+	 */
+	template<typename num_t=double, typename rng_t = std::default_random_engine>
+	class asynchronous_successive_halving: public multibeep::policies::base<num_t, rng_t>{
+		protected:
+			typedef multibeep::policies::base<num_t,rng_t> base_t;
+
+			unsigned int min_pulls;
+			num_t eta;
+			unsigned int max_rung;
+
+			// highest rung an arm was started in; -1 for fresh arms (indexed by identifier)
+			std::vector<int> started_rung;
+			// whether the job of the arm in started_rung is still running (indexed by identifier)
+			std::vector<bool> running;
+			// (score, identifier) of all arms that completed a rung, sorted by descending score
+			std::vector<std::vector<std::pair<num_t, unsigned int> > > rungs;
+			// first identifier that might not have been started yet
+			unsigned int next_fresh;
+			unsigned int num_running;
+
+			mutable std::mutex mtx;
+
+			rung_job promote(unsigned int id, unsigned int rung){
+				started_rung[id] = rung;
+				running[id] = true;
+				num_running++;
+				base_t::bandit_ptr->reactivate_by_identifier(id);
+				return(rung_job(id, rung, number_of_pulls(rung) - (rung > 0 ? number_of_pulls(rung-1) : 0)));
+			}
+
+		public:
+
+			/* \brief constructs the policy
+			 *
+			 * \param b_ptr		the bandit to be played
+			 * \param min_pulls	number of pulls in rung 0 (r in the paper)
+			 * \param eta		only the top 1/eta of the arms in a rung get promoted
+			 * \param max_pulls	maximum number of pulls for a single arm (R in the paper), determines the number of rungs
+			 */
+			asynchronous_successive_halving(std::shared_ptr<multibeep::bandits::base<num_t, rng_t> > b_ptr,
+								unsigned int min_pulls, num_t eta, unsigned int max_pulls):
+				base_t(b_ptr), min_pulls(min_pulls), eta(eta), max_rung(0), next_fresh(0), num_running(0){
+
+				if (eta <= 1)
+					throw std::invalid_argument("Asynchronous successive halving requires eta > 1");
+				if (min_pulls == 0)
+					throw std::invalid_argument("Asynchronous successive halving requires at least one pull in rung 0");
+
+				while (number_of_pulls(max_rung+1) <= max_pulls) ++max_rung;
+				rungs.resize(max_rung+1);
+			}
+
+			std::string get_ident() {return(std::string("asynchronous successive halving"));}
+
+			virtual unsigned int select_next_arm(){
+				throw std::runtime_error("Asynchronous successive halving cannot select a next arm. Use next_job/complete_job or the play_n_rounds method.");
+			}
+
+			/* \brief total number of pulls an arm has after completing the given rung*/
+			unsigned int number_of_pulls(unsigned int rung) const {
+				return(std::round(min_pulls * std::pow(eta, rung)));
+			}
+
+			unsigned int get_max_rung() const {return(max_rung);}
+
+			/* \brief number of arms that completed the given rung */
+			unsigned int number_of_arms_in_rung(unsigned int rung) const {
+				std::lock_guard<std::mutex> lock(mtx);
+				return(rungs.at(rung).size());
+			}
+
+			/* \brief number of jobs handed out, but not completed yet */
+			unsigned int number_of_running_jobs() const {
+				std::lock_guard<std::mutex> lock(mtx);
+				return(num_running);
+			}
+
+			/* \brief throws unless the job was handed out by next_job and is not completed yet*/
+			void check_running(const rung_job &job) const {
+				if ((job.identifier >= started_rung.size()) || (!running[job.identifier]) || (started_rung[job.identifier] != (int) job.rung))
+					throw std::invalid_argument("This job was not handed out by the policy or is already completed");
+			}
+
+			/* \brief the work for the next free worker
+			 *
+			 * Promotions are preferred over starting fresh arms, higher rungs over lower ones.
+			 * The returned job is invalid if every arm is either running, at the top rung
+			 * or not good enough to be promoted (yet).
+			 */
+			rung_job next_job(){
+				std::lock_guard<std::mutex> lock(mtx);
+				auto &b (*(base_t::bandit_ptr));
+
+				started_rung.resize(b.number_of_arms(), -1);
+				running.resize(b.number_of_arms(), false);
+
+				for (int k = ((int) max_rung)-1; k >= 0; --k){
+					unsigned int n_promote = std::floor(rungs[k].size() / eta);
+					for (auto j=0u; j < n_promote; ++j){
+						auto id = rungs[k][j].second;
+						if (started_rung[id] == k)
+							return(promote(id, k+1));
+					}
+				}
+
+				for (; next_fresh < started_rung.size(); ++next_fresh){
+					if (started_rung[next_fresh] == -1){
+						// do not start arms that were deactivated by someone else
+						auto index = b.index_by_identifier(next_fresh);
+						if (!b[index].is_active) continue;
+						return(promote(next_fresh++, 0));
+					}
+				}
+				return(rung_job());
+			}
+
+			/* \brief the arm of a running job, to be pulled without holding the policy's mutex
+			 *
+			 * Pulling the arm records nothing, the rewards have to be handed to record_pull.
+			 */
+			std::shared_ptr<multibeep::arms::base<num_t, rng_t> > job_arm(const rung_job &job){
+				std::lock_guard<std::mutex> lock(mtx);
+				check_running(job);
+				return(base_t::bandit_ptr->arm_by_identifier(job.identifier));
+			}
+
+			/* \brief adds the reward of a pull of the job's arm to the bandit*/
+			void record_pull(const rung_job &job, num_t reward){
+				std::lock_guard<std::mutex> lock(mtx);
+				check_running(job);
+				base_t::bandit_ptr->add_reward_by_identifier(job.identifier, reward);
+			}
+
+			/* \brief pulls the arm of a running job once and returns the reward
+			 *
+			 * Only the bookkeeping holds the mutex, the pull itself runs concurrently
+			 * with the other workers.
+			 */
+			num_t pull_job(const rung_job &job){
+				num_t reward = job_arm(job)->pull();
+				record_pull(job, reward);
+				return(reward);
+			}
+
+			/* \brief records the result of a job after all its pulls have been done */
+			void complete_job(const rung_job &job){
+				std::lock_guard<std::mutex> lock(mtx);
+				auto &b (*(base_t::bandit_ptr));
+
+				check_running(job);
+				auto index = b.index_by_identifier(job.identifier);
+
+				auto &ai = b[index];
+				num_t score = std::isnan(ai.estimated_mean) ? ai.reward_stats.mean() : ai.estimated_mean;
+				if (std::isnan(score)) score = std::numeric_limits<num_t>::lowest();
+
+				auto &rung = rungs[job.rung];
+				auto it = std::upper_bound(rung.begin(), rung.end(), std::make_pair(score, job.identifier),
+					[] (const std::pair<num_t, unsigned int> &a, const std::pair<num_t, unsigned int> &b){return(a.first > b.first);});
+				rung.insert(it, std::make_pair(score, job.identifier));
+
+				// the arm is idle until it gets promoted
+				b.deactivate_by_index(index);
+				running[job.identifier] = false;
+				num_running--;
+			}
+
+			/* \brief identifier of the best arm in the highest rung reached so far*/
+			unsigned int best_identifier(){
+				std::lock_guard<std::mutex> lock(mtx);
+				for (int k = max_rung; k >= 0; --k)
+					if (rungs[k].size() > 0) return(rungs[k][0].second);
+				return(std::numeric_limits<unsigned int>::max());
+			}
+
+			/* \brief writes the schedule
+			 *
+			 * Jobs that are running while the checkpoint is taken stay running after
+			 * a restore, i.e. they have to be completed by calling complete_job.
+			 */
+			virtual void save(multibeep::util::serialization::writer &w) const {
+				std::lock_guard<std::mutex> lock(mtx);
+				w.write_vector(started_rung);
+				w.write<uint32_t>(rungs.size());
+				for (auto &rung: rungs){
+					w.write<uint64_t>(rung.size());
+					for (auto &e: rung){
+						w.write(e.first);
+						w.write(e.second);
+					}
+				}
+				w.write(next_fresh);
+				w.write(num_running);
+			}
+
+			virtual void load(multibeep::util::serialization::reader &r){
+				std::lock_guard<std::mutex> lock(mtx);
+				r.read_vector(started_rung);
+				if (r.read<uint32_t>() != rungs.size())
+					throw std::invalid_argument("The snapshot belongs to a policy with a different number of rungs");
+				for (auto &rung: rungs){
+					rung.resize(r.read<uint64_t>());
+					for (auto &e: rung){
+						e.first = r.read<num_t>();
+						e.second = r.read<unsigned int>();
+					}
+				}
+				next_fresh = r.read<unsigned int>();
+				num_running = r.read<unsigned int>();
+
+				// a started arm is running until it shows up in the rung it was started in
+				running.assign(started_rung.size(), false);
+				for (auto id=0u; id < started_rung.size(); ++id)
+					running[id] = (started_rung[id] >= 0);
+				for (auto k=0u; k < rungs.size(); ++k)
+					for (auto &e: rungs[k])
+						if ((e.second < started_rung.size()) && (started_rung[e.second] == (int) k))
+							running[e.second] = false;
+			}
+
+			/* \brief plays num_rounds jobs sequentially, or until no more jobs are available */
+			virtual void play_n_rounds (unsigned int num_rounds){
+				for (; num_rounds > 0; --num_rounds){
+					auto job = next_job();
+					if (!job.valid()) break;
+
+					for (auto i=0u; i < job.num_pulls; ++i)
+						pull_job(job);
+					complete_job(job);
+				}
+			}
+	};
+
+}}
+#endif
@@ -0,0 +1,133 @@
+#ifndef MULTIBEEP_POLICY_COST_AWARE
+#define MULTIBEEP_POLICY_COST_AWARE
+
+#include <algorithm>
+#include <limits>
+#include <random>
+
+#include "multibeep/policy/ucbp.hpp"
+#include "multibeep/policy/prob_match.hpp"
+#include "multibeep/bandit/bandit.hpp"
+
+/* Policies that trade the expected improvement of an arm off against the
+ * wall-clock time its pulls take. The cost of an arm is the mean duration of
+ * its pulls, measured by the bandit (see bandits::base::measure_pull_latency).
+ * The improvement is measured against the largest estimated mean of all
+ * active arms. Arms whose cost is unknown are pulled first, so every arm is
+ * timed at least once.
+ */
+
+namespace multibeep{ namespace policies{
+
+	/* \brief mean wall-clock seconds of a pull, bounded away from zero; NAN if the arm was never timed*/
+	template<typename num_t, typename rng_t>
+	num_t expected_cost(const multibeep::bandits::arm_info<num_t, rng_t> &ai){
+		if (ai.pull_latency.count() == 0) return(NAN);
+		return(std::max<num_t>(ai.pull_latency.mean_seconds(), 1e-9));
+	}
+
+
+	/* \brief UCB_p picking the arm with the largest (upper confidence bound - best mean)/cost
+	 *
+	 * For the arm with the largest mean this is its confidence gap per second,
+	 * so it is kept as long as no other arm promises more per second. If no
+	 * arm promises an improvement at all, the plain UCB_p choice is made.
+	 */
+	template<typename num_t=double, typename rng_t = std::default_random_engine>
+	class cost_aware_UCB_p: public UCB_p<num_t, rng_t>{
+		protected:
+			typedef multibeep::policies::base<num_t, rng_t> base_t;
+			typedef multibeep::policies::UCB_p<num_t, rng_t> ucb_t;
+
+		public:
+			cost_aware_UCB_p(std::shared_ptr<multibeep::bandits::base<num_t, rng_t> > b_ptr, std::shared_ptr<rng_t> r_ptr, num_t p):
+				ucb_t(b_ptr, r_ptr, p){
+				b_ptr->measure_pull_latency(true);
+			}
+
+			std::string get_ident() {return(std::string("cost-aware UCBp"));}
+
+			virtual unsigned int select_next_arm(){
+				auto &b (*(base_t::bandit_ptr));
+
+				num_t best_mean = std::numeric_limits<num_t>::lowest();
+				for (auto i=0u; i < b.number_of_active_arms(); i++){
+					auto &ai = b[i];
+					if (std::isnan(ucb_t::calculate_confidence_gap(ai)) || std::isnan(expected_cost(ai)))
+						return(i);
+					best_mean = std::max(best_mean, ai.estimated_mean);
+				}
+
+				num_t max_score = 0;
+				unsigned int index = 0;
+				bool improvement = false;
+				for (auto i=0u; i < b.number_of_active_arms(); i++){
+					auto &ai = b[i];
+					num_t score = (ai.estimated_mean + ucb_t::calculate_confidence_gap(ai) - best_mean)/expected_cost(ai);
+					if (score > max_score){
+						max_score = score;
+						index = i;
+						improvement = true;
+					}
+				}
+				return(improvement ? index : ucb_t::select_next_arm());
+			}
+	};
+
+
+	/* \brief probability matching picking the arm with the largest (posterior sample - best mean)/cost
+	 *
+	 * Every active arm draws one sample from its posterior. If no sample beats
+	 * the best mean, the arm with the largest sample is pulled as in prob_match.
+	 */
+	template<typename num_t=double, typename rng_t = std::default_random_engine>
+	class cost_aware_prob_match: public prob_match<num_t, rng_t>{
+		protected:
+			typedef multibeep::policies::base<num_t, rng_t> base_t;
+			typedef multibeep::policies::prob_match<num_t, rng_t> pm_t;
+
+		public:
+			cost_aware_prob_match(std::shared_ptr<multibeep::bandits::base<num_t, rng_t> > b_ptr, std::shared_ptr<rng_t> r_ptr):
+				pm_t(b_ptr, r_ptr){
+				b_ptr->measure_pull_latency(true);
+			}
+
+			std::string get_ident() {return(std::string("cost-aware prob_match"));}
+
+			virtual unsigned int select_next_arm(){
+				auto &b (*(base_t::bandit_ptr));
+				std::uniform_real_distribution<num_t> u(0,1);
+
+				num_t best_mean = std::numeric_limits<num_t>::lowest();
+				for (auto i=0u; i < b.number_of_active_arms(); i++){
+					auto &ai = b[i];
+					if ((!ai.posterior) || std::isnan(expected_cost(ai)))
+						return(i);
+					best_mean = std::max(best_mean, ai.estimated_mean);
+				}
+
+				num_t max_score = 0, max_sample = std::numeric_limits<num_t>::lowest();
+				unsigned int score_index = 0, sample_index = 0;
+				bool improvement = false;
+				for (auto i=0u; i < b.number_of_active_arms(); i++){
+					auto &ai = b[i];
+					num_t sample(ai.posterior->quantile( u(*pm_t::rng_ptr) ));
+					// see prob_match
+					if (std::isnan(sample)) return(i);
+					if (sample > max_sample){
+						max_sample = sample;
+						sample_index = i;
+					}
+					num_t score = (sample - best_mean)/expected_cost(ai);
+					if (score > max_score){
+						max_score = score;
+						score_index = i;
+						improvement = true;
+					}
+				}
+				return(improvement ? score_index : sample_index);
+			}
+	};
+
+}}
+#endif
@@ -0,0 +1,162 @@
+#ifndef MULTIBEEP_POLICY_F_RACE
+#define MULTIBEEP_POLICY_F_RACE
+
+#include <vector>
+#include <memory>
+#include <stdexcept>
+
+#include "multibeep/policy/policy.hpp"
+#include "multibeep/bandit/bandit.hpp"
+#include "multibeep/util/friedman_test.hpp"
+
+namespace multibeep{ namespace policies{
+
+	/* \brief F-Race: pulls all surviving arms once per round and eliminates arms based on the Friedman test
+	 *
+	 * The arms in the race are the active arms when play_n_rounds is called for the
+	 * first time. Every round each of them is pulled once, the rewards of one round are
+	 * treated as one block (e.g. one instance for data arms with sequential order).
+	 * The rank statistics are updated incrementally, so a round costs O(m log m) for
+	 * m surviving arms. Significantly worse arms are deactivated in bulk.
+	 * Arms deactivated by someone else are dropped from the race.
+	 *
+	 * Reference:
+	 * Birattari, Mauro, et al. "F-Race and iterated F-Race: An overview."
+	 * Experimental methods for the analysis of optimization algorithms. Springer Berlin Heidelberg, 2010. 311-336.
+	 */
+	template<typename num_t=double, typename rng_t = std::default_random_engine>
+	class f_race: public multibeep::policies::base<num_t, rng_t>{
+		protected:
+			typedef multibeep::policies::base<num_t,rng_t> base_t;
+
+			num_t alpha;
+			unsigned int min_num_rounds;
+
+			// identifiers of the arms in the race, in the order used by the friedman test
+			std::vector<unsigned int> racers;
+			std::unique_ptr<multibeep::util::friedman::incremental_friedman<num_t> > friedman;
+
+			// remove all racers that are not active anymore
+			void sync_racers(){
+				auto &b (*(base_t::bandit_ptr));
+
+				std::vector<bool> active(b.number_of_arms(), false);
+				for (auto i=0u; i < b.number_of_active_arms(); ++i)
+					active[b[i].identifier] = true;
+
+				std::vector<unsigned int> gone;
+				for (auto j=0u; j < racers.size(); ++j)
+					if (!active[racers[j]]) gone.push_back(j);
+				drop(gone);
+			}
+
+			void drop(const std::vector<unsigned int> &indices){
+				if (indices.empty()) return;
+				friedman->remove(indices);
+				std::vector<bool> keep(racers.size(), true);
+				for (auto j: indices) keep[j] = false;
+				auto k = 0u;
+				for (auto j=0u; j < racers.size(); ++j)
+					if (keep[j]) racers[k++] = racers[j];
+				racers.resize(k);
+			}
+
+		public:
+
+			/* \brief constructs the policy
+			 *
+			 * \param b_ptr		the bandit to be played
+			 * \param alpha		significance level of the Friedman test and the post hoc comparison
+			 * \param min_rounds	number of rounds before the first test is performed
+			 */
+			f_race(std::shared_ptr<multibeep::bandits::base<num_t, rng_t> > b_ptr, num_t alpha, unsigned int min_rounds = 5):
+				base_t(b_ptr), alpha(alpha), min_num_rounds(std::max(2u, min_rounds)) {}
+
+			std::string get_ident() {return(std::string("F-Race"));}
+
+			virtual unsigned int select_next_arm(){
+				throw std::runtime_error("F-Race pulls all surviving arms every round. Use the play_n_rounds method.");
+			}
+
+			/* \brief number of arms still in the race*/
+			unsigned int number_of_racers() const {return(racers.size());}
+
+			/* \brief number of complete rounds played */
+			unsigned int number_of_rounds() const {return(friedman? friedman->number_of_rounds() : 0);}
+
+			/* \brief writes the arms in the race and the rewards of all rounds*/
+			virtual void save(multibeep::util::serialization::writer &w) const {
+				w.write<uint8_t>((bool) friedman);
+				if (!friedman) return;
+				w.write_vector(racers);
+				w.write<uint64_t>(friedman->number_of_rounds());
+				for (auto &values: friedman->round_values())
+					w.write_vector(values);
+			}
+
+			/* \brief restores the race, the rank statistics are recomputed from the rewards*/
+			virtual void load(multibeep::util::serialization::reader &r){
+				racers.clear();
+				friedman.reset();
+				if (!r.read<uint8_t>()) return;
+
+				r.read_vector(racers);
+				friedman.reset(new multibeep::util::friedman::incremental_friedman<num_t>(racers.size()));
+				auto n = r.read<uint64_t>();
+				std::vector<num_t> values;
+				for (auto i=0u; i < n; ++i){
+					r.read_vector(values);
+					friedman->add_round(values);
+				}
+			}
+
+			/* \brief plays num_rounds rounds or until only one arm is left*/
+			virtual void play_n_rounds (unsigned int num_rounds){
+				auto &b (*(base_t::bandit_ptr));
+
+				if (!friedman){
+					for (auto i=0u; i < b.number_of_active_arms(); ++i)
+						racers.push_back(b[i].identifier);
+					friedman.reset(new multibeep::util::friedman::incremental_friedman<num_t>(racers.size()));
+				}
+				else
+					sync_racers();
+
+				// column of each identifier in the race
+				std::vector<unsigned int> column(b.number_of_arms(), racers.size());
+				for (auto j=0u; j < racers.size(); ++j)
+					column[racers[j]] = j;
+
+				std::vector<num_t> rewards;
+
+				for (; (num_rounds > 0) && (racers.size() > 1); --num_rounds){
+
+					rewards.assign(racers.size(), NAN);
+					for (auto i=0u; i < b.number_of_active_arms(); ++i){
+						auto j = column[b[i].identifier];
+						if (j < racers.size())
+							rewards[j] = b.pull_by_index(i);
+					}
+					friedman->add_round(rewards);
+
+					if (friedman->number_of_rounds() < min_num_rounds) continue;
+
+					auto losers = friedman->test(alpha);
+					if (losers.empty()) continue;
+
+					std::vector<unsigned int> ids;
+					ids.reserve(losers.size());
+					for (auto j: losers){
+						ids.push_back(racers[j]);
+						column[racers[j]] = racers.size();
+					}
+					b.deactivate_by_identifiers(ids);
+					drop(losers);
+					for (auto j=0u; j < racers.size(); ++j)
+						column[racers[j]] = j;
+				}
+			}
+	};
+
+}}
+#endif
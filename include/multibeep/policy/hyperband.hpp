@@ -0,0 +1,191 @@
+#ifndef MULTIBEEP_POLICY_HYPERBAND
+#define MULTIBEEP_POLICY_HYPERBAND
+
+#include <cmath>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <exception>
+#include <functional>
+#include <stdexcept>
+
+#include "multibeep/policy/policy.hpp"
+#include "multibeep/policy/successive_halving.hpp"
+#include "multibeep/bandit/bandit.hpp"
+
+namespace multibeep{ namespace policies{
+
+	/* \brief Hyperband runs several brackets of successive halving with different trade-offs between number of arms and pulls
+	 *
+	 * Every bracket gets its own bandit (created by the bandit factory) and its own
+	 * random number generator. The arms of a bracket are created by the arm sampler
+	 * using that generator, so arms of different brackets do not share any state
+	 * and the brackets can be played concurrently by a pool of worker threads.
+	 * All arms are sampled in the calling thread before any pull happens, and every
+	 * bracket is played by the successive_halving policy, so the result does not
+	 * depend on the number of threads.
+	 *
+	 * Reference:
+	 * Li, Jamieson, DeSalvo, Rostamizadeh, Talwalkar: Hyperband: A Novel Bandit-Based Approach to Hyperparameter Optimization. JMLR 18(185):1-52, 2018
+	 */
+	template<typename num_t=double, typename rng_t = std::default_random_engine>
+	class hyperband: public multibeep::policies::base<num_t, rng_t>{
+		public:
+			typedef std::shared_ptr<multibeep::bandits::base<num_t, rng_t> > bandit_ptr_t;
+			typedef std::shared_ptr<multibeep::arms::base<num_t, rng_t> > arm_ptr_t;
+
+			typedef std::function<bandit_ptr_t ()> bandit_factory_t;
+			typedef std::function<arm_ptr_t (std::shared_ptr<rng_t>)> arm_sampler_t;
+
+			// C-style callbacks with a user pointer, used by the Python bindings
+			typedef bandit_ptr_t (*bandit_factory_wrapper)(void*);
+			typedef arm_ptr_t (*arm_sampler_wrapper)(void*, std::shared_ptr<rng_t>);
+
+		protected:
+			typedef multibeep::policies::base<num_t, rng_t> base_t;
+
+			bandit_factory_t bandit_factory;
+			arm_sampler_t arm_sampler;
+			std::shared_ptr<rng_t> rng_ptr;
+
+			num_t R;
+			num_t eta;
+			unsigned int s_max;
+			unsigned int num_threads;
+
+			std::vector<bandit_ptr_t> brackets;
+
+			/* \brief creates and fills the bandit for bracket s (s_max+1 - s rounds of successive halving) */
+			bandit_ptr_t create_bracket(unsigned int s){
+				auto b_ptr = bandit_factory();
+				if (!b_ptr)
+					throw std::runtime_error("The bandit factory of Hyperband did not return a bandit");
+				// each bracket gets its own generator, seeded from the master generator
+				auto bracket_rng_ptr = std::make_shared<rng_t> ((*rng_ptr)());
+
+				unsigned int n = number_of_arms(s);
+				for (auto i=0u; i < n; ++i){
+					auto a_ptr = arm_sampler(bracket_rng_ptr);
+					if (!a_ptr)
+						throw std::runtime_error("The arm sampler of Hyperband did not return an arm");
+					b_ptr->add_arm(a_ptr);
+				}
+				return(b_ptr);
+			}
+
+			void play_bracket(bandit_ptr_t b_ptr, unsigned int s){
+				multibeep::policies::successive_halving<num_t, rng_t> sh (b_ptr, number_of_pulls(s), eta);
+				sh.play_n_rounds(s+1);
+			}
+
+		public:
+
+			/* \brief constructs the policy
+			 *
+			 * \param bf		creates an empty bandit for every bracket
+			 * \param as		creates a new arm; the argument is the generator of the bracket the arm belongs to
+			 * \param r_ptr		master generator used to seed the generators of the individual brackets
+			 * \param max_pulls	maximum number of pulls an arm can receive in a bracket (R in the paper)
+			 * \param eta		fraction of arms that are kept in every round of successive halving
+			 * \param threads	number of worker threads used to play the brackets; 0 means one per core
+			 */
+			hyperband(	bandit_factory_t bf, arm_sampler_t as, std::shared_ptr<rng_t> r_ptr,
+						num_t max_pulls, num_t eta, unsigned int threads = 0):
+				base_t(bandit_ptr_t()), bandit_factory(bf), arm_sampler(as), rng_ptr(r_ptr),
+				R(max_pulls), eta(eta), s_max(0), num_threads(threads){
+
+				if (eta <= 1)
+					throw std::invalid_argument("Hyperband requires eta > 1");
+				if (R < 1)
+					throw std::invalid_argument("Hyperband requires at least one pull per arm");
+
+				// s_max = floor(log_eta(R)) without the rounding issues of std::log
+				while (std::pow(eta, s_max+1) <= R) ++s_max;
+
+				if (num_threads == 0)
+					num_threads = std::max(1u, std::thread::hardware_concurrency());
+			}
+
+			hyperband(	bandit_factory_wrapper bf, arm_sampler_wrapper as, void * obj, std::shared_ptr<rng_t> r_ptr,
+						num_t max_pulls, num_t eta, unsigned int threads = 0):
+				hyperband(	[bf, obj] () {return(bf(obj));},
+							[as, obj] (std::shared_ptr<rng_t> r) {return(as(obj, r));},
+							r_ptr, max_pulls, eta, threads) {}
+
+			std::string get_ident() {return(std::string("hyperband"));}
+
+			/* \brief not supported: the brackets contain arms created by the sampler, which cannot be recreated*/
+			virtual void save(multibeep::util::serialization::writer &) const {
+				throw std::runtime_error("Hyperband does not support checkpoints, checkpoint the bandits of the brackets instead");
+			}
+
+			virtual void load(multibeep::util::serialization::reader &) {
+				throw std::runtime_error("Hyperband does not support checkpoints, checkpoint the bandits of the brackets instead");
+			}
+
+			virtual unsigned int select_next_arm(){
+				throw std::runtime_error("Hyperband cannot select a next arm. Use the play_n_rounds method to run it for a fixed number of iterations");
+			}
+
+			/* \brief number of arms in bracket s at the beginning */
+			unsigned int number_of_arms(unsigned int s) const {
+				return(std::ceil( (s_max+1)/num_t(s+1) * std::pow(eta, s) ));
+			}
+
+			/* \brief number of pulls per arm in the first round of bracket s */
+			unsigned int number_of_pulls(unsigned int s) const {
+				return(std::max<num_t>(1, std::floor(R * std::pow(eta, -num_t(s)))));
+			}
+
+			unsigned int get_s_max() const {return(s_max);}
+
+			/* \brief runs num_rounds full iterations of Hyperband, i.e. all s_max+1 brackets per iteration */
+			virtual void play_n_rounds (unsigned int num_rounds){
+
+				for (auto round=0u; round < num_rounds; ++round){
+
+					// sample all arms in this thread to keep the schedule deterministic
+					std::vector<bandit_ptr_t> new_brackets;
+					std::vector<unsigned int> ss;
+					for (int s = s_max; s >= 0; --s){
+						new_brackets.push_back(create_bracket(s));
+						ss.push_back(s);
+					}
+
+					std::atomic<unsigned int> next(0);
+					std::vector<std::exception_ptr> errors(new_brackets.size());
+
+					auto worker = [&] (){
+						for (unsigned int i = next++; i < new_brackets.size(); i = next++){
+							try{ play_bracket(new_brackets[i], ss[i]);}
+							catch (...){ errors[i] = std::current_exception();}
+						}
+					};
+
+					unsigned int n = std::min<unsigned int>(num_threads, new_brackets.size());
+					if (n <= 1)
+						worker();
+					else{
+						std::vector<std::thread> pool;
+						for (auto i=0u; i < n; ++i)
+							pool.emplace_back(worker);
+						for (auto &t: pool)
+							t.join();
+					}
+
+					for (auto &e: errors)
+						if (e) std::rethrow_exception(e);
+
+					brackets.insert(brackets.end(), new_brackets.begin(), new_brackets.end());
+				}
+			}
+
+			/* \brief number of brackets played so far */
+			unsigned int number_of_brackets() const {return(brackets.size());}
+
+			/* \brief access to the bandit of a played bracket, in the order they were created */
+			bandit_ptr_t get_bracket(unsigned int i) const {return(brackets.at(i));}
+	};
+
+}}
+#endif
@@ -0,0 +1,225 @@
+#ifndef MULTIBEEP_POLICY_LUCB
+#define MULTIBEEP_POLICY_LUCB
+
+#include <cmath>
+#include <set>
+#include <vector>
+#include <limits>
+
+#include "multibeep/policy/policy.hpp"
+#include "multibeep/bandit/bandit.hpp"
+
+namespace multibeep{ namespace policies{
+
+	/* \brief LUCB for fixed-confidence identification of the best arm
+	 *
+	 * Every step the empirical leader and the arm with the highest upper confidence bound
+	 * among all others (the challenger) are pulled. The policy is done as soon as the
+	 * lower bound of the leader exceeds the upper bound of the challenger minus epsilon.
+	 *
+	 * The confidence gap of an arm is sqrt(2*estimated_variance*beta) with
+	 * beta = log(5*K*t^4/(4*delta)). To keep the ordering of the arms valid between
+	 * pulls, t is rounded up to the next power of two; only then all bounds are recomputed.
+	 * In between, the means and bounds are kept in ordered sets and only the pulled arms
+	 * are updated, so the stopping check is O(1) and a step costs O(log K).
+	 * The arms must not be (de)activated by someone else while the policy is played.
+	 *
+	 * Reference:
+	 * Kalyanakrishnan, Tewari, Auer, Stone: PAC Subset Selection in Stochastic Multi-armed Bandits. ICML 2012
+	 */
+	template<typename num_t=double, typename rng_t = std::default_random_engine>
+	class LUCB: public multibeep::policies::base<num_t, rng_t>{
+		protected:
+			typedef multibeep::policies::base<num_t,rng_t> base_t;
+			typedef std::pair<num_t, unsigned int> entry_t;
+
+			num_t delta;
+			num_t epsilon;
+
+			// per identifier
+			std::vector<unsigned int> index_of;
+			std::vector<num_t> means, gaps;
+			std::vector<num_t> variances;
+
+			// (value, identifier) of all arms with a valid variance estimate
+			std::set<entry_t> by_mean, by_ucb;
+			// identifiers of arms without a variance estimate yet
+			std::set<unsigned int> uninitialized;
+
+			// identifiers selected since the last update
+			std::vector<unsigned int> selected;
+			unsigned int challenger_pending;
+
+			unsigned int num_pulls_seen;
+			unsigned int epoch_end;
+			num_t beta;
+
+			static const unsigned int none = std::numeric_limits<unsigned int>::max();
+
+			void remove_entries(unsigned int id){
+				if (std::isnan(variances[id])) return;
+				by_mean.erase(entry_t(means[id], id));
+				by_ucb.erase(entry_t(means[id] + gaps[id], id));
+			}
+
+			void insert_entries(unsigned int id){
+				if (std::isnan(variances[id])){
+					uninitialized.insert(id);
+					return;
+				}
+				uninitialized.erase(id);
+				gaps[id] = std::sqrt(2*variances[id]*beta);
+				by_mean.insert(entry_t(means[id], id));
+				by_ucb.insert(entry_t(means[id] + gaps[id], id));
+			}
+
+			void update_arm(unsigned int id){
+				remove_entries(id);
+				const auto &ai = (*base_t::bandit_ptr)[index_of[id]];
+				means[id] = ai.estimated_mean;
+				variances[id] = ai.estimated_variance;
+				insert_entries(id);
+			}
+
+			// recomputes everything, e.g. after arms were added
+			void rebuild(){
+				auto &b (*(base_t::bandit_ptr));
+				unsigned int n = b.number_of_arms();
+
+				index_of.assign(n, none);
+				means.assign(n, NAN); gaps.assign(n, NAN); variances.assign(n, NAN);
+				by_mean.clear(); by_ucb.clear(); uninitialized.clear();
+				selected.clear();
+				challenger_pending = none;
+
+				for (auto i=0u; i < b.number_of_active_arms(); ++i){
+					auto id = b[i].identifier;
+					index_of[id] = i;
+					means[id] = b[i].estimated_mean;
+					variances[id] = b[i].estimated_variance;
+				}
+				update_beta();
+				for (auto id=0u; id < n; ++id)
+					if (index_of[id] != none) insert_entries(id);
+				num_pulls_seen = b.number_of_pulls();
+			}
+
+			void update_beta(){
+				unsigned int t = std::max(1u, base_t::bandit_ptr->number_of_pulls());
+				while (epoch_end < t) epoch_end *= 2;
+				num_t K = base_t::bandit_ptr->number_of_active_arms();
+				beta = std::log(5*K*std::pow(num_t(epoch_end), 4)/(4*delta));
+			}
+
+			/* \brief brings the ordered sets up to date with the bandit*/
+			void update(){
+				auto &b (*(base_t::bandit_ptr));
+
+				bool stale = (b.number_of_arms() != index_of.size()) || (b.number_of_pulls() != num_pulls_seen + selected.size());
+				for (auto id: selected)
+					stale |= (b[index_of[id]].identifier != id);
+
+				if (stale){
+					rebuild();
+					return;
+				}
+				num_pulls_seen = b.number_of_pulls();
+
+				if (num_pulls_seen > epoch_end){
+					// all bounds change, recompute them
+					update_beta();
+					by_ucb.clear();
+					for (auto &e: by_mean){
+						gaps[e.second] = std::sqrt(2*variances[e.second]*beta);
+						by_ucb.insert(entry_t(e.first + gaps[e.second], e.second));
+					}
+				}
+
+				for (auto id: selected)
+					update_arm(id);
+				selected.clear();
+			}
+
+			// highest upper bound of all arms except the leader
+			typename std::set<entry_t>::const_reverse_iterator challenger(unsigned int leader) const {
+				auto it = by_ucb.rbegin();
+				if ((it != by_ucb.rend()) && (it->second == leader)) ++it;
+				return(it);
+			}
+
+		public:
+
+			/* \brief constructs the policy
+			 *
+			 * \param b_ptr		the bandit to be played
+			 * \param delta		probability that the identified arm is not epsilon-optimal
+			 * \param epsilon	tolerance of the identification
+			 */
+			LUCB(std::shared_ptr<multibeep::bandits::base<num_t, rng_t> > b_ptr, num_t delta, num_t epsilon = 0):
+				base_t(b_ptr), delta(delta), epsilon(epsilon), challenger_pending(none),
+				num_pulls_seen(0), epoch_end(1), beta(NAN) {}
+
+			std::string get_ident() {return(std::string("LUCB"));}
+
+			virtual unsigned int select_next_arm(){
+				update();
+
+				unsigned int id;
+				if (!uninitialized.empty())
+					id = *uninitialized.begin();
+				else if (challenger_pending != none){
+					id = challenger_pending;
+					challenger_pending = none;
+				}
+				else{
+					id = by_mean.rbegin()->second;
+					auto it = challenger(id);
+					if (it != by_ucb.rend()) challenger_pending = it->second;
+				}
+				selected.push_back(id);
+				return(index_of[id]);
+			}
+
+			/* \brief true if the leader is separated from all other arms */
+			bool finished(){
+				update();
+				if ((!uninitialized.empty()) || by_mean.empty()) return(false);
+
+				auto leader = by_mean.rbegin()->second;
+				auto it = challenger(leader);
+				if (it == by_ucb.rend()) return(true);
+
+				return(means[leader] - gaps[leader] > it->first - epsilon);
+			}
+
+			/* \brief identifier of the current empirical leader*/
+			unsigned int best_identifier(){
+				update();
+				return(by_mean.empty() ? none : by_mean.rbegin()->second);
+			}
+
+			/* \brief writes the current epoch, everything else is recomputed from the bandit*/
+			virtual void save(multibeep::util::serialization::writer &w) const {w.write(epoch_end);}
+
+			virtual void load(multibeep::util::serialization::reader &r){
+				epoch_end = r.read<unsigned int>();
+				// forces a rebuild on the next update
+				index_of.clear();
+				selected.clear();
+				num_pulls_seen = 0;
+			}
+
+			/* \brief pulls num_rounds times or until the best arm is identified */
+			virtual void play_n_rounds (unsigned int num_rounds){
+				while ((num_rounds > 0) && !finished()){
+					base_t::bandit_ptr->pull_by_index(base_t::timed_select_next_arm());
+					--num_rounds;
+				}
+			}
+	};
+
+	template<typename num_t, typename rng_t>
+	const unsigned int LUCB<num_t, rng_t>::none;
+
+}}
+#endif
@@ -4,8 +4,13 @@
 #include <string>
 #include <memory>
 #include <random>
+#include <chrono>
+#include <functional>
 
 #include "multibeep/bandit/bandit.hpp"
+#include "multibeep/bandit/pmax_scheduler.hpp"
+#include "multibeep/util/serialization.hpp"
+#include "multibeep/util/instrumentation.hpp"
 
 
 
@@ -17,10 +22,27 @@ namespace multibeep{ namespace policies{
 		
 		protected:
 			std::shared_ptr<multibeep::bandits::base<num_t, rng_t> > bandit_ptr;
+			// optional schedule for refreshing p_max, see set_pmax_scheduler
+			std::shared_ptr<multibeep::bandits::pmax_scheduler<num_t, rng_t> > scheduler_ptr;
+			// optional counters and timings, see enable_stats
+			bool collect_stats;
+			multibeep::util::instrumentation::policy_stats collected_stats;
+
+			/* \brief select_next_arm, timed if stats are collected*/
+			unsigned int timed_select_next_arm(){
+				if (!(multibeep::util::instrumentation::compiled_in && collect_stats))
+					return(select_next_arm());
+				auto start = multibeep::util::instrumentation::clock::now();
+				auto index = select_next_arm();
+				collected_stats.selection_ns += multibeep::util::instrumentation::elapsed_ns(start);
+				collected_stats.num_selections++;
+				return(index);
+			}
+
 		public:
 
 			base (std::shared_ptr<multibeep::bandits::base<num_t,rng_t> > b_ptr):
-				bandit_ptr(b_ptr) {}
+				bandit_ptr(b_ptr), collect_stats(false) {}
 		
 			/* \brief returns the next arm to pull based on the */
 			virtual unsigned int select_next_arm() = 0;
@@ -28,12 +50,90 @@ namespace multibeep{ namespace policies{
 			/* \brief selects and pulls the arm num_rounds times */
 			virtual void play_n_rounds (unsigned int num_rounds){
 				while (num_rounds > 0){
-					bandit_ptr->pull_by_index(select_next_arm());
+					bandit_ptr->pull_by_index(timed_select_next_arm());
+					if (scheduler_ptr) scheduler_ptr->update(*bandit_ptr);
 					--num_rounds;
 				}
 			}
+
+			/* \brief plays a single round and gives the p_max scheduler the chance to refresh*/
+			void play_round(){
+				play_n_rounds(1);
+				// a no-op if play_n_rounds consulted it already
+				if (scheduler_ptr) scheduler_ptr->update(*bandit_ptr);
+			}
+
+			/* \brief plays rounds until the given wall-clock time has passed; returns the number of rounds
+			 *
+			 * The time is checked between rounds, so the last round can exceed the
+			 * duration by the time it takes.
+			 */
+			template <typename rep_t, typename period_t>
+			unsigned int play_for (std::chrono::duration<rep_t, period_t> duration){
+				auto end = std::chrono::steady_clock::now() + duration;
+				unsigned int n = 0;
+				while (std::chrono::steady_clock::now() < end){
+					play_round();
+					++n;
+				}
+				return(n);
+			}
+
+			/* \brief plays rounds until the predicate returns true (checked before every round) or max_rounds were played; returns the number of rounds*/
+			unsigned int play_until (std::function<bool ()> predicate, unsigned int max_rounds = std::numeric_limits<unsigned int>::max()){
+				unsigned int n = 0;
+				while ((n < max_rounds) && (!predicate())){
+					play_round();
+					++n;
+				}
+				return(n);
+			}
+
+			/* \brief refreshes p_max according to the given schedule while playing
+			 *
+			 * The scheduler is consulted after every round of play_n_rounds (unless
+			 * a policy overrides it), play_round, play_for and play_until. Pass an
+			 * empty pointer to stop.
+			 */
+			void set_pmax_scheduler(std::shared_ptr<multibeep::bandits::pmax_scheduler<num_t, rng_t> > s_ptr){scheduler_ptr = s_ptr;}
+
+			/* \brief starts/stops timing the selections made in play_n_rounds
+			 *
+			 * The pulls themselves are counted by the bandit, see bandits::base::enable_stats.
+			 * Without effect if the library is compiled with MULTIBEEP_NO_STATS.
+			 */
+			void enable_stats(bool enable){collect_stats = enable;}
+
+			const multibeep::util::instrumentation::policy_stats & get_stats() const {return(collected_stats);}
+
+			void reset_stats(){collected_stats = multibeep::util::instrumentation::policy_stats();}
 			
 			virtual std::string  get_ident() = 0;	
+
+			/* \brief writes the internal state of the policy, the bandit is not included*/
+			virtual void save(multibeep::util::serialization::writer &) const {}
+
+			/* \brief restores the state written by save; the policy must be constructed with the same parameters*/
+			virtual void load(multibeep::util::serialization::reader &) {}
+
+			/* \brief a self-contained binary snapshot of the policy's state, see save
+			 *
+			 * Together with the checkpoint of the bandit this allows to resume a run.
+			 */
+			std::string checkpoint() const {
+				multibeep::util::serialization::writer w;
+				w.write_header<num_t>(multibeep::util::serialization::policy_snapshot);
+				save(w);
+				return(w.data());
+			}
+
+			/* \brief restores a snapshot created by checkpoint*/
+			void restore(const char * data, size_t size){
+				multibeep::util::serialization::reader r(data, size);
+				r.read_header<num_t>(multibeep::util::serialization::policy_snapshot);
+				load(r);
+			}
+
 			virtual ~base() {}
 	};
 
@@ -17,6 +17,10 @@ namespace multibeep{ namespace policies{
 				base_t(b_ptr), rng_ptr(r_ptr) {}
 			
 			std::string get_ident() {return(std::string("prob_match"));}
+
+			/* \brief the state of the random number generator*/
+			virtual void save(multibeep::util::serialization::writer &w) const {w.write_rng(*rng_ptr);}
+			virtual void load(multibeep::util::serialization::reader &r) {r.read_rng(*rng_ptr);}
 			
 			virtual unsigned int select_next_arm(){
 				// convenience alias for the bandit
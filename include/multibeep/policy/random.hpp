@@ -18,6 +18,10 @@ namespace multibeep{ namespace policies{
 				base_t(b_ptr), rng_ptr(r_ptr){}
 			
 			std::string  get_ident(){ return std::string("Random Policy");}
+
+			/* \brief the state of the random number generator*/
+			virtual void save(multibeep::util::serialization::writer &w) const {w.write_rng(*rng_ptr);}
+			virtual void load(multibeep::util::serialization::reader &r) {r.read_rng(*rng_ptr);}
 		
 		/* \brief  random search just returns a random index in the range 0 to the number of active arms - 1*/
 		virtual unsigned int select_next_arm(){
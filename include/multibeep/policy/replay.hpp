@@ -0,0 +1,49 @@
+#ifndef MULTIBEEP_POLICY_REPLAY
+#define MULTIBEEP_POLICY_REPLAY
+
+#include <memory>
+#include <string>
+
+#include "multibeep/policy/policy.hpp"
+#include "multibeep/bandit/bandit.hpp"
+#include "multibeep/arm/replay.hpp"
+#include "multibeep/util/pull_log.hpp"
+
+namespace multibeep{ namespace policies{
+
+	/* \brief fills an empty bandit with one replay arm per arm of a recorded run
+	 *
+	 * The arms get the identifiers they had in the recorded run, so any policy
+	 * played on the bandit sees the same arms, but no arm is evaluated again.
+	 */
+	template<typename num_t=double, typename rng_t = std::default_random_engine>
+	void add_replay_arms(multibeep::bandits::base<num_t, rng_t> &b, const multibeep::util::pull_records<num_t> &records){
+		if (b.number_of_arms() > 0)
+			throw std::invalid_argument("Replay arms have to be added to an empty bandit");
+		b.add_arms(multibeep::arms::replay_arms_from_log<num_t, rng_t>(records));
+	}
+
+	template<typename num_t=double, typename rng_t = std::default_random_engine>
+	void add_replay_arms(multibeep::bandits::base<num_t, rng_t> &b, const std::string &filename){
+		add_replay_arms(b, multibeep::util::read_pull_log<num_t>(filename));
+	}
+
+	/* \brief plays a policy on a bandit of replay arms until the budget is used or the recorded rewards run out
+	 *
+	 * \returns true if all num_rounds rounds were played, false if the policy
+	 * wanted to pull an arm more often than in the recorded run. All pulls up
+	 * to that point are part of the bandit's state.
+	 */
+	template<typename num_t=double, typename rng_t = std::default_random_engine>
+	bool replay_n_rounds(base<num_t, rng_t> &policy, unsigned int num_rounds){
+		try{
+			policy.play_n_rounds(num_rounds);
+		}
+		catch (multibeep::arms::replay_exhausted &){
+			return(false);
+		}
+		return(true);
+	}
+
+}}
+#endif
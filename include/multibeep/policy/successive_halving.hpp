@@ -19,11 +19,16 @@ namespace multibeep{ namespace policies{
 			num_t eta_pulls;
 			num_t eta_arms;
 			
+			// pulls per arm in the next round and the number of rounds played, so play_n_rounds can continue a run
+			unsigned int r_k;
+			unsigned int round;
+			
 		public:
 		
 			successive_halving(std::shared_ptr<multibeep::bandits::base<num_t, rng_t> > b_ptr,
 								unsigned int min_pulls, num_t eta_arms, num_t eta_pulls):
-				base_t(b_ptr), min_pulls_per_round(min_pulls), eta_pulls(eta_pulls), eta_arms(eta_arms) {}
+				base_t(b_ptr), min_pulls_per_round(min_pulls), eta_pulls(eta_pulls), eta_arms(eta_arms),
+				r_k(min_pulls), round(0) {}
 		
 		
 			successive_halving(std::shared_ptr<multibeep::bandits::base<num_t,rng_t> > b_ptr,
@@ -37,14 +42,27 @@ namespace multibeep{ namespace policies{
 			}
 			
 			
+			/* \brief number of rounds played so far*/
+			unsigned int number_of_rounds() const {return(round);}
+			
+			/* \brief writes the current round and its number of pulls per arm*/
+			virtual void save(multibeep::util::serialization::writer &w) const {
+				w.write(r_k);
+				w.write(round);
+			}
+			
+			virtual void load(multibeep::util::serialization::reader &r){
+				r_k = r.read<unsigned int>();
+				round = r.read<unsigned int>();
+			}
+			
+			/* \brief plays num_rounds further rounds, continuing where the previous call stopped*/
 			virtual void play_n_rounds (unsigned int num_rounds){
 				
 				// convenience alias for the bandit
 				auto &b (*(base_t::bandit_ptr));
 				
-				unsigned int r_k = min_pulls_per_round;
-				
-				for (int round=0; round< (int) num_rounds; round++){
+				for (auto i=0u; i < num_rounds; i++, round++){
 					
 					for (auto mew=0u; mew < b.number_of_active_arms(); mew++){
 						for (auto mew2=0u; mew2 < r_k; mew2++)
@@ -30,10 +30,14 @@ namespace multibeep{ namespace policies{
 		public:
 			UCB_base(std::shared_ptr<multibeep::bandits::base<num_t, rng_t> > b_ptr, std::shared_ptr<rng_t> r_ptr):
 				base_t(b_ptr), rng_ptr(r_ptr){}
+
+			/* \brief the state of the random number generator*/
+			virtual void save(multibeep::util::serialization::writer &w) const {w.write_rng(*rng_ptr);}
+			virtual void load(multibeep::util::serialization::reader &r) {r.read_rng(*rng_ptr);}
 			
 			virtual unsigned int select_next_arm(){
 				
-					unsigned int best_index;
+					unsigned int best_index = 0;
 					num_t rnd = std::numeric_limits<num_t>::lowest();
 					num_t max_ucb = std::numeric_limits<num_t>::lowest();
 				
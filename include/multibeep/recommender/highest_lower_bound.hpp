@@ -0,0 +1,28 @@
+#ifndef MULTIBEEP_RECOMMENDER_HIGHEST_LOWER_BOUND
+#define MULTIBEEP_RECOMMENDER_HIGHEST_LOWER_BOUND
+
+#include "multibeep/recommender/recommender.hpp"
+
+namespace multibeep{ namespace recommender{
+
+	/* \brief recommends the arm with the highest lower confidence bound of its posterior
+	 *
+	 * The bound is the lower end of posteriors::base::support(delta), i.e. the
+	 * delta/2 quantile. Arms without a posterior are not recommended.
+	 */
+	template<typename num_t=double, typename rng_t = std::default_random_engine>
+	class highest_lower_bound: public multibeep::recommender::base<num_t, rng_t>{
+		protected:
+			num_t delta;
+
+			virtual num_t score(const multibeep::bandits::arm_info<num_t, rng_t> &ai){
+				if (!ai.posterior) return(NAN);
+				return(ai.posterior->support(delta).first);
+			}
+		public:
+			highest_lower_bound(num_t delta): delta(delta) {}
+
+			std::string get_ident() {return(std::string("highest lower bound"));}
+	};
+}}
+#endif
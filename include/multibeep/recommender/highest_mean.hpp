@@ -0,0 +1,19 @@
+#ifndef MULTIBEEP_RECOMMENDER_HIGHEST_MEAN
+#define MULTIBEEP_RECOMMENDER_HIGHEST_MEAN
+
+#include "multibeep/recommender/recommender.hpp"
+
+namespace multibeep{ namespace recommender{
+
+	/* \brief recommends the arm with the highest estimated mean of the bandit*/
+	template<typename num_t=double, typename rng_t = std::default_random_engine>
+	class highest_mean: public multibeep::recommender::base<num_t, rng_t>{
+		protected:
+			virtual num_t score(const multibeep::bandits::arm_info<num_t, rng_t> &ai){
+				return(ai.estimated_mean);
+			}
+		public:
+			std::string get_ident() {return(std::string("highest mean"));}
+	};
+}}
+#endif
@@ -0,0 +1,69 @@
+#ifndef MULTIBEEP_RECOMMENDER_HIGHEST_PMAX
+#define MULTIBEEP_RECOMMENDER_HIGHEST_PMAX
+
+#include "multibeep/recommender/recommender.hpp"
+
+namespace multibeep{ namespace recommender{
+
+	/* \brief recommends the arm with the highest p_max
+	 *
+	 * The scores only change when the bandit's p_max values are updated (see
+	 * bandits::base::update_p_max and set_background_pmax), pulls do not touch
+	 * them. The recommendation distribution is p_max itself, normalized over
+	 * the arms it was computed for; the expected real mean under it is kept
+	 * up to date with every reported value, so the regret is O(1) as well.
+	 */
+	template<typename num_t=double, typename rng_t = std::default_random_engine>
+	class highest_pmax: public multibeep::recommender::base<num_t, rng_t>{
+		protected:
+			typedef multibeep::recommender::base<num_t, rng_t> base_t;
+
+			// sum of all scores and of the scores times the real means
+			num_t sum_p, sum_p_mean;
+
+			virtual num_t score(const multibeep::bandits::arm_info<num_t, rng_t> &ai){
+				return(ai.p_max);
+			}
+
+		public:
+			highest_pmax(): sum_p(0), sum_p_mean(0) {}
+
+			std::string get_ident() {return(std::string("highest p_max"));}
+
+			virtual void reset(){
+				base_t::reset();
+				sum_p = sum_p_mean = 0;
+			}
+
+			virtual void arm_pulled(const multibeep::bandits::arm_info<num_t, rng_t> &) {}
+
+			virtual void pmax_updated(const multibeep::bandits::arm_info<num_t, rng_t> &ai){
+				auto id = ai.identifier;
+				num_t old = base_t::scores.at(id);
+				if (!std::isnan(old)){
+					sum_p -= old;
+					sum_p_mean -= old*base_t::real_means[id];
+				}
+				base_t::set_score(id, score(ai));
+				num_t s = base_t::scores[id];
+				if (!std::isnan(s)){
+					sum_p += s;
+					sum_p_mean += s*base_t::real_means[id];
+				}
+			}
+
+			virtual std::vector<num_t> recommendation_distribution() const {
+				std::vector<num_t> p(base_t::scores.size(), 0);
+				if (sum_p <= 0) return(p);
+				for (auto i=0u; i < p.size(); ++i)
+					if (!std::isnan(base_t::scores[i])) p[i] = base_t::scores[i]/sum_p;
+				return(p);
+			}
+
+			virtual num_t instantaneous_regret() const {
+				if (sum_p <= 0) return(NAN);
+				return(base_t::best_real_mean - sum_p_mean/sum_p);
+			}
+	};
+}}
+#endif
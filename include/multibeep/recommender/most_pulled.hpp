@@ -0,0 +1,23 @@
+#ifndef MULTIBEEP_RECOMMENDER_MOST_PULLED
+#define MULTIBEEP_RECOMMENDER_MOST_PULLED
+
+#include "multibeep/recommender/recommender.hpp"
+
+namespace multibeep{ namespace recommender{
+
+	/* \brief recommends the arm pulled most often
+	 *
+	 * Robust against arms whose mean is overestimated from a few lucky pulls,
+	 * as long as the policy concentrates its pulls on the best arm.
+	 */
+	template<typename num_t=double, typename rng_t = std::default_random_engine>
+	class most_pulled: public multibeep::recommender::base<num_t, rng_t>{
+		protected:
+			virtual num_t score(const multibeep::bandits::arm_info<num_t, rng_t> &ai){
+				return(ai.num_pulls);
+			}
+		public:
+			std::string get_ident() {return(std::string("most pulled"));}
+	};
+}}
+#endif
@@ -2,25 +2,148 @@
 #define MULTIBEEP_RECOMMENDER
 
 
-#include <vector>
+#include <algorithm>
+#include <cmath>
+#include <limits>
 #include <random>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "multibeep/bandit/arm_info.hpp"
 
 
 namespace multibeep{ namespace recommender{
 
 
+	/* \brief recommends an arm at any time, e.g. for anytime reporting of a run
+	 *
+	 * A recommender is attached to a bandit (see bandits::base::add_recommender),
+	 * which reports every added arm, every pull, every p_max update and every
+	 * (de)activation. Each arm gets a score from what was reported and the arms
+	 * are kept ordered by it, so a report costs O(log K), the best arm is
+	 * available in O(1) and the k best in O(k). Arms without a score (NAN) are
+	 * not recommended. Deactivated arms keep their score unless a subclass says
+	 * otherwise: a recommendation is about which arm is best, not which is played.
+	 */
 	template<typename num_t = double, typename rng_t = std::default_random_engine>
 	class base{
+		protected:
+			// highest score first, the smaller identifier breaks ties
+			struct higher_score{
+				bool operator() (const std::pair<num_t, unsigned int> &a, const std::pair<num_t, unsigned int> &b) const {
+					return((a.first > b.first) || ((a.first == b.first) && (a.second < b.second)));
+				}
+			};
+
+			std::set<std::pair<num_t, unsigned int>, higher_score> ranking;
+			// by identifier, NAN if the arm has no score
+			std::vector<num_t> scores;
+			std::vector<num_t> real_means;
+			num_t best_real_mean;
+
+			/* \brief the score of an arm from its arm info, NAN if there is none yet*/
+			virtual num_t score(const multibeep::bandits::arm_info<num_t, rng_t> &ai) = 0;
+
+			/* \brief moves the arm to its new place in the ranking; NAN removes it*/
+			void set_score(unsigned int identifier, num_t s){
+				auto &old = scores.at(identifier);
+				if ((old == s) || (std::isnan(old) && std::isnan(s))) return;
+				if (!std::isnan(old)) ranking.erase(std::make_pair(old, identifier));
+				old = s;
+				if (!std::isnan(s)) ranking.emplace(s, identifier);
+			}
+
+		public:
+			base(): best_real_mean(std::numeric_limits<num_t>::lowest()) {}
+
+			virtual ~base() {}
+
+			virtual std::string get_ident() = 0;
+
+			/* \brief forgets all arms, called by the bandit before it reports all of them again*/
+			virtual void reset(){
+				ranking.clear();
+				scores.clear();
+				real_means.clear();
+				best_real_mean = std::numeric_limits<num_t>::lowest();
+			}
+
+			/* \brief called by the bandit for every new arm*/
+			virtual void arm_added(const multibeep::bandits::arm_info<num_t, rng_t> &ai){
+				if (ai.identifier >= scores.size()){
+					scores.resize(ai.identifier+1, NAN);
+					real_means.resize(ai.identifier+1, NAN);
+				}
+				real_means[ai.identifier] = ai.get_arm_ptr()->real_mean();
+				if (real_means[ai.identifier] > best_real_mean)
+					best_real_mean = real_means[ai.identifier];
+			}
+
+			/* \brief called by the bandit with the up-to-date arm info after every pull of it*/
+			virtual void arm_pulled(const multibeep::bandits::arm_info<num_t, rng_t> &ai){
+				set_score(ai.identifier, score(ai));
+			}
+
+			/* \brief called by the bandit for every arm after the p_max values changed*/
+			virtual void pmax_updated(const multibeep::bandits::arm_info<num_t, rng_t> &) {}
+
+			/* \brief called by the bandit after an arm was deactivated*/
+			virtual void arm_deactivated(const multibeep::bandits::arm_info<num_t, rng_t> &) {}
+
+			/* \brief called by the bandit with the up-to-date arm info after an arm was reactivated*/
+			virtual void arm_reactivated(const multibeep::bandits::arm_info<num_t, rng_t> &) {}
+
+			bool has_recommendation() const {return(!ranking.empty());}
+
+			/* \brief identifier of the recommended arm*/
+			unsigned int best_identifier() const {
+				if (ranking.empty())
+					throw std::runtime_error("No arm can be recommended yet");
+				return(ranking.begin()->second);
+			}
+
+			/* \brief score of the recommended arm, NAN if there is none*/
+			num_t best_score() const {
+				return(ranking.empty() ? NAN : ranking.begin()->first);
+			}
+
+			/* \brief identifiers of the (up to) k arms with the highest scores, best first; O(k)*/
+			std::vector<unsigned int> top_identifiers(unsigned int k) const {
+				std::vector<unsigned int> ids;
+				ids.reserve(std::min<size_t>(k, ranking.size()));
+				for (auto it = ranking.begin(); (it != ranking.end()) && (ids.size() < k); ++it)
+					ids.push_back(it->second);
+				return(ids);
+			}
 
-		/* \brie computes the instantanious regret based on the recommendation distribution*/
-		num_t instantanious_regret (multibeep::bandits::base * b_ptr) = 0;
+			/* \brief number of arms with a score*/
+			unsigned int number_of_ranked_arms() const {return(ranking.size());}
 
-		/* \brief suggests a distribution over the arms by index*/
-		std::vector<num_t> recommender_distribution_index (multibeep::bandits::base * b_ptr, bool consider_inactive = false) = 0;
+			/* \brief score of the arm with the given identifier, NAN if it has none*/
+			num_t score_by_identifier(unsigned int identifier) const {return(scores.at(identifier));}
 
-		/* \brief suggests a distribution over all arms by identifier*/
-		std::vector<num_t> recommender_distribution_identifier (multibeep::bandits::base * b_ptr) = 0;
+			/* \brief probability of recommending each arm, by identifier
+			 *
+			 * All weight is on the recommended arm, unless a subclass knows better.
+			 * All zeros without a recommendation.
+			 */
+			virtual std::vector<num_t> recommendation_distribution() const {
+				std::vector<num_t> p(scores.size(), 0);
+				if (!ranking.empty()) p[best_identifier()] = 1;
+				return(p);
+			}
 
+			/* \brief difference between the best real mean and the expected real mean of the recommendation
+			 *
+			 * NAN without a recommendation.
+			 */
+			virtual num_t instantaneous_regret() const {
+				if (ranking.empty()) return(NAN);
+				return(best_real_mean - real_means[best_identifier()]);
+			}
 	};
 
 }}
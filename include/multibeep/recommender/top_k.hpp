@@ -0,0 +1,47 @@
+#ifndef MULTIBEEP_RECOMMENDER_TOP_K
+#define MULTIBEEP_RECOMMENDER_TOP_K
+
+#include "multibeep/recommender/recommender.hpp"
+
+namespace multibeep{ namespace recommender{
+
+	/* \brief ranks the active arms by their estimated mean or a lower confidence bound
+	 *
+	 * An incremental replacement for bandits::base::sort_active_arms_by_mean:
+	 * only the pulled arm moves in the ranking (O(log K)), the k best arms
+	 * are read with top_identifiers(k) in O(k), and the order of the arms in
+	 * the bandit is left untouched. Unlike the other recommenders, deactivated
+	 * arms drop out of the ranking and come back when they are reactivated.
+	 */
+	template<typename num_t=double, typename rng_t = std::default_random_engine>
+	class top_k: public multibeep::recommender::base<num_t, rng_t>{
+		protected:
+			typedef multibeep::recommender::base<num_t, rng_t> base_t;
+			// NAN ranks by the estimated mean
+			num_t delta;
+
+			virtual num_t score(const multibeep::bandits::arm_info<num_t, rng_t> &ai){
+				if (!ai.is_active) return(NAN);
+				if (std::isnan(delta)) return(ai.estimated_mean);
+				if (!ai.posterior) return(NAN);
+				return(ai.posterior->support(delta).first);
+			}
+		public:
+			/* \brief ranks by the estimated mean*/
+			top_k(): delta(NAN) {}
+
+			/* \brief ranks by the lower end of posteriors::base::support(delta)*/
+			top_k(num_t delta): delta(delta) {}
+
+			std::string get_ident() {return(std::string(std::isnan(delta) ? "top k by mean" : "top k by lower bound"));}
+
+			virtual void arm_deactivated(const multibeep::bandits::arm_info<num_t, rng_t> &ai){
+				base_t::set_score(ai.identifier, NAN);
+			}
+
+			virtual void arm_reactivated(const multibeep::bandits::arm_info<num_t, rng_t> &ai){
+				base_t::set_score(ai.identifier, score(ai));
+			}
+	};
+}}
+#endif
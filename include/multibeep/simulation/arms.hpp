@@ -0,0 +1,64 @@
+#ifndef MULTIBEEP_SIMULATION_ARMS
+#define MULTIBEEP_SIMULATION_ARMS
+
+#include <cmath>
+#include <string>
+
+#include <boost/random.hpp>
+#include <boost/random/exponential_distribution.hpp>
+
+/* Arms for the compile-time compositions in multibeep::simulation.
+ *
+ * They draw from the same distributions as their counterparts in
+ * multibeep::arms, but they are plain values without virtual methods. The
+ * random number generator is owned by the bandit and passed to every pull,
+ * so a pull can be inlined into the bandit's pull loop. Any type with the
+ * same three methods can be used as an arm.
+ */
+
+namespace multibeep{ namespace simulation{
+
+template<typename num_t = double>
+class normal_arm{
+	boost::random::normal_distribution<num_t> rand_dist;
+  public:
+	/* \brief see multibeep::arms::normal_arm*/
+	normal_arm(num_t mean, num_t variance): rand_dist(mean, std::sqrt(variance)) {}
+
+	template <typename rng_t>
+	num_t pull(rng_t &rng) {return(rand_dist(rng));}
+
+	num_t real_mean()		const	{return(rand_dist.mean());}
+	num_t real_variance()	const	{return(rand_dist.sigma()*rand_dist.sigma());}
+};
+
+
+template<typename num_t = double>
+class bernoulli_arm{
+	boost::random::bernoulli_distribution<num_t> rand_dist;
+  public:
+	bernoulli_arm(num_t p): rand_dist(p) {}
+
+	template <typename rng_t>
+	num_t pull(rng_t &rng) {return(rand_dist(rng));}
+
+	num_t real_mean()		const	{return(rand_dist.p());}
+	num_t real_variance()	const	{return(rand_dist.p() * (1-rand_dist.p()));}
+};
+
+
+template<typename num_t = double>
+class exponential_arm{
+	boost::random::exponential_distribution<num_t> rand_dist;
+  public:
+	exponential_arm(num_t lambda): rand_dist(lambda) {}
+
+	template <typename rng_t>
+	num_t pull(rng_t &rng) {return(rand_dist(rng));}
+
+	num_t real_mean()		const	{return(1./rand_dist.lambda());}
+	num_t real_variance()	const	{return(1./(rand_dist.lambda()*rand_dist.lambda()));}
+};
+
+}}
+#endif
@@ -0,0 +1,177 @@
+#ifndef MULTIBEEP_SIMULATION_BANDITS
+#define MULTIBEEP_SIMULATION_BANDITS
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <memory>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+#include <boost/math/distributions/normal.hpp>
+
+#include "multibeep/util/statistics.hpp"
+
+/* Compile-time counterparts of multibeep::bandits for large simulation studies.
+ *
+ * The dynamic bandits hold arms of any type behind virtual calls, which is
+ * what the Python interface needs. Here the arm and the posterior type are
+ * template parameters and the bandit calls its derived class through CRTP,
+ * so the compiler can inline a complete select -> pull -> update step. The
+ * price is that all arms of a bandit have the same type, which is the common
+ * case in simulations. There is no deactivation, no checkpointing and no
+ * p_max, the dynamic bandits remain the full-featured interface.
+ */
+
+namespace multibeep{ namespace simulation{
+
+/* \brief posterior based on a boost::math distribution, without virtual methods
+ *
+ * The same quantities as multibeep::util::posteriors::simple_posterior, with
+ * the same NAN on a domain error.
+ */
+template <typename boost_math_distribution_t, typename num_t = double>
+class posterior{
+	boost_math_distribution_t posterior_dist;
+  public:
+	template <typename ... A>
+	posterior(A ... args): posterior_dist(args...) {}
+
+	num_t mean() const {
+		try{return(boost::math::mean(posterior_dist));}
+		catch (const std::domain_error &e){return(NAN);}
+	}
+	num_t variance() const {
+		try{return(boost::math::variance(posterior_dist));}
+		catch (const std::domain_error &e){return(NAN);}
+	}
+	num_t pdf(num_t x) const {
+		try{return(boost::math::pdf(posterior_dist,x));}
+		catch (const std::domain_error &e){return(NAN);}
+	}
+	num_t cdf(num_t x) const {
+		try{return(boost::math::cdf(posterior_dist,x));}
+		catch (const std::domain_error &e){return(NAN);}
+	}
+	num_t quantile(num_t x) const {
+		try{return(boost::math::quantile(posterior_dist,x));}
+		catch (const std::domain_error &e){return(NAN);}
+	}
+};
+
+template <typename num_t = double>
+using gaussian_posterior = posterior<boost::math::normal_distribution<num_t>, num_t>;
+
+
+/* \brief what a bandit knows about one arm, the counterpart of multibeep::bandits::arm_info*/
+template <typename arm_t, typename posterior_t, typename num_t = double>
+struct arm_info{
+	arm_t arm;
+	unsigned int identifier;
+	long double num_pulls;
+	multibeep::util::statistics::running_statistics<num_t> reward_stats;
+	num_t estimated_mean;
+	num_t estimated_variance;
+	// only meaningful if has_posterior is set
+	posterior_t posterior;
+	bool has_posterior;
+	bool dirty;
+
+	arm_info(const arm_t &a, unsigned int ident):
+		arm(a), identifier(ident), num_pulls(0), estimated_mean(NAN), estimated_variance(NAN),
+		posterior(), has_posterior(false), dirty(true) {}
+};
+
+
+/* \brief CRTP base of all compile-time bandits
+ *
+ * derived_t has to provide update_arm_info(arm_info_t &), which is called
+ * by operator[] for arm infos whose rewards changed since the last call.
+ */
+template <typename derived_t, typename arm_t, typename posterior_t, typename num_t = double, typename rng_t = std::default_random_engine>
+class bandit_base{
+  public:
+	typedef multibeep::simulation::arm_info<arm_t, posterior_t, num_t> arm_info_t;
+	typedef num_t num_type;
+	typedef rng_t rng_type;
+
+  protected:
+	std::vector<arm_info_t> arm_infos;
+	std::shared_ptr<rng_t> rng_ptr;
+	unsigned int num_pulls;
+	unsigned int num_pulled_arms;
+	num_t cummulative_reward;
+
+  public:
+	/* \brief the arms draw their rewards from the given random number generator*/
+	bandit_base(std::shared_ptr<rng_t> r_ptr): rng_ptr(r_ptr), num_pulls(0), num_pulled_arms(0), cummulative_reward(0) {}
+
+	/* \brief adds a copy of the arm, returns its identifier*/
+	unsigned int add_arm(const arm_t &arm){
+		arm_infos.emplace_back(arm, arm_infos.size());
+		return(arm_infos.back().identifier);
+	}
+
+	num_t pull_by_index(unsigned int index){
+		auto &ai = arm_infos[index];
+		num_t r = ai.arm.pull(*rng_ptr);
+		if (ai.num_pulls == 0) num_pulled_arms++;
+		ai.reward_stats(r);
+		ai.num_pulls++;
+		ai.dirty = true;
+		num_pulls++;
+		cummulative_reward += r;
+		return(r);
+	}
+
+	/* \brief makes sure each arm is pulled a given number of times*/
+	void min_pull_arms(unsigned int min_num_pulls){
+		for (auto i=0u; i < arm_infos.size(); i++)
+			while (arm_infos[i].num_pulls < min_num_pulls)
+				pull_by_index(i);
+	}
+
+	/* \brief the lazily updated arm info, see multibeep::bandits::base::operator[]*/
+	const arm_info_t & operator[] (unsigned int index){
+		auto &ai = arm_infos[index];
+		if (ai.dirty){
+			static_cast<derived_t*>(this)->update_arm_info(ai);
+			ai.dirty = false;
+		}
+		return(ai);
+	}
+
+	unsigned int number_of_arms() const {return(arm_infos.size());}
+	// all arms are always active
+	unsigned int number_of_active_arms() const {return(arm_infos.size());}
+	unsigned int number_of_pulls() const {return(num_pulls);}
+	unsigned int number_of_pulled_arms() const {return(num_pulled_arms);}
+	num_t cummulative_rewards() const {return(cummulative_reward);}
+};
+
+
+/* \brief Gaussian estimate of the mean from the rewards, see multibeep::bandits::empirical*/
+template <typename arm_t, typename num_t = double, typename rng_t = std::default_random_engine>
+class empirical: public bandit_base<empirical<arm_t, num_t, rng_t>, arm_t, gaussian_posterior<num_t>, num_t, rng_t>{
+	typedef bandit_base<empirical<arm_t, num_t, rng_t>, arm_t, gaussian_posterior<num_t>, num_t, rng_t> base_t;
+	friend base_t;
+
+	void update_arm_info(typename base_t::arm_info_t &ai){
+		// empirical stats require at least 2 pulls to make sense
+		if (ai.reward_stats.number_of_points() > 1){
+			ai.estimated_mean = ai.reward_stats.mean();
+			ai.estimated_variance = std::max<num_t>(1e-6, ai.reward_stats.variance()/ai.reward_stats.number_of_points());
+			ai.posterior = gaussian_posterior<num_t>(ai.reward_stats.mean(),
+				std::sqrt(std::max(std::numeric_limits<num_t>::min(), ai.reward_stats.variance()/ai.reward_stats.number_of_points())));
+			ai.has_posterior = true;
+		}
+		else ai.has_posterior = false;
+	}
+
+  public:
+	empirical(std::shared_ptr<rng_t> r_ptr): base_t(r_ptr) {}
+};
+
+}}
+#endif
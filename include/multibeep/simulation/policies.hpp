@@ -0,0 +1,158 @@
+#ifndef MULTIBEEP_SIMULATION_POLICIES
+#define MULTIBEEP_SIMULATION_POLICIES
+
+#include <cmath>
+#include <limits>
+#include <memory>
+#include <random>
+
+#include "multibeep/simulation/bandits.hpp"
+
+/* Compile-time counterparts of multibeep::policies, see simulation/bandits.hpp.
+ *
+ * A policy is a template over the concrete bandit type and calls its derived
+ * class through CRTP, so play_n_rounds compiles into a loop without a single
+ * virtual call. With the same seeds, every policy here makes exactly the
+ * same choices as its counterpart in multibeep::policies.
+ */
+
+namespace multibeep{ namespace simulation{
+
+/* \brief CRTP base of all compile-time policies; derived_t has to provide select_next_arm()*/
+template <typename derived_t, typename bandit_t>
+class policy_base{
+  protected:
+	typedef typename bandit_t::num_type num_t;
+	typedef typename bandit_t::rng_type rng_t;
+	std::shared_ptr<bandit_t> bandit_ptr;
+
+  public:
+	policy_base(std::shared_ptr<bandit_t> b_ptr): bandit_ptr(b_ptr) {}
+
+	/* \brief selects and pulls the arm num_rounds times*/
+	void play_n_rounds(unsigned int num_rounds){
+		while (num_rounds > 0){
+			bandit_ptr->pull_by_index(static_cast<derived_t*>(this)->select_next_arm());
+			--num_rounds;
+		}
+	}
+};
+
+
+/* \brief UCB flavours that differ only in the confidence gap, see multibeep::policies::UCB_base
+ *
+ * derived_t has to provide calculate_confidence_gap(const arm_info_t &),
+ * returning NAN if the arm has to be pulled before a gap can be computed.
+ */
+template <typename derived_t, typename bandit_t>
+class UCB_base: public policy_base<derived_t, bandit_t>{
+  protected:
+	typedef policy_base<derived_t, bandit_t> base_t;
+	typedef typename base_t::num_t num_t;
+	typedef typename base_t::rng_t rng_t;
+	std::shared_ptr<rng_t> rng_ptr;
+
+  public:
+	UCB_base(std::shared_ptr<bandit_t> b_ptr, std::shared_ptr<rng_t> r_ptr): base_t(b_ptr), rng_ptr(r_ptr) {}
+
+	unsigned int select_next_arm(){
+		auto &b (*base_t::bandit_ptr);
+		unsigned int best_index = 0;
+		num_t rnd = std::numeric_limits<num_t>::lowest();
+		num_t max_ucb = std::numeric_limits<num_t>::lowest();
+
+		for (auto i=0u; i < b.number_of_active_arms(); i++){
+			auto &ai = b[i];
+			num_t gap = static_cast<derived_t*>(this)->calculate_confidence_gap(ai);
+			if (std::isnan(gap))
+				return(i);
+
+			num_t ucb = ai.estimated_mean + gap;
+			// the same random tie-breaking as multibeep::policies::UCB_base
+			if (ucb == max_ucb){
+				num_t tmp = (*rng_ptr)();
+				if (tmp > rnd){
+					rnd = tmp;
+					best_index = i;
+				}
+			}
+			if (ucb > max_ucb){
+				max_ucb = ucb;
+				rnd = (*rng_ptr)();
+				best_index = i;
+			}
+		}
+		return(best_index);
+	}
+};
+
+
+/* \brief see multibeep::policies::UCB_p*/
+template <typename bandit_t>
+class UCB_p: public UCB_base<UCB_p<bandit_t>, bandit_t>{
+	typedef UCB_base<UCB_p<bandit_t>, bandit_t> ucb_t;
+	typedef typename ucb_t::num_t num_t;
+	typedef typename ucb_t::rng_t rng_t;
+	num_t p;
+
+  public:
+	UCB_p(std::shared_ptr<bandit_t> b_ptr, std::shared_ptr<rng_t> r_ptr, num_t p): ucb_t(b_ptr, r_ptr), p(p) {}
+
+	num_t calculate_confidence_gap(const typename bandit_t::arm_info_t &ai) const {
+		if (std::isnan(ai.estimated_variance)) return(NAN);
+		auto N = ucb_t::bandit_ptr->number_of_pulls();
+		return(std::sqrt(ai.estimated_variance*p*log(N)));
+	}
+};
+
+
+/* \brief see multibeep::policies::prob_match*/
+template <typename bandit_t>
+class prob_match: public policy_base<prob_match<bandit_t>, bandit_t>{
+	typedef policy_base<prob_match<bandit_t>, bandit_t> base_t;
+	typedef typename base_t::num_t num_t;
+	typedef typename base_t::rng_t rng_t;
+	std::shared_ptr<rng_t> rng_ptr;
+
+  public:
+	prob_match(std::shared_ptr<bandit_t> b_ptr, std::shared_ptr<rng_t> r_ptr): base_t(b_ptr), rng_ptr(r_ptr) {}
+
+	unsigned int select_next_arm(){
+		auto &b (*base_t::bandit_ptr);
+		std::uniform_real_distribution<num_t> u(0,1);
+
+		num_t max = std::numeric_limits<num_t>::lowest();
+		unsigned int index = 0;
+		for (auto i=0u; i < b.number_of_active_arms(); i++){
+			auto &ai = b[i];
+			if (!ai.has_posterior) return(i);
+			num_t sample(ai.posterior.quantile(u(*rng_ptr)));
+			if (std::isnan(sample)) return(i);
+			if (sample > max){
+				max = sample;
+				index = i;
+			}
+		}
+		return(index);
+	}
+};
+
+
+/* \brief see multibeep::policies::random*/
+template <typename bandit_t>
+class random: public policy_base<random<bandit_t>, bandit_t>{
+	typedef policy_base<random<bandit_t>, bandit_t> base_t;
+	typedef typename base_t::rng_t rng_t;
+	std::shared_ptr<rng_t> rng_ptr;
+
+  public:
+	random(std::shared_ptr<bandit_t> b_ptr, std::shared_ptr<rng_t> r_ptr): base_t(b_ptr), rng_ptr(r_ptr) {}
+
+	unsigned int select_next_arm(){
+		std::uniform_int_distribution<unsigned int> u (0, base_t::bandit_ptr->number_of_active_arms()-1);
+		return(u(*rng_ptr));
+	}
+};
+
+}}
+#endif
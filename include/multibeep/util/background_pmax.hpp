@@ -0,0 +1,144 @@
+#ifndef MULTIBEEP_UTIL_BACKGROUND_PMAX
+#define MULTIBEEP_UTIL_BACKGROUND_PMAX
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "multibeep/util/p_max.hpp"
+
+namespace multibeep{ namespace util{ namespace pmax{
+
+	/* \brief the posteriors of a bandit at one point in time, and later the p_max values computed from them*/
+	template<typename num_t = double, typename rng_t = std::default_random_engine>
+	struct snapshot{
+		// increases with every snapshot of the same bandit
+		uint64_t version = 0;
+		// number of pulls of the bandit when the snapshot was taken
+		uint64_t num_pulls = 0;
+		std::vector<unsigned int> identifiers;
+		post_vector_t<num_t, rng_t> posteriors;
+		// filled by the worker, one value per identifier
+		std::vector<num_t> p_max;
+		// set by the worker instead of p_max if the computation failed
+		std::exception_ptr error;
+	};
+
+
+	/* \brief computes p_max on its own thread from snapshots of the posteriors
+	 *
+	 * The bandit posts a snapshot whenever the worker is idle and the p_max
+	 * values are outdated, and collects the result when it is ready (see
+	 * bandits::base::set_background_pmax). The posteriors are never modified
+	 * after their creation, so sharing them with the worker is safe. Only the
+	 * latest result is kept; the pulling thread never waits for the worker.
+	 */
+	template<typename num_t = double, typename rng_t = std::default_random_engine>
+	class background_worker{
+		num_t delta;
+		unsigned int GL_num_points;
+		bool consider_inactive_arms;
+
+		std::mutex mutex;
+		std::condition_variable wake_up;
+		std::unique_ptr<snapshot<num_t, rng_t> > pending, result;
+		std::atomic<bool> busy, stop;
+		std::atomic<uint64_t> result_version;
+		std::thread thread;
+
+		void run(){
+			std::unique_lock<std::mutex> lock(mutex);
+			while (true){
+				wake_up.wait(lock, [this] () {return(stop || pending);});
+				if (stop) return;
+				std::unique_ptr<snapshot<num_t, rng_t> > s(std::move(pending));
+				lock.unlock();
+
+				// an exception would terminate the program on this thread, it is rethrown by take_result
+				try{
+					s->p_max = compute_pmax_all<num_t, rng_t>(s->posteriors, delta, GL_num_points);
+				}
+				catch (...){
+					s->error = std::current_exception();
+				}
+				// release the posteriors on this thread, not the pulling one
+				s->posteriors.clear();
+
+				lock.lock();
+				result = std::move(s);
+				result_version.store(result->version, std::memory_order_release);
+				busy = false;
+			}
+		}
+
+	  public:
+		/* \brief starts the worker thread
+		 *
+		 * \param delta				see bandits::base::update_p_max
+		 * \param GL_num_points		see bandits::base::update_p_max
+		 * \param consider_inactive	see bandits::base::update_p_max
+		 */
+		background_worker(num_t delta, unsigned int GL_num_points, bool consider_inactive = false):
+			delta(delta), GL_num_points(GL_num_points), consider_inactive_arms(consider_inactive),
+			busy(false), stop(false), result_version(0),
+			thread(&background_worker::run, this) {}
+
+		background_worker(const background_worker &) = delete;
+		background_worker & operator=(const background_worker &) = delete;
+
+		~background_worker(){
+			{
+				std::lock_guard<std::mutex> lock(mutex);
+				stop = true;
+			}
+			wake_up.notify_one();
+			thread.join();
+		}
+
+		bool consider_inactive() const {return(consider_inactive_arms);}
+
+		/* \brief whether a posted snapshot is not finished yet*/
+		bool is_busy() const {return(busy.load(std::memory_order_acquire));}
+
+		/* \brief hands a snapshot to the worker; ignored while it is busy*/
+		void post(std::unique_ptr<snapshot<num_t, rng_t> > s){
+			{
+				std::lock_guard<std::mutex> lock(mutex);
+				if (busy) return;
+				busy = true;
+				pending = std::move(s);
+			}
+			wake_up.notify_one();
+		}
+
+		/* \brief version of the latest finished snapshot, 0 if there is none (one atomic load)*/
+		uint64_t latest_version() const {return(result_version.load(std::memory_order_acquire));}
+
+		/* \brief takes the latest finished snapshot, an empty pointer if it was taken already
+		 *
+		 * Rethrows the exception of a failed computation; the worker accepts
+		 * the next snapshot nonetheless.
+		 */
+		std::unique_ptr<snapshot<num_t, rng_t> > take_result(){
+			std::unique_ptr<snapshot<num_t, rng_t> > s;
+			{
+				std::lock_guard<std::mutex> lock(mutex);
+				s = std::move(result);
+			}
+			if (s && s->error) std::rethrow_exception(s->error);
+			return(s);
+		}
+
+		/* \brief blocks until the worker is idle, e.g. before reading the final values*/
+		void wait() const {
+			while (is_busy()) std::this_thread::yield();
+		}
+	};
+
+}}}
+#endif
@@ -0,0 +1,216 @@
+#ifndef MULTIBEEP_UTIL_COLUMNAR_LOADER
+#define MULTIBEEP_UTIL_COLUMNAR_LOADER
+
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <string>
+#include <vector>
+#include <fstream>
+#include <stdexcept>
+
+#include "multibeep/util/data_matrix.hpp"
+
+namespace multibeep{ namespace util{ namespace columnar{
+
+	/* \brief substitutions applied to every value of a CSV file
+	 *
+	 * Empty or unparsable fields are replaced by missing_value, values >= cutoff
+	 * by cutoff_value (e.g. timeouts in a performance matrix). Afterwards all
+	 * values are multiplied by scale, e.g. -1 to turn runtimes into rewards.
+	 */
+	template <typename num_t = double>
+	struct substitution{
+		num_t missing_value;
+		num_t cutoff;
+		num_t cutoff_value;
+		num_t scale;
+
+		substitution(num_t missing = NAN, num_t c = std::numeric_limits<num_t>::infinity(), num_t c_value = NAN, num_t s = 1):
+			missing_value(missing), cutoff(c), cutoff_value(c_value), scale(s) {}
+
+		num_t operator() (const char * field, size_t length) const {
+			num_t v = missing_value;
+			if (length > 0){
+				std::string f(field, length);
+				char * end;
+				num_t x = std::strtod(f.c_str(), &end);
+				bool parsed = (end != f.c_str());
+				// only whitespace may follow the number
+				while ((*end == ' ') || (*end == '\t') || (*end == '\r')) ++end;
+				if (parsed && (*end == '\0') && (!std::isnan(x)))
+					v = (x >= cutoff) ? cutoff_value : x;
+			}
+			return(v*scale);
+		}
+	};
+
+
+	// splits a line into fields, calls f(column, begin, length) for every field
+	template <typename function_t>
+	unsigned int split(const std::string &line, char delimiter, function_t f){
+		unsigned int j = 0;
+		size_t begin = 0;
+		while (true){
+			size_t end = line.find(delimiter, begin);
+			if (end == std::string::npos) end = line.size();
+			f(j++, line.data()+begin, end - begin);
+			if (end == line.size()) break;
+			begin = end+1;
+		}
+		return(j);
+	}
+
+	inline std::string strip(const std::string &s){
+		auto b = s.find_first_not_of(" \t\r\"");
+		if (b == std::string::npos) return(std::string());
+		auto e = s.find_last_not_of(" \t\r\"");
+		return(s.substr(b, e-b+1));
+	}
+
+
+	/* \brief reads a CSV file with one row per instance and one column per arm into a column-major matrix
+	 *
+	 * The file is read twice: once to count the rows, and once to write every value
+	 * directly to its place in the column-major buffer. So the data is never held
+	 * twice in memory.
+	 *
+	 * \param filename		the CSV file
+	 * \param delimiter		separates the fields of a row
+	 * \param skip_columns	number of leading columns that are ignored, e.g. instance names
+	 * \param header		whether the first row contains the column names
+	 * \param subs			missing value and cutoff handling
+	 * \param num_threads	number of threads computing the column statistics, 0 means one per core
+	 */
+	template <typename num_t = double>
+	std::shared_ptr<data_matrix<num_t> > read_csv(	const std::string &filename, char delimiter = ',', unsigned int skip_columns = 0,
+													bool header = true, substitution<num_t> subs = substitution<num_t>(),
+													unsigned int num_threads = 0){
+		std::ifstream in(filename);
+		if (!in)
+			throw std::runtime_error("Could not open " + filename);
+
+		std::string line;
+		std::vector<std::string> names;
+		unsigned int num_cols = 0;
+
+		if (header && std::getline(in, line)){
+			num_cols = split(line, delimiter, [&] (unsigned int j, const char * f, size_t l){
+				if (j >= skip_columns) names.push_back(strip(std::string(f, l)));
+			});
+		}
+
+		// first pass: number of (non empty) rows
+		size_t data_begin = in.tellg();
+		unsigned int num_rows = 0;
+		while (std::getline(in, line)){
+			if (strip(line).empty()) continue;
+			if (num_cols == 0)
+				num_cols = split(line, delimiter, [] (unsigned int, const char *, size_t) {});
+			num_rows++;
+		}
+		if (num_cols <= skip_columns)
+			throw std::runtime_error(filename + " does not contain any data columns");
+		if (num_rows == 0)
+			throw std::runtime_error(filename + " does not contain any data rows");
+		num_cols -= skip_columns;
+
+		// second pass: fill the columns
+		std::vector<num_t> values(((size_t) num_rows)*num_cols, subs.missing_value*subs.scale);
+		in.clear();
+		in.seekg(data_begin);
+		unsigned int i = 0;
+		while ((i < num_rows) && std::getline(in, line)){
+			if (strip(line).empty()) continue;
+			auto n = split(line, delimiter, [&] (unsigned int j, const char * f, size_t l){
+				if ((j >= skip_columns) && (j - skip_columns < num_cols))
+					values[((size_t) (j-skip_columns))*num_rows + i] = subs(f, l);
+			});
+			if (n != num_cols + skip_columns)
+				throw std::runtime_error(filename + ": row " + std::to_string(i) + " has " + std::to_string(n) + " fields instead of " + std::to_string(num_cols + skip_columns));
+			i++;
+		}
+
+		auto m = std::make_shared<data_matrix<num_t> > (std::move(values), num_rows, num_cols, num_threads);
+		m->set_column_names(names);
+		return(m);
+	}
+
+
+	/* \brief layout of the binary columnar format
+	 *
+	 * magic (8 bytes), sizeof(num_t), number of rows, number of columns (uint32 each),
+	 * then for every column the length of its name (uint32) and the name itself,
+	 * zero padding up to the next multiple of 8 bytes, and finally all values in
+	 * column-major order. The values can be memory mapped directly.
+	 */
+	static const char binary_magic[8] = {'M','B','C','O','L','0','0','1'};
+
+	/* \brief writes a matrix in the binary columnar format*/
+	template <typename num_t>
+	void write_binary(const std::string &filename, const data_matrix<num_t> &m){
+		std::ofstream out(filename, std::ios::binary);
+		if (!out)
+			throw std::runtime_error("Could not open " + filename);
+
+		uint32_t header[3] = {sizeof(num_t), m.number_of_rows(), m.number_of_columns()};
+		out.write(binary_magic, sizeof(binary_magic));
+		out.write(reinterpret_cast<const char*>(header), sizeof(header));
+		size_t pos = sizeof(binary_magic) + sizeof(header);
+
+		for (auto j=0u; j < m.number_of_columns(); ++j){
+			auto name = m.column_name(j);
+			uint32_t l = name.size();
+			out.write(reinterpret_cast<const char*>(&l), sizeof(l));
+			out.write(name.data(), l);
+			pos += sizeof(l) + l;
+		}
+		const char zeros[8] = {0};
+		out.write(zeros, (8 - pos%8)%8);
+
+		for (auto j=0u; j < m.number_of_columns(); ++j)
+			out.write(reinterpret_cast<const char*>(m.column(j)), ((size_t) m.number_of_rows())*sizeof(num_t));
+		if (!out)
+			throw std::runtime_error("Could not write " + filename);
+	}
+
+	/* \brief memory maps a file in the binary columnar format*/
+	template <typename num_t = double>
+	std::shared_ptr<data_matrix<num_t> > read_binary(const std::string &filename, unsigned int num_threads = 0){
+		std::ifstream in(filename, std::ios::binary);
+		if (!in)
+			throw std::runtime_error("Could not open " + filename);
+
+		char magic[8];
+		uint32_t header[3];
+		in.read(magic, sizeof(magic));
+		in.read(reinterpret_cast<char*>(header), sizeof(header));
+		if ((!in) || (std::memcmp(magic, binary_magic, sizeof(magic)) != 0))
+			throw std::runtime_error(filename + " is not a binary columnar file");
+		if (header[0] != sizeof(num_t))
+			throw std::runtime_error(filename + " contains values of a different type");
+		if (header[1] == 0)
+			throw std::runtime_error(filename + " does not contain any data rows");
+
+		std::vector<std::string> names(header[2]);
+		for (auto &name: names){
+			uint32_t l;
+			in.read(reinterpret_cast<char*>(&l), sizeof(l));
+			name.resize(l);
+			in.read(&name[0], l);
+		}
+		if (!in)
+			throw std::runtime_error(filename + " is truncated");
+		size_t pos = in.tellg();
+		pos += (8 - pos%8)%8;
+
+		auto m = data_matrix<num_t>::map_file(filename, header[1], header[2], pos, num_threads);
+		m->set_column_names(names);
+		return(m);
+	}
+
+}}}
+#endif
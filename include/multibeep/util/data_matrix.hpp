@@ -0,0 +1,160 @@
+#ifndef MULTIBEEP_UTIL_DATA_MATRIX
+#define MULTIBEEP_UTIL_DATA_MATRIX
+
+#include <cmath>
+#include <memory>
+#include <vector>
+#include <string>
+#include <thread>
+#include <atomic>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "multibeep/util/statistics.hpp"
+
+namespace multibeep{ namespace util{
+
+	/* \brief read-only column-major matrix shared by many data arms
+	 *
+	 * Every column holds the values of one arm. The memory is not copied: it is
+	 * either owned by the matrix (a vector or a memory mapped file) or belongs
+	 * to someone else who is notified by a callback once the last arm using
+	 * the matrix is gone (used by the Python bindings to keep a NumPy array alive).
+	 * Mean and variance of all columns are computed once, in parallel.
+	 */
+	template <typename num_t = double>
+	class data_matrix{
+		public:
+			// C-style callback releasing external memory, used by the Python bindings
+			typedef void (*release_wrapper)(void*);
+
+		protected:
+			// keeps the memory alive, the deleter releases it
+			std::shared_ptr<const void> owner;
+			const num_t * values;
+			unsigned int num_rows, num_cols;
+
+			std::vector<num_t> means, variances;
+			std::vector<std::string> names;
+
+			void compute_statistics(unsigned int num_threads){
+				means.assign(num_cols, NAN);
+				variances.assign(num_cols, NAN);
+
+				std::atomic<unsigned int> next(0);
+				auto worker = [&] (){
+					for (unsigned int j = next++; j < num_cols; j = next++){
+						multibeep::util::statistics::running_statistics<num_t> stat;
+						auto c = column(j);
+						for (auto i=0u; i < num_rows; ++i)
+							stat(c[i]);
+						means[j] = stat.mean();
+						variances[j] = stat.variance();
+					}
+				};
+
+				if (num_threads == 0)
+					num_threads = std::max(1u, std::thread::hardware_concurrency());
+				num_threads = std::min(num_threads, num_cols);
+
+				if (num_threads <= 1)
+					worker();
+				else{
+					std::vector<std::thread> pool;
+					for (auto i=0u; i < num_threads; ++i)
+						pool.emplace_back(worker);
+					for (auto &t: pool)
+						t.join();
+				}
+			}
+
+		public:
+
+			/* \brief takes ownership of the values */
+			data_matrix(std::vector<num_t> &&data, unsigned int rows, unsigned int cols, unsigned int num_threads = 0):
+				num_rows(rows), num_cols(cols){
+				if (data.size() != ((size_t) rows)*cols)
+					throw std::invalid_argument("Size of the data does not match the dimensions of the matrix");
+				auto v = std::make_shared<std::vector<num_t> > (std::move(data));
+				values = v->data();
+				owner = v;
+				compute_statistics(num_threads);
+			}
+
+			/* \brief views memory owned by someone else
+			 *
+			 * release(obj) is called when the matrix and all arms using it are destroyed.
+			 */
+			data_matrix(const num_t * data, unsigned int rows, unsigned int cols, void * obj, release_wrapper release, unsigned int num_threads = 0):
+				values(data), num_rows(rows), num_cols(cols){
+				owner = std::shared_ptr<const void> (obj, [release] (const void * o) {if (release) release(const_cast<void*>(o));});
+				compute_statistics(num_threads);
+			}
+
+			/* \brief maps a file containing rows*cols values in column-major order
+			 *
+			 * \param filename	the file
+			 * \param rows		number of values per column
+			 * \param cols		number of columns
+			 * \param offset	position of the first value in the file in bytes, e.g. to skip a header
+			 */
+			static std::shared_ptr<data_matrix> map_file(const std::string &filename, unsigned int rows, unsigned int cols,
+												size_t offset = 0, unsigned int num_threads = 0){
+				if (rows == 0)
+					throw std::runtime_error("Can not map an empty matrix from " + filename);
+				int fd = open(filename.c_str(), O_RDONLY);
+				if (fd < 0)
+					throw std::runtime_error("Could not open " + filename);
+
+				struct stat st;
+				size_t length = offset + ((size_t) rows)*cols*sizeof(num_t);
+				if ((fstat(fd, &st) != 0) || ((size_t) st.st_size < length)){
+					close(fd);
+					throw std::runtime_error(filename + " is too small for the requested matrix");
+				}
+
+				void * addr = mmap(nullptr, length, PROT_READ, MAP_SHARED, fd, 0);
+				close(fd);
+				if (addr == MAP_FAILED)
+					throw std::runtime_error("Could not map " + filename);
+
+				std::shared_ptr<data_matrix> m (new data_matrix());
+				m->values = reinterpret_cast<const num_t*> (static_cast<const char*>(addr) + offset);
+				m->num_rows = rows;
+				m->num_cols = cols;
+				m->owner = std::shared_ptr<const void> (addr, [length] (const void *a) {munmap(const_cast<void*>(a), length);});
+				m->compute_statistics(num_threads);
+				return(m);
+			}
+
+			unsigned int number_of_rows()		const {return(num_rows);}
+			unsigned int number_of_columns()	const {return(num_cols);}
+
+			/* \brief pointer to the first value of column j, the values of a column are contiguous */
+			const num_t * column(unsigned int j) const {return(values + ((size_t) j)*num_rows);}
+
+			num_t column_mean(unsigned int j)		const {return(means.at(j));}
+			num_t column_variance(unsigned int j)	const {return(variances.at(j));}
+
+			/* \brief name of column j, e.g. from the header of a file; the index if no names were set*/
+			std::string column_name(unsigned int j) const {
+				if (j >= num_cols) throw std::out_of_range("Column index exceeds the number of columns of the matrix");
+				return(names.empty() ? std::to_string(j) : names[j]);
+			}
+
+			void set_column_names(const std::vector<std::string> &n){
+				if ((!n.empty()) && (n.size() != num_cols))
+					throw std::invalid_argument("There has to be one name per column");
+				names = n;
+			}
+
+		protected:
+			data_matrix(): values(nullptr), num_rows(0), num_cols(0) {}
+	};
+
+}}
+#endif
@@ -0,0 +1,114 @@
+#ifndef MULTIBEEP_UTIL_EVENT_RING
+#define MULTIBEEP_UTIL_EVENT_RING
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <vector>
+#include <stdexcept>
+
+namespace multibeep{ namespace util{
+
+	/* \brief what happened to the arm of an event*/
+	enum event_type: uint32_t{
+		arm_added = 0,
+		arm_pulled = 1,
+		arm_deactivated = 2,
+		arm_reactivated = 3,
+		// identifier is the number of arms considered, value is NAN
+		pmax_updated = 4
+	};
+
+
+	/* \brief fixed-size record of a single event of a bandit*/
+	template <typename num_t = double>
+	struct event{
+		// number of pulls of the bandit when the event happened
+		uint64_t num_pulls;
+		uint32_t type;
+		uint32_t identifier;
+		// the reward of a pull, NAN for all other events
+		num_t value;
+	};
+
+
+	/* \brief bounded single-producer single-consumer queue of events
+	 *
+	 * The bandit pushes from the thread that pulls it, one observer thread
+	 * pops. Neither side ever blocks or allocates: if the consumer falls
+	 * behind, new events are dropped and counted instead of overwriting
+	 * old ones that might be read at the same time.
+	 */
+	template <typename num_t = double>
+	class event_ring{
+		std::vector<event<num_t> > buffer;
+		uint64_t mask;
+
+		// the producer's and the consumer's positions live on different cache lines
+		char padding_0[64];
+		// written by the producer only
+		std::atomic<uint64_t> head;
+		uint64_t cached_tail;
+		std::atomic<uint64_t> num_dropped;
+		char padding_1[64];
+		// written by the consumer only
+		std::atomic<uint64_t> tail;
+		uint64_t cached_head;
+
+	  public:
+		/* \brief the capacity is rounded up to the next power of two*/
+		event_ring(unsigned int capacity = 4096):
+			mask(0), head(0), cached_tail(0), num_dropped(0), tail(0), cached_head(0){
+			if (capacity == 0)
+				throw std::invalid_argument("The capacity of an event ring has to be positive");
+			uint64_t n = 1;
+			while (n < capacity) n <<= 1;
+			buffer.resize(n);
+			mask = n-1;
+		}
+
+		event_ring(const event_ring &) = delete;
+		event_ring & operator=(const event_ring &) = delete;
+
+		/* \brief called by the producer; returns false if the event was dropped*/
+		bool push(uint64_t num_pulls, event_type type, unsigned int identifier, num_t value){
+			auto h = head.load(std::memory_order_relaxed);
+			if (h - cached_tail > mask){
+				cached_tail = tail.load(std::memory_order_acquire);
+				if (h - cached_tail > mask){
+					num_dropped.fetch_add(1, std::memory_order_relaxed);
+					return(false);
+				}
+			}
+			auto &e = buffer[h & mask];
+			e.num_pulls = num_pulls;
+			e.type = type;
+			e.identifier = identifier;
+			e.value = value;
+			head.store(h+1, std::memory_order_release);
+			return(true);
+		}
+
+		/* \brief called by the consumer; copies up to max_events events into out and returns their number*/
+		size_t pop(event<num_t> * out, size_t max_events){
+			auto t = tail.load(std::memory_order_relaxed);
+			if (cached_head - t < max_events)
+				cached_head = head.load(std::memory_order_acquire);
+			size_t n = std::min<uint64_t>(cached_head - t, max_events);
+			for (auto i=0u; i < n; ++i)
+				out[i] = buffer[(t+i) & mask];
+			tail.store(t+n, std::memory_order_release);
+			return(n);
+		}
+
+		unsigned int capacity() const {return(buffer.size());}
+
+		/* \brief number of events not consumed yet (a snapshot when called concurrently)*/
+		size_t size() const {return(head.load(std::memory_order_acquire) - tail.load(std::memory_order_acquire));}
+
+		/* \brief number of events dropped because the ring was full*/
+		uint64_t dropped() const {return(num_dropped.load(std::memory_order_relaxed));}
+	};
+
+}}
+#endif
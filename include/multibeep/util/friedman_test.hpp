@@ -6,6 +6,10 @@
 #include <limits>
 #include <algorithm>
 #include <numeric>
+#include <map>
+#include <cmath>
+#include <iostream>
+#include <stdexcept>
 #include <boost/math/distributions/students_t.hpp>
 #include <boost/math/distributions/chi_squared.hpp>
 
@@ -35,13 +39,41 @@ void print_vv_t(vv_t vv){
 
 
 
+/*\brief ranks the entries of one 'round', the largest value gets rank 1
+ * 
+ * Ties get the average of their ranks. The index vector is only reused to avoid
+ * reallocations, its size determines the number of values.
+ */
+template <typename num_t, typename value_accessor_t>
+void rank_round(value_accessor_t value, std::vector<unsigned int> &indices, std::vector<num_t> &ranks){
+	std::iota(indices.begin(), indices.end(),0);
+	std::sort(
+		indices.begin(), indices.end(),
+		[&value] (unsigned int a, unsigned int b){return(value(a) > value(b));}
+	);
+
+	for (auto it1=indices.begin(); it1!=indices.end(); ){
+		auto it2 = it1; it2++;
+		num_t n = 1, sum = std::distance(indices.begin(), it1)+1;
+		while ( (it2 != indices.end()) && value(*it2) == value(*it1)){
+			n+=1;
+			sum += std::distance(indices.begin(), it2)+1;
+			it2++;
+		}
+		for (auto it3=it1; it3!=it2; it3++)
+			ranks[*it3] = sum/n;
+		it1 = it2;
+	}
+}
+
+
 template <typename num_t>
 /*\brief non-parametric friedman test to identify underperforming arms
  * 
  * \param performances vector of pointers to reward vectors (to avoid copies)
  * \return vector of vectors with the mean ranks
  */
-std::vector<std::vector<num_t> > compute_ranks( std::vector< std::vector<num_t>* >performances){
+std::vector<std::vector<num_t> > compute_ranks( const std::vector< std::vector<num_t>* > &performances){
 	/* notation follows 
 	 * Birattari, Mauro, et al. "F-Race and iterated F-Race: An overview."
 	 * in Experimental methods for the analysis of optimization algorithms. Springer Berlin Heidelberg, 2010. 311-336.
@@ -50,6 +82,7 @@ std::vector<std::vector<num_t> > compute_ranks( std::vector< std::vector<num_t>*
 	 
 	 // number of arms
 	unsigned int m = performances.size();
+	if (m == 0) return(std::vector<std::vector<num_t> >());
 	// number of pulls
 	unsigned int k = std::numeric_limits<unsigned int>::max();
 	
@@ -61,109 +94,189 @@ std::vector<std::vector<num_t> > compute_ranks( std::vector< std::vector<num_t>*
 	std::vector<std::vector<num_t> > ranks(m, std::vector<num_t> (k,0) );
 	
 	std::vector<unsigned int> indices (m);
-	std::iota(indices.begin(), indices.end(),0);
+	std::vector<num_t> round_ranks (m);
 	
 	//compute ranks for each 'round'
 	for (auto i=0u; i<k; i++){
-		std::sort(
-			indices.begin(), indices.end(),
-			[performances, i] (unsigned int a, unsigned int b){return((*(performances[a]))[i] > (*(performances[b]))[i]);}
-		);
-
-		for (auto it1=indices.begin(); it1!=indices.end(); ){
-			auto it2 = it1; it2++;
-			num_t n = 1, sum = std::distance(indices.begin(), it1)+1;
-			while ( (it2 != indices.end()) && (*(performances[*it2]))[i] == (*(performances[*it1]))[i]){
-				n+=1;
-				sum += std::distance(indices.begin(), it2)+1;
-				it2++;
-			}
-			for (auto it3=it1; it3!=it2; it3++)
-				ranks[*it3][i] = sum/n;
-			it1 = it2;
-		}
+		rank_round<num_t>([&performances, i] (unsigned int a) {return((*(performances[a]))[i]);}, indices, round_ranks);
+		for (auto j=0u; j<m; j++)
+			ranks[j][i] = round_ranks[j];
 	}
 	return(ranks);
 }
 
 
+/*\brief caches the quantiles needed by the friedman test for every (m, alpha) combination*/
 template <typename num_t>
-/*\brief non-parametric friedman test to identify underperforming arms
+class quantile_cache{
+	std::map<std::pair<unsigned int, num_t>, std::pair<num_t, num_t> > cache;
+  public:
+	/* \brief returns the (1-alpha)-quantile of the χ² distribution and the (1-alpha/2)-quantile of the Student-t distribution, both with m-1 degrees of freedom*/
+	const std::pair<num_t, num_t> & operator() (unsigned int m, num_t alpha){
+		auto key = std::make_pair(m, alpha);
+		auto it = cache.find(key);
+		if (it == cache.end()){
+			auto chi_s = boost::math::chi_squared_distribution<num_t>(m-1);
+			// note, the paper doesn't specify the degrees of freedom!
+			auto students_t = boost::math::students_t_distribution<num_t>(m-1);
+			it = cache.emplace(key, std::make_pair(boost::math::quantile(chi_s, 1-alpha), boost::math::quantile(students_t, 1-alpha/2))).first;
+		}
+		return(it->second);
+	}
+};
+
+
+/*\brief friedman test where the rank statistics are updated every time a new round of rewards arrives
  * 
- * \param performances vector of pointers to reward vectors (to avoid copies)
- * \param alpha confidence level, usually 0.05
- * \return (possibly empty) vector of indices for arms that perform significantly worse then the 'best' arm
+ * Adding a round costs O(m log m) for m arms. Removing arms requires to rerank
+ * all previous rounds, so arms should be removed in bulk.
  */
-std::vector<unsigned int> friedman_test( std::vector< std::vector<num_t>* >performances, num_t alpha){
-	/* notation follows 
-	 * Birattari, Mauro, et al. "F-Race and iterated F-Race: An overview."
-	 * in Experimental methods for the analysis of optimization algorithms. Springer Berlin Heidelberg, 2010. 311-336.
-	 * http://iridia.ulb.ac.be/~mbiro/paperi/BirYuaBalStu2010emaoa.pdf
-	 */
-	// the return vector
-	std::vector<unsigned int> rv();
-
-	auto ranks = compute_ranks(performances);
-	 // number of arms
-	num_t m = ranks.size();
-	// number of pulls
-	num_t k = ranks[0].size();
+template <typename num_t>
+class incremental_friedman{
+	// rewards of every round, one entry per arm
+	std::vector<std::vector<num_t> > rounds;
+	std::vector<num_t> sum_R, sum_R2;
+	// buffers for ranking a single round
+	std::vector<unsigned int> indices;
+	std::vector<num_t> ranks;
+	quantile_cache<num_t> quantiles;
 
-	std::vector<unsigned int> sum_R(m,0), sum_R2(m,0);
-	
-	// compute simple statistics
-	for (auto i=0u; i<m; ++i){
-		for (auto j=0u; j<k; ++j){
-			sum_R [i] += ranks[i][j];
-			sum_R2[i] += ranks[i][j]*ranks[i][j];
+	void add_ranks(const std::vector<num_t> &values){
+		rank_round<num_t>([&values] (unsigned int a) {return(values[a]);}, indices, ranks);
+		for (auto j=0u; j < ranks.size(); ++j){
+			sum_R [j] += ranks[j];
+			sum_R2[j] += ranks[j]*ranks[j];
 		}
 	}
-	
-	// compute T as the quantity determening whether the ranking is consistent with the null-hypothesis (all arms perform equally)
-	num_t T_numerator(0), T_denominator(0);
-	
-	for (auto i=0u; i<m; ++i){
-		T_numerator   += std::pow(sum_R[i] - k*(m+1)/2, 2);
-		T_denominator += sum_R2[i];
+
+  public:
+	incremental_friedman(unsigned int m): sum_R(m,0), sum_R2(m,0), indices(m), ranks(m) {}
+
+	unsigned int number_of_arms()	const {return(sum_R.size());}
+	unsigned int number_of_rounds()	const {return(rounds.size());}
+	const std::vector<num_t> & rank_sums() const {return(sum_R);}
+	const std::vector<num_t> & squared_rank_sums() const {return(sum_R2);}
+	/* \brief the values of all rounds added so far, one entry per arm*/
+	const std::vector<std::vector<num_t> > & round_values() const {return(rounds);}
+
+	/* \brief adds the rewards of one round, one value per arm*/
+	void add_round(const std::vector<num_t> &values){
+		if (values.size() != number_of_arms())
+			throw std::invalid_argument("Every round needs exactly one value per arm.");
+		rounds.push_back(values);
+		add_ranks(values);
 	}
-	T_numerator   *= (m-1);
-	T_denominator -= k*m*(m+1)*(m+1)/4;
-	
-	auto T = T_numerator/T_denominator;
-	
 
+	/* \brief removes the arms with the given indices and recomputes the ranks of the remaining ones*/
+	void remove(const std::vector<unsigned int> &to_remove){
+		if (to_remove.empty()) return;
+		std::vector<bool> keep(number_of_arms(), true);
+		for (auto i: to_remove) keep.at(i) = false;
 
-	// T follows approximately a χ² distribution
-	auto chi_s = boost::math::chi_squared_distribution<num_t>(m-1);
-	// the null-hypothesis should be rejected if this value is larger that the (1-alpha)-quantile
-	if (T > boost::math::quantile(chi_s, 1-alpha)){
-		// in that case, do a post hoc analysis (following F-Race: a la Conover) by pairwise comparison with the lowest mean rank arm
-		
-		// note, the paper doesn't specify the degrees of freedom!
-		auto students_t = boost::math::students_t_distribution<num_t>(m-1);
-		auto threshold = quantile(students_t, 1-alpha/2);
-		
-		
-		// find arm with lowest average rank
-		auto min_mean_rank = *(std::min_element(sum_R.begin(), sum_R.end()));
-
-		auto Z = 0;
-		for (auto &r2: sum_R2)	Z +=r2;
-		Z -= k*m*(m+1)*(m+1)/4;
-		Z *= 2*k*(1-T/(k*(m-1)));
-		Z /= (k-1)*(m-1);
-		Z = std::sqrt(1./Z);
-		
-		
-		//compare every other arm against the 'best'
-		for (auto i=0u; sum_R.size(); i++){
-			// add the ones that perform significantly worse to the return vector
-			if (Z*std::abs(sum_R[i] - min_mean_rank) > threshold ) rv.push_back(i);
+		for (auto &r: rounds){
+			auto j = 0u;
+			for (auto i=0u; i < r.size(); ++i)
+				if (keep[i]) r[j++] = r[i];
+			r.resize(j);
 		}
+
+		unsigned int m = std::count(keep.begin(), keep.end(), true);
+		sum_R.assign(m, 0); sum_R2.assign(m,0);
+		indices.resize(m); ranks.resize(m);
+		for (auto &r: rounds)
+			add_ranks(r);
 	}
-	return(rv);
-}
 
+	/*\brief test which arms perform significantly worse than the one with the lowest rank sum
+	 * 
+	 * \param alpha confidence level, usually 0.05
+	 * \return (possibly empty) vector of indices for arms that perform significantly worse then the 'best' arm
+	 */
+	std::vector<unsigned int> test(num_t alpha){
+		/* notation follows 
+		 * Birattari, Mauro, et al. "F-Race and iterated F-Race: An overview."
+		 * in Experimental methods for the analysis of optimization algorithms. Springer Berlin Heidelberg, 2010. 311-336.
+		 * http://iridia.ulb.ac.be/~mbiro/paperi/BirYuaBalStu2010emaoa.pdf
+		 */
+		std::vector<unsigned int> rv;
+
+		// number of arms
+		num_t m = number_of_arms();
+		// number of rounds
+		num_t k = number_of_rounds();
+
+		if ((m < 2) || (k < 2)) return(rv);
+
+		// compute T as the quantity determening whether the ranking is consistent with the null-hypothesis (all arms perform equally)
+		num_t T_numerator(0), T_denominator(0);
+
+		for (auto i=0u; i<m; ++i){
+			T_numerator   += std::pow(sum_R[i] - k*(m+1)/2, 2);
+			T_denominator += sum_R2[i];
+		}
+		T_numerator   *= (m-1);
+		T_denominator -= k*m*(m+1)*(m+1)/4;
+
+		// all arms tied in every round
+		if (T_denominator <= 0) return(rv);
+
+		auto T = T_numerator/T_denominator;
+
+		auto &q = quantiles(m, alpha);
+
+		// T follows approximately a χ² distribution
+		// the null-hypothesis should be rejected if this value is larger that the (1-alpha)-quantile
+		if (T > q.first){
+			// in that case, do a post hoc analysis (following F-Race: a la Conover) by pairwise comparison with the lowest mean rank arm
+
+			// find arm with lowest average rank
+			auto min_rank_sum = *(std::min_element(sum_R.begin(), sum_R.end()));
+
+			num_t Z = T_denominator;
+			Z *= 2*k*(1-T/(k*(m-1)));
+			Z /= (k-1)*(m-1);
+
+			//compare every other arm against the 'best'
+			for (auto i=0u; i < sum_R.size(); i++){
+				// add the ones that perform significantly worse to the return vector
+				// (Z vanishes if the ranking is the same in every round)
+				if (Z <= 0){
+					if (sum_R[i] > min_rank_sum) rv.push_back(i);
+				}
+				else if (std::abs(sum_R[i] - min_rank_sum)/std::sqrt(Z) > q.second ) rv.push_back(i);
+			}
+		}
+		return(rv);
+	}
+};
+
+
+template <typename num_t>
+/*\brief non-parametric friedman test to identify underperforming arms
+ * 
+ * \param performances vector of pointers to reward vectors (to avoid copies)
+ * \param alpha confidence level, usually 0.05
+ * \return (possibly empty) vector of indices for arms that perform significantly worse then the 'best' arm
+ */
+std::vector<unsigned int> friedman_test( const std::vector< std::vector<num_t>* > &performances, num_t alpha){
+	
+	 // number of arms
+	unsigned int m = performances.size();
+	if (m == 0) return(std::vector<unsigned int>());
+	// number of pulls
+	unsigned int k = std::numeric_limits<unsigned int>::max();
+	for (auto &p : performances)
+		k = std::min<unsigned int>(k, p->size());
+
+	incremental_friedman<num_t> f(m);
+	std::vector<num_t> values(m);
+	for (auto i=0u; i<k; ++i){
+		for (auto j=0u; j<m; ++j)
+			values[j] = (*(performances[j]))[i];
+		f.add_round(values);
+	}
+	return(f.test(alpha));
+}
 
 
 
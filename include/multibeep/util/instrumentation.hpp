@@ -0,0 +1,56 @@
+#ifndef MULTIBEEP_UTIL_INSTRUMENTATION
+#define MULTIBEEP_UTIL_INSTRUMENTATION
+
+#include <chrono>
+#include <cstdint>
+
+namespace multibeep{ namespace util{ namespace instrumentation{
+
+	/* \brief whether the counters are compiled in
+	 *
+	 * Defining MULTIBEEP_NO_STATS removes all counting and timing from the
+	 * hot paths; the stats of bandits and policies then always stay zero.
+	 * Otherwise they are collected once enabled at runtime.
+	 */
+#ifdef MULTIBEEP_NO_STATS
+	static const bool compiled_in = false;
+#else
+	static const bool compiled_in = true;
+#endif
+
+	typedef std::chrono::steady_clock clock;
+
+	/* \brief nanoseconds since start*/
+	inline uint64_t elapsed_ns(clock::time_point start){
+		return(std::chrono::duration_cast<std::chrono::nanoseconds>(clock::now() - start).count());
+	}
+
+
+	/* \brief counters and cumulative timings (in nanoseconds) of a bandit*/
+	struct bandit_stats{
+		// pulls and the time spent inside the arms
+		uint64_t num_pulls = 0;
+		uint64_t pull_ns = 0;
+		// updates of dirty arm infos and the posteriors created by them
+		uint64_t num_arm_info_updates = 0;
+		uint64_t arm_info_update_ns = 0;
+		uint64_t num_posterior_allocations = 0;
+		// calls of update_p_max, those that took a family fast path, and the integrals actually computed
+		uint64_t num_pmax_updates = 0;
+		uint64_t pmax_ns = 0;
+		uint64_t num_pmax_fast_paths = 0;
+		uint64_t num_pmax_integrals = 0;
+		// every quadrature node is one call of the integrand, which evaluates at most one pdf/cdf per posterior
+		uint64_t num_quadrature_nodes = 0;
+		uint64_t num_posterior_evaluations = 0;
+	};
+
+
+	/* \brief counters and cumulative timings (in nanoseconds) of a policy*/
+	struct policy_stats{
+		uint64_t num_selections = 0;
+		uint64_t selection_ns = 0;
+	};
+
+}}}
+#endif
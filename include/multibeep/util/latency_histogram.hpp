@@ -0,0 +1,58 @@
+#ifndef MULTIBEEP_UTIL_LATENCY_HISTOGRAM
+#define MULTIBEEP_UTIL_LATENCY_HISTOGRAM
+
+#include <array>
+#include <cmath>
+#include <cstdint>
+
+namespace multibeep{ namespace util{
+
+	/* \brief histogram of durations with power-of-two buckets
+	 *
+	 * Bucket 0 counts durations of 0ns, bucket b > 0 counts durations in
+	 * [2^(b-1), 2^b) nanoseconds. Recording a duration is a handful of
+	 * instructions and never allocates, so it can be done on every pull.
+	 */
+	class latency_histogram{
+		std::array<uint64_t, 65> counts;
+		uint64_t num_samples;
+		uint64_t total_ns;
+
+	  public:
+		latency_histogram(): num_samples(0), total_ns(0) {counts.fill(0);}
+
+		static unsigned int bucket(uint64_t ns){
+			return(ns == 0 ? 0 : 64 - __builtin_clzll(ns));
+		}
+
+		/* \brief records n durations of ns nanoseconds each*/
+		void operator() (uint64_t ns, uint64_t n = 1){
+			counts[bucket(ns)] += n;
+			num_samples += n;
+			total_ns += ns*n;
+		}
+
+		uint64_t count() const {return(num_samples);}
+		uint64_t total_nanoseconds() const {return(total_ns);}
+
+		/* \brief mean duration in seconds, NAN without any samples*/
+		double mean_seconds() const {
+			return(num_samples == 0 ? NAN : 1e-9*total_ns/num_samples);
+		}
+
+		/* \brief upper edge (in nanoseconds) of the bucket containing the q-quantile, 0 without any samples*/
+		uint64_t quantile_ns(double q) const {
+			uint64_t seen = 0;
+			for (auto b=0u; b < counts.size(); ++b){
+				seen += counts[b];
+				if ((seen > 0) && (seen >= q*num_samples))
+					return(b == 0 ? 0 : (b == 64 ? UINT64_MAX : (uint64_t(1) << b) - 1));
+			}
+			return(0);
+		}
+
+		const std::array<uint64_t, 65> & buckets() const {return(counts);}
+	};
+
+}}
+#endif
@@ -2,11 +2,13 @@
 #define MULTIBEEP_UTIL_PMAX
 
 #include <vector>
+#include <memory>
 #include <random>
 #include <algorithm>
 #include <iterator>
 
 #include <multibeep/util/posteriors.hpp>
+#include <multibeep/util/p_max_families.hpp>
 #include <gauss_legendre/gauss_legendre.c>
 
 
@@ -77,8 +79,9 @@ void normalize(std::vector<num_t> & vec){
 
 
 
+/* \brief p_max of all arms by numerical integration through the virtual posterior interface*/
 template<typename num_t = double, typename rng_t = std::default_random_engine>
-std::vector<num_t> compute_pmax_all (post_vector_t<num_t, rng_t> &posts, num_t delta, unsigned int number_of_points){
+std::vector<num_t> compute_pmax_generic (post_vector_t<num_t, rng_t> &posts, num_t delta, unsigned int number_of_points){
 
 	std::vector<num_t> pmax_values(posts.size(), 0.);
 
@@ -91,6 +94,75 @@ std::vector<num_t> compute_pmax_all (post_vector_t<num_t, rng_t> &posts, num_t d
 }
 
 
+/* \brief p_max of all arms, with a fast path if all posteriors belong to the same family
+ *
+ * All-gaussian posteriors (e.g. empirical bandits) and all-beta posteriors
+ * (e.g. Bernoulli arms) are handled by gaussian_pmax and beta_pmax, any
+ * other mix by compute_pmax_generic. Arms without a posterior are treated
+ * the same way in all cases. If a report is given, the path taken and the
+ * integrals, nodes and pdf/cdf evaluations actually used are added to it.
+ */
+template<typename num_t = double, typename rng_t = std::default_random_engine>
+std::vector<num_t> compute_pmax_all (post_vector_t<num_t, rng_t> &posts, num_t delta, unsigned int number_of_points,
+	pmax_report * report = nullptr){
+
+	// every node of the generic quadrature evaluates the pdf and the cdfs of all posteriors
+	auto generic = [&] (uint64_t num_valid) {
+		if (report){
+			report->taken = pmax_report::path::generic;
+			report->num_integrals += num_valid;
+			report->num_quadrature_nodes += num_valid*number_of_points;
+			report->num_posterior_evaluations += num_valid*num_valid*number_of_points;
+		}
+		return(compute_pmax_generic<num_t, rng_t>(posts, delta, number_of_points));
+	};
+
+	std::vector<unsigned int> valid;
+	valid.reserve(posts.size());
+	auto fam = multibeep::util::posteriors::family::other;
+	for (auto i=0u; i<posts.size(); ++i){
+		if (!posts[i]) continue;
+		if (valid.empty()) fam = posts[i]->get_family();
+		else if (posts[i]->get_family() != fam) fam = multibeep::util::posteriors::family::other;
+		valid.push_back(i);
+	}
+	if (valid.empty() || (fam == multibeep::util::posteriors::family::other))
+		return(generic(valid.size()));
+
+	std::vector<num_t> first, second;
+	first.reserve(valid.size());
+	second.reserve(valid.size());
+	for (auto i: valid){
+		auto p = posts[i]->family_parameters();
+		// degenerate parameters are left to the generic path and its NAN handling
+		if (!std::isfinite(p.first) || !std::isfinite(p.second) || !(p.second > 0))
+			return(generic(valid.size()));
+		first.push_back(p.first);
+		second.push_back(p.second);
+	}
+
+	std::vector<num_t> raw;
+	if (fam == multibeep::util::posteriors::family::gaussian)
+		raw = gaussian_pmax<num_t>(first, second, number_of_points, report);
+	else{
+		std::vector<std::pair<num_t, num_t> > intervals;
+		intervals.reserve(valid.size());
+		for (auto i: valid) intervals.push_back(posts[i]->support(delta));
+		raw = beta_pmax<num_t>(first, second, intervals, number_of_points, report);
+	}
+
+	// the same adjustment for unknown arms as in compute_pmax_for
+	num_t num_arms = posts.size();
+	std::vector<num_t> pmax_values(posts.size(), ((num_t) 1.) / num_arms);
+	for (auto k=0u; k<valid.size(); ++k)
+		pmax_values[valid[k]] = raw[k] * (((num_t) valid.size()) / num_arms);
+
+	normalize(pmax_values);
+
+	return(pmax_values);
+}
+
+
 
 }}}
 #endif
@@ -0,0 +1,223 @@
+#ifndef MULTIBEEP_UTIL_PMAX_FAMILIES
+#define MULTIBEEP_UTIL_PMAX_FAMILIES
+
+#include <vector>
+#include <cmath>
+#include <numeric>
+#include <algorithm>
+#include <limits>
+#include <cstdint>
+
+#include <boost/math/special_functions/beta.hpp>
+#include <gauss_legendre/gauss_legendre.h>
+
+/* Fast paths of p_max for bandits whose posteriors all belong to the same family.
+ *
+ * They compute the same integral as compute_pmax_for, but from the family's
+ * parameters instead of through the virtual posterior interface. Arms that
+ * cannot change the product at a node (cdf numerically 1) are skipped and a
+ * node is abandoned as soon as one factor is numerically 0. Both functions
+ * return the raw p_max of every arm, before the adjustment for arms without
+ * a posterior and before the normalization.
+ */
+
+namespace multibeep{ namespace util{ namespace pmax{
+
+
+/* \brief the way compute_pmax_all computed p_max and the work it actually did*/
+struct pmax_report{
+	enum class path {generic, gaussian_closed_form, gaussian, beta};
+	path taken = path::generic;
+	// integrals, quadrature nodes (integrand calls) and pdf/cdf evaluations
+	uint64_t num_integrals = 0;
+	uint64_t num_quadrature_nodes = 0;
+	uint64_t num_posterior_evaluations = 0;
+};
+
+
+template<typename num_t = double>
+num_t standard_normal_cdf(num_t x){
+	return(0.5*std::erfc(-x/std::sqrt(num_t(2))));
+}
+
+
+template<typename num_t = double>
+struct gaussian_integrand_data{
+	// means and standard deviations, sorted by decreasing mean
+	std::vector<num_t> means, sds;
+	// the arm whose pdf is integrated, in the sorted order
+	unsigned int index;
+	uint64_t num_nodes = 0, num_evaluations = 0;
+};
+
+
+template<typename num_t = double>
+num_t gaussian_integrand(num_t x, void* data){
+	auto &d = *static_cast<gaussian_integrand_data<num_t>*>(data);
+	const num_t inv_root_2pi = 0.3989422804014327;
+	num_t t = (x - d.means[d.index])/d.sds[d.index];
+	num_t res = inv_root_2pi/d.sds[d.index]*std::exp(-t*t/2);
+	d.num_nodes++;
+	d.num_evaluations++;
+	for (auto j=0u; (j < d.means.size()) && (res != 0); ++j){
+		if (j == d.index) continue;
+		t = (x - d.means[j])/d.sds[j];
+		// Phi(t) is 1 in double precision
+		if (t > 8.3) continue;
+		res *= standard_normal_cdf<num_t>(t);
+		d.num_evaluations++;
+	}
+	return(res);
+}
+
+
+/* \brief raw p_max of Gaussian posteriors given by their means and standard deviations
+ *
+ * Two arms have the closed form Phi((m_0-m_1)/sqrt(s_0^2+s_1^2)). Otherwise
+ * the pdf of arm i times the cdfs of the others is integrated by Gauss-Legendre
+ * quadrature over m_i +/- 6 s_i (the tails hold less than 1e-8), without the
+ * part where another cdf is numerically 0. An arm much narrower than arm i
+ * has a steep cdf that the nodes would miss, so the interval is split at its
+ * mean and at the ends of its own 6 s_j interval, with number_of_points nodes
+ * per piece. The work done is added to the optional report.
+ */
+template<typename num_t = double>
+std::vector<num_t> gaussian_pmax(const std::vector<num_t> &means, const std::vector<num_t> &sds, unsigned int number_of_points,
+	pmax_report * report = nullptr){
+	const unsigned int K = means.size();
+	std::vector<num_t> pmax_values(K, 1.);
+	if (report) report->taken = (K < 3) ? pmax_report::path::gaussian_closed_form : pmax_report::path::gaussian;
+	if (K < 2) return(pmax_values);
+
+	if (K == 2){
+		pmax_values[0] = standard_normal_cdf<num_t>((means[0]-means[1])/std::sqrt(sds[0]*sds[0] + sds[1]*sds[1]));
+		pmax_values[1] = 1 - pmax_values[0];
+		return(pmax_values);
+	}
+
+	// the arms with the highest means are the most likely to zero a node, try them first
+	std::vector<unsigned int> order(K);
+	std::iota(order.begin(), order.end(), 0);
+	std::sort(order.begin(), order.end(), [&means] (unsigned int a, unsigned int b) {return(means[a] > means[b]);});
+
+	gaussian_integrand_data<num_t> d;
+	for (auto i: order){
+		d.means.push_back(means[i]);
+		d.sds.push_back(sds[i]);
+	}
+
+	// below this, at least one cdf is numerically 0 and so is every integrand
+	num_t lowest = -std::numeric_limits<num_t>::infinity();
+	std::vector<num_t> zero_below(K, lowest);
+	for (auto j=0u; j < K; ++j){
+		num_t z = d.means[j] - 8.3*d.sds[j];
+		for (auto k=0u; k < K; ++k)
+			if (k != j) zero_below[k] = std::max(zero_below[k], z);
+	}
+
+	std::vector<num_t> points;
+	for (auto k=0u; k < K; ++k){
+		d.index = k;
+		num_t a = std::max(d.means[k] - 6*d.sds[k], zero_below[k]);
+		num_t b = d.means[k] + 6*d.sds[k];
+		num_t sum = 0;
+		if (a < b){
+			if (report) report->num_integrals++;
+			points.assign({a, b});
+			for (auto j=0u; j < K; ++j){
+				if ((j == k) || !(4*d.sds[j] < d.sds[k])) continue;
+				for (auto p: {d.means[j] - 6*d.sds[j], d.means[j], d.means[j] + 6*d.sds[j]})
+					if ((a < p) && (p < b)) points.push_back(p);
+			}
+			std::sort(points.begin(), points.end());
+			for (auto l=1u; l < points.size(); ++l)
+				sum += gauss_legendre(number_of_points, gaussian_integrand<num_t>, &d, points[l-1], points[l]);
+		}
+		pmax_values[order[k]] = sum;
+	}
+	if (report){
+		report->num_quadrature_nodes += d.num_nodes;
+		report->num_posterior_evaluations += d.num_evaluations;
+	}
+	return(pmax_values);
+}
+
+
+// double precision is enough for a product of cdfs, boost would compute in long double by default
+typedef boost::math::policies::policy<boost::math::policies::promote_double<false> > beta_policy;
+
+
+template<typename num_t = double>
+struct beta_integrand_data{
+	// alpha, beta and the interval outside of which the cdf is numerically 0 or 1, sorted by decreasing lower end
+	std::vector<num_t> alphas, betas, lower, upper;
+	// the arm whose pdf is integrated, in the sorted order
+	unsigned int index;
+	uint64_t num_nodes = 0, num_evaluations = 0;
+};
+
+
+template<typename num_t = double>
+num_t beta_integrand(num_t x, void* data){
+	auto &d = *static_cast<beta_integrand_data<num_t>*>(data);
+	num_t res = boost::math::ibeta_derivative(d.alphas[d.index], d.betas[d.index], x, beta_policy());
+	d.num_nodes++;
+	d.num_evaluations++;
+	for (auto j=0u; (j < d.alphas.size()) && (res != 0); ++j){
+		if ((j == d.index) || (x >= d.upper[j])) continue;
+		if (x <= d.lower[j]) return(0);
+		res *= boost::math::ibeta(d.alphas[j], d.betas[j], x, beta_policy());
+		d.num_evaluations++;
+	}
+	return(res);
+}
+
+
+/* \brief raw p_max of beta posteriors given by their parameters
+ *
+ * The same Gauss-Legendre quadrature over the given integration intervals
+ * as the generic path, but with the regularized incomplete beta function
+ * evaluated directly. Each cdf is only evaluated where it is neither
+ * numerically 0 nor 1, which is decided by two quantiles per arm. The work
+ * done is added to the optional report.
+ */
+template<typename num_t = double>
+std::vector<num_t> beta_pmax(const std::vector<num_t> &alphas, const std::vector<num_t> &betas,
+	const std::vector<std::pair<num_t, num_t> > &intervals, unsigned int number_of_points, pmax_report * report = nullptr){
+	const unsigned int K = alphas.size();
+	const num_t eps = 1e-15;
+
+	std::vector<unsigned int> order(K);
+	std::iota(order.begin(), order.end(), 0);
+
+	beta_integrand_data<num_t> d;
+	std::vector<num_t> lower(K), upper(K);
+	for (auto i=0u; i < K; ++i){
+		lower[i] = boost::math::ibeta_inv(alphas[i], betas[i], eps, beta_policy());
+		upper[i] = boost::math::ibeta_inv(alphas[i], betas[i], 1-eps, beta_policy());
+	}
+	std::sort(order.begin(), order.end(), [&lower] (unsigned int a, unsigned int b) {return(lower[a] > lower[b]);});
+	for (auto i: order){
+		d.alphas.push_back(alphas[i]);
+		d.betas.push_back(betas[i]);
+		d.lower.push_back(lower[i]);
+		d.upper.push_back(upper[i]);
+	}
+
+	std::vector<num_t> pmax_values(K);
+	for (auto k=0u; k < K; ++k){
+		d.index = k;
+		auto i = order[k];
+		pmax_values[i] = gauss_legendre(number_of_points, beta_integrand<num_t>, &d, intervals[i].first, intervals[i].second);
+	}
+	if (report){
+		report->taken = pmax_report::path::beta;
+		report->num_integrals += K;
+		report->num_quadrature_nodes += d.num_nodes;
+		report->num_posterior_evaluations += d.num_evaluations;
+	}
+	return(pmax_values);
+}
+
+}}}
+#endif
@@ -10,10 +10,21 @@
 namespace multibeep{ namespace util{ namespace posteriors{
 
 
+/*brief posterior families with a fast path for p_max, see multibeep::util::pmax::compute_pmax_all*/
+enum class family {other, gaussian, beta};
+
+
 /*brief unified interface for different posteriors*/
 template <typename num_t = double, typename rng_t = std::default_random_engine>
 class base{
 	public:
+		/* \brief the family of the posterior, other unless a subclass knows better*/
+		virtual family get_family() const {return(family::other);}
+		/* \brief the two parameters of the family: (mean, standard deviation) of a gaussian, (alpha, beta) of a beta posterior*/
+		virtual std::pair<num_t, num_t> family_parameters() const {
+			throw std::runtime_error("This posterior does not belong to a known family!");
+		}
+
 		/* \brief the mean of the posterior over the mean reward*/
 		virtual num_t mean() const = 0;
 		/* \brief the variance of the posterior over the mean reward*/
@@ -204,6 +215,11 @@ class gaussian_posterior: public simple_posterior< boost::math::normal_distribut
 		typedef simple_posterior< boost::math::normal_distribution<num_t>, num_t, rng_t> base_t;
 	public:
 		gaussian_posterior (num_t mean, num_t variance): base_t(mean, std::sqrt(variance)) {}
+
+		virtual family get_family() const {return(family::gaussian);}
+		virtual std::pair<num_t, num_t> family_parameters() const {
+			return(std::pair<num_t, num_t>(base_t::posterior_dist.mean(), base_t::posterior_dist.standard_deviation()));
+		}
 };
 
 
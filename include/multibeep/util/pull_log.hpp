@@ -0,0 +1,173 @@
+#ifndef MULTIBEEP_UTIL_PULL_LOG
+#define MULTIBEEP_UTIL_PULL_LOG
+
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <fstream>
+#include <algorithm>
+#include <stdexcept>
+
+namespace multibeep{ namespace util{
+
+	/* \brief layout of a pull log
+	 *
+	 * magic (8 bytes) and sizeof(num_t) (uint32) followed by any number of
+	 * blocks. A block starts with the number of records n (uint32), followed
+	 * by the columns: n pull indices (uint64), n identifiers (uint32), n rewards
+	 * (num_t) and n timestamps (int64, nanoseconds since the epoch). All values
+	 * are stored in native byte order. A log is only ever appended to, so an
+	 * interrupted run leaves all completely written blocks readable.
+	 */
+	static const char pull_log_magic[8] = {'M','B','L','O','G','0','0','1'};
+
+
+	/* \brief all records of a pull log, one vector per column*/
+	template <typename num_t = double>
+	struct pull_records{
+		std::vector<uint64_t> pull_index;
+		std::vector<unsigned int> identifier;
+		std::vector<num_t> reward;
+		std::vector<int64_t> timestamp;
+
+		size_t size() const {return(reward.size());}
+	};
+
+
+	/* \brief append-only binary log of all pulls of a bandit
+	 *
+	 * Records are collected in column buffers and only written when a buffer
+	 * is full, on flush or on destruction, so a pull costs a few stores and a
+	 * clock read.
+	 */
+	template <typename num_t = double>
+	class pull_log{
+		std::ofstream out;
+		unsigned int capacity;
+		pull_records<num_t> buffer;
+
+		template <typename T>
+		void write_column(const std::vector<T> &v){
+			out.write(reinterpret_cast<const char*>(v.data()), v.size()*sizeof(T));
+		}
+
+	  public:
+		/* \brief opens a log file
+		 *
+		 * \param filename		the file
+		 * \param buffer_size	number of records kept in memory before they are written
+		 * \param append		continue an existing log instead of truncating it
+		 */
+		pull_log(const std::string &filename, unsigned int buffer_size = 4096, bool append = false):
+			capacity(std::max(1u, buffer_size)){
+
+			if (append){
+				std::ifstream in(filename, std::ios::binary);
+				if (in){
+					char magic[8];
+					uint32_t size;
+					in.read(magic, sizeof(magic));
+					in.read(reinterpret_cast<char*>(&size), sizeof(size));
+					if ((!in) || (std::memcmp(magic, pull_log_magic, sizeof(magic)) != 0) || (size != sizeof(num_t)))
+						throw std::runtime_error(filename + " is not a compatible pull log");
+				}
+				else append = false;
+			}
+
+			out.open(filename, std::ios::binary | (append ? std::ios::app : std::ios::trunc));
+			if (!out)
+				throw std::runtime_error("Could not open " + filename);
+			if (!append){
+				uint32_t size = sizeof(num_t);
+				out.write(pull_log_magic, sizeof(pull_log_magic));
+				out.write(reinterpret_cast<const char*>(&size), sizeof(size));
+			}
+
+			buffer.pull_index.reserve(capacity);
+			buffer.identifier.reserve(capacity);
+			buffer.reward.reserve(capacity);
+			buffer.timestamp.reserve(capacity);
+		}
+
+		pull_log(const pull_log &) = delete;
+		pull_log & operator=(const pull_log &) = delete;
+
+		void record(uint64_t pull_index, unsigned int identifier, num_t reward){
+			buffer.pull_index.push_back(pull_index);
+			buffer.identifier.push_back(identifier);
+			buffer.reward.push_back(reward);
+			buffer.timestamp.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(
+				std::chrono::system_clock::now().time_since_epoch()).count());
+			if (buffer.size() >= capacity) flush();
+		}
+
+		/* \brief writes all buffered records as one block*/
+		void flush(){
+			if (buffer.size() > 0){
+				uint32_t n = buffer.size();
+				out.write(reinterpret_cast<const char*>(&n), sizeof(n));
+				write_column(buffer.pull_index);
+				write_column(buffer.identifier);
+				write_column(buffer.reward);
+				write_column(buffer.timestamp);
+				buffer.pull_index.clear();
+				buffer.identifier.clear();
+				buffer.reward.clear();
+				buffer.timestamp.clear();
+			}
+			out.flush();
+			if (!out)
+				throw std::runtime_error("Could not write the pull log");
+		}
+
+		~pull_log(){
+			try{ flush();}
+			catch (...) {}
+		}
+	};
+
+
+	/* \brief reads all complete blocks of a pull log*/
+	template <typename num_t = double>
+	pull_records<num_t> read_pull_log(const std::string &filename){
+		std::ifstream in(filename, std::ios::binary);
+		if (!in)
+			throw std::runtime_error("Could not open " + filename);
+
+		char magic[8];
+		uint32_t size;
+		in.read(magic, sizeof(magic));
+		in.read(reinterpret_cast<char*>(&size), sizeof(size));
+		if ((!in) || (std::memcmp(magic, pull_log_magic, sizeof(magic)) != 0))
+			throw std::runtime_error(filename + " is not a pull log");
+		if (size != sizeof(num_t))
+			throw std::runtime_error(filename + " contains rewards of a different type");
+
+		pull_records<num_t> records;
+		uint32_t n;
+		while (in.read(reinterpret_cast<char*>(&n), sizeof(n))){
+			auto offset = records.size();
+			records.pull_index.resize(offset + n);
+			records.identifier.resize(offset + n);
+			records.reward.resize(offset + n);
+			records.timestamp.resize(offset + n);
+			in.read(reinterpret_cast<char*>(records.pull_index.data() + offset), n*sizeof(uint64_t));
+			in.read(reinterpret_cast<char*>(records.identifier.data() + offset), n*sizeof(unsigned int));
+			in.read(reinterpret_cast<char*>(records.reward.data() + offset), n*sizeof(num_t));
+			in.read(reinterpret_cast<char*>(records.timestamp.data() + offset), n*sizeof(int64_t));
+			if (!in){
+				// a block that was not completely written
+				records.pull_index.resize(offset);
+				records.identifier.resize(offset);
+				records.reward.resize(offset);
+				records.timestamp.resize(offset);
+				break;
+			}
+		}
+		return(records);
+	}
+
+}}
+#endif
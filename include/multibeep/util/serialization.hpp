@@ -0,0 +1,153 @@
+#ifndef MULTIBEEP_UTIL_SERIALIZATION
+#define MULTIBEEP_UTIL_SERIALIZATION
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <sstream>
+#include <stdexcept>
+#include <type_traits>
+
+namespace multibeep{ namespace util{ namespace serialization{
+
+	/* \brief layout of a snapshot
+	 *
+	 * magic (8 bytes), format version, sizeof(num_t) and the kind of object
+	 * (uint32 each), followed by the state written by the object's save method.
+	 * All values are stored in native byte order; vectors are stored as their
+	 * length followed by the raw elements, so they can be restored with a
+	 * single copy, e.g. from a memory mapped file.
+	 */
+	static const char magic[8] = {'M','B','S','N','A','P','\0','\0'};
+	static const uint32_t version = 1;
+
+	enum kind: uint32_t {bandit_snapshot = 1, policy_snapshot = 2};
+
+
+	/* \brief appends the binary representation of values to a buffer */
+	class writer{
+		std::string buffer;
+	  public:
+
+		template <typename T>
+		void write(const T &v){
+			static_assert(std::is_trivially_copyable<T>::value, "only trivially copyable types can be written directly");
+			buffer.append(reinterpret_cast<const char*>(&v), sizeof(T));
+		}
+
+		template <typename T>
+		void write_vector(const std::vector<T> &v){
+			static_assert(std::is_trivially_copyable<T>::value, "only vectors of trivially copyable types can be written directly");
+			write<uint64_t>(v.size());
+			buffer.append(reinterpret_cast<const char*>(v.data()), v.size()*sizeof(T));
+		}
+
+		void write_vector(const std::vector<bool> &v){
+			write<uint64_t>(v.size());
+			for (bool b: v) write<uint8_t>(b);
+		}
+
+		void write_string(const std::string &s){
+			write<uint64_t>(s.size());
+			buffer.append(s);
+		}
+
+		/* \brief state of a standard random number engine, in its textual representation*/
+		template <typename rng_t>
+		void write_rng(const rng_t &rng){
+			std::ostringstream os;
+			os << rng;
+			write_string(os.str());
+		}
+
+		template <typename num_t>
+		void write_header(kind k){
+			buffer.append(magic, sizeof(magic));
+			write<uint32_t>(version);
+			write<uint32_t>(sizeof(num_t));
+			write<uint32_t>(k);
+		}
+
+		const std::string & data() const {return(buffer);}
+	};
+
+
+	/* \brief reads values from a memory region without owning it
+	 *
+	 * Throws std::runtime_error if the data ends prematurely.
+	 */
+	class reader{
+		const char * pos;
+		const char * end;
+
+		void require(size_t n){
+			if ((size_t) (end - pos) < n)
+				throw std::runtime_error("Snapshot is truncated");
+		}
+
+	  public:
+		reader(const char * data, size_t size): pos(data), end(data+size) {}
+		reader(const std::string &s): reader(s.data(), s.size()) {}
+
+		template <typename T>
+		T read(){
+			static_assert(std::is_trivially_copyable<T>::value, "only trivially copyable types can be read directly");
+			require(sizeof(T));
+			T v;
+			std::memcpy(&v, pos, sizeof(T));
+			pos += sizeof(T);
+			return(v);
+		}
+
+		template <typename T>
+		void read_vector(std::vector<T> &v){
+			auto n = read<uint64_t>();
+			require(n*sizeof(T));
+			v.resize(n);
+			std::memcpy(v.data(), pos, n*sizeof(T));
+			pos += n*sizeof(T);
+		}
+
+		void read_vector(std::vector<bool> &v){
+			auto n = read<uint64_t>();
+			require(n);
+			v.resize(n);
+			for (auto i=0u; i < n; ++i) v[i] = read<uint8_t>();
+		}
+
+		std::string read_string(){
+			auto n = read<uint64_t>();
+			require(n);
+			std::string s(pos, n);
+			pos += n;
+			return(s);
+		}
+
+		template <typename rng_t>
+		void read_rng(rng_t &rng){
+			std::istringstream is(read_string());
+			is >> rng;
+			if (!is)
+				throw std::runtime_error("Snapshot contains an invalid random number generator state");
+		}
+
+		template <typename num_t>
+		void read_header(kind k){
+			require(sizeof(magic));
+			if (std::memcmp(pos, magic, sizeof(magic)) != 0)
+				throw std::runtime_error("Data is not a multibeep snapshot");
+			pos += sizeof(magic);
+			if (read<uint32_t>() != version)
+				throw std::runtime_error("Unsupported snapshot version");
+			if (read<uint32_t>() != sizeof(num_t))
+				throw std::runtime_error("Snapshot was taken with a different number type");
+			if (read<uint32_t>() != k)
+				throw std::runtime_error("Snapshot belongs to a different kind of object");
+		}
+
+		bool at_end() const {return(pos == end);}
+	};
+
+}}}
+#endif
@@ -1,6 +1,8 @@
 #ifndef MULTIBEEP_UTIL_STATISTICS
 #define MULTIBEEP_UTIL_STATISTICS
 
+#include <cstdint>
+
 
 namespace multibeep{ namespace util{ namespace statistics{
 
@@ -25,6 +27,21 @@ class running_statistics{
 	long unsigned int number_of_points() const {return(N);}
 	num_type mean() const { return( (N>0)?m:NAN);}
 	num_type variance() const {return((N>1)?std::max<double>(0.,v/(N-1)) : NAN);}
+
+	/* \brief writes the internal state, see multibeep::util::serialization*/
+	template <typename writer_t>
+	void save(writer_t &w) const {
+		w.template write<uint64_t>(N);
+		w.write(m);
+		w.write(v);
+	}
+
+	template <typename reader_t>
+	void load(reader_t &r){
+		N = r.template read<uint64_t>();
+		m = r.template read<num_type>();
+		v = r.template read<num_type>();
+	}
 };
 
 
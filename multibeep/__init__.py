@@ -2,3 +2,4 @@ import multibeep.util
 import multibeep.arms
 import multibeep.bandits
 import multibeep.policies
+import multibeep.recommenders
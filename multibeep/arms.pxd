@@ -10,6 +10,8 @@ cdef class base:
 	cdef shared_ptr[ arms_cpp.base[float_t, rand_t]] thisptr
 	# hack to make shared pointers work: instantiate a temporary pointer first
 	cdef arms_cpp.base[float_t, rand_t] * tmpptr
+	# constructor arguments for pickling, None if the arm cannot be pickled
+	cdef object init_args
 
 	cdef shared_ptr[arms_cpp.base[float_t, rand_t] ] get_arm_ptr (self)
 
@@ -1,4 +1,5 @@
 from cython.operator cimport dereference as deref
+from libcpp.string cimport string
 
 import numpy as np
 cimport numpy as np
@@ -10,7 +11,7 @@ cimport arms
 
 
 from typedefs cimport *
-from util cimport rng_class, posterior_class
+from util cimport rng_class, posterior_class, data_matrix
 
 
 cdef class base:
@@ -25,6 +26,24 @@ cdef class base:
 		"""
 		return(self.thisptr.get().pull())
 
+	def pull_batch(self, unsigned int n):
+		""" pulls the arm n times
+		
+		Parameters
+		----------
+		n : unsigned int
+			number of pulls
+		
+		Returns
+		-------
+		numpy.ndarray
+			the n rewards
+		"""
+		cdef np.ndarray[float_t, ndim=1] rewards = np.empty(n, dtype=np.double)
+		if n > 0:
+			self.thisptr.get().pull_batch(n, &rewards[0])
+		return(rewards)
+
 	def real_mean(self):
 		""" the mean of the underlying distribution
 		
@@ -77,6 +96,29 @@ cdef class base:
 		p.thisptr = deref(self.thisptr.get()).posterior()
 		return(p)
 		
+	def get_state(self):
+		""" the internal state of the arm (e.g. the position in the data), not its parameters"""
+		cdef util_cpp.writer w
+		self.thisptr.get().save(w)
+		cdef bytes state = w.data()
+		return(state)
+
+	def set_state(self, const unsigned char[::1] state):
+		""" restores the state returned by get_state of an arm with the same parameters"""
+		cdef util_cpp.reader * r = new util_cpp.reader(<const char*> &state[0] if state.shape[0] > 0 else NULL, state.shape[0])
+		try:
+			self.thisptr.get().load(deref(r))
+		finally:
+			del r
+
+	def __reduce__(self):
+		if self.init_args is None:
+			raise TypeError("%s arms cannot be pickled"%type(self).__name__)
+		return(type(self), self.init_args, self.get_state())
+
+	def __setstate__(self, state):
+		self.set_state(state)
+
 	cdef shared_ptr[arms_cpp.base[float_t, rand_t] ] get_arm_ptr (self):
 		return(self.thisptr)
 
@@ -95,6 +137,7 @@ cdef class bernoulli(base):
 		a random number generator object
 	"""
 	def __init__(self, float_t p, rng_class rng):
+		self.init_args = (p, rng)
 		self.tmpptr = new arms_cpp.bernoulli_arm[float_t, rand_t] (p, rng.get_shared_ptr())
 		self.thisptr = shared_ptr[ arms_cpp.base[float_t, rand_t] ] (self.tmpptr)
 		self.tmpptr = NULL
@@ -112,6 +155,7 @@ cdef class exponential(base):
 		a random number generator object
 	"""
 	def __init__(self, float_t l, rng_class rng):
+		self.init_args = (l, rng)
 		self.tmpptr = new arms_cpp.exponential_arm[float_t, rand_t] (l, rng.get_shared_ptr())
 		self.thisptr = shared_ptr[ arms_cpp.base[float_t, rand_t] ] (self.tmpptr)
 		self.tmpptr = NULL
@@ -132,6 +176,7 @@ cdef class normal(base):
 
 	"""
 	def __init__(self, float_t mean, float_t variance, rng_class rng):
+		self.init_args = (mean, variance, rng)
 		self.tmpptr = new arms_cpp.normal_arm[float_t, rand_t] (mean, variance, rng.get_shared_ptr())
 		self.thisptr = shared_ptr[ arms_cpp.base[float_t, rand_t] ] (self.tmpptr)
 		self.tmpptr = NULL
@@ -140,9 +185,10 @@ cdef class data(base):
 	"""		
 	Parameters
 	----------
-	data : numpy.ndarray (1d)
-		The data for this arme. The data is copied at least once, but if the data is not in
-		C order, a second temporary copy is made.
+	data : numpy.ndarray (1d) or multibeep.util.data_matrix
+		The data for this arm. A Fortran ordered array of doubles is used without
+		copying it, other arrays are copied once. For a data_matrix, the arm
+		views the given column.
 	
 	name : string
 		the name associated with this arm
@@ -157,14 +203,19 @@ cdef class data(base):
 		If true, an entry is chosen uniformly at random (with replacement)
 		
 		Default is False.
+	
+	column : unsigned int
+		the column of the data_matrix. Default is 0.
 		
 	"""
-	def __init__(self, np.ndarray[float_t, ndim=1] data, name, rng_class rng, bootstrap=False):
-		data = np.ascontiguousarray(data)
+	def __init__(self, data, name, rng_class rng, bootstrap=False, unsigned int column = 0):
+		cdef data_matrix m = data if isinstance(data, data_matrix) else data_matrix(data, 1)
+		cdef string n = name
+		self.init_args = (m, name, rng, bootstrap, column)
 		if bootstrap:
-			self.tmpptr = new arms_cpp.data_arm_bootstrap[float_t, rand_t] (&data[0], data.shape[0], name, rng.get_shared_ptr())
+			self.tmpptr = new arms_cpp.data_arm_bootstrap[float_t, rand_t] (m.thisptr, column, n, rng.get_shared_ptr())
 		else:
-			self.tmpptr = new arms_cpp.data_arm_sequential[float_t, rand_t] (&data[0], data.shape[0], name, rng.get_shared_ptr())
+			self.tmpptr = new arms_cpp.data_arm_sequential[float_t, rand_t] (m.thisptr, column, n, rng.get_shared_ptr())
 		self.thisptr = shared_ptr[ arms_cpp.base[float_t, rand_t] ] (self.tmpptr)
 		self.tmpptr = NULL
 
@@ -172,34 +223,60 @@ cdef class data(base):
 
 
 # moderator functions between C++ and python
+# they are called from C++ code that might not hold the GIL, so they reacquire it
 
-cdef float_t pull_wrapper(void *obj):
+cdef float_t pull_wrapper(void *obj) with gil:
 	# recover python object from the C++ pointer to the python pull function
 	o = <object> obj
 	# call it and cast the result to be a float_t
 	return (<float_t> o.pull())
 
-cdef float_t mean_wrapper(void *obj):
+cdef float_t mean_wrapper(void *obj) with gil:
 	o = <object> obj
 	return (<float_t> o.real_mean())
 
-cdef float_t var_wrapper(void *obj):
+cdef float_t var_wrapper(void *obj) with gil:
 	o = <object> obj
 	return (<float_t> o.real_variance())
 
-cdef shared_ptr[util_cpp.base[float_t, rand_t] ] posterior_wrapper (void *obj):
+cdef shared_ptr[util_cpp.base[float_t, rand_t] ] posterior_wrapper (void *obj) with gil:
 	o = <object> obj
 	p = <posterior_class> o.posterior()
 	return (p.get_shared_ptr())
 
-cdef void deactivate_wrapper(void *obj):
+cdef void deactivate_wrapper(void *obj) with gil:
 	o = <object> obj
 	o.deactivate()
 
+# returns 0 with the exception still set, python_arm::pull_batch then throws
+cdef int pull_batch_wrapper(void *obj, unsigned int n, float_t *rewards) except 0 with gil:
+	o = <object> obj
+	cdef np.ndarray[float_t, ndim=1] r = np.ascontiguousarray(o.pull_batch(n), dtype=np.double).ravel()
+	cdef unsigned int i
+	for i in range(min(n, r.shape[0])):
+		rewards[i] = r[i]
+	# the remaining rewards, if any, are obtained one by one
+	for i in range(r.shape[0], n):
+		rewards[i] = <float_t> o.pull()
+	return(1)
+
 
 cdef class python(base):
+	""" An arm calling back into Python for its rewards.
+	
+	obj has to provide pull, real_mean, real_variance, posterior and deactivate
+	methods, usually obj is the instance of a subclass itself. If obj also
+	provides pull_batch(n) returning an array of n rewards, batched pulls
+	(e.g. by min_pull_arms) need only one call into Python.
+	If fewer rewards are returned, the remaining ones are obtained via pull.
+	"""
 	def __init__(self, obj, name="custom python arm"):
-		self.tmpptr = new arms_cpp.python_arm[float_t,rand_t](name, <void*> obj, &pull_wrapper, &mean_wrapper, &var_wrapper, &posterior_wrapper, &deactivate_wrapper)
+		cdef arms_cpp.python_pull_batch batch_wrapper = NULL
+		batch = getattr(type(obj), 'pull_batch', None)
+		# base.pull_batch would just call back into C++
+		if (batch is not None) and (batch is not base.pull_batch):
+			batch_wrapper = &pull_batch_wrapper
+		self.tmpptr = new arms_cpp.python_arm[float_t,rand_t](name, <void*> obj, &pull_wrapper, &mean_wrapper, &var_wrapper, &posterior_wrapper, &deactivate_wrapper, batch_wrapper)
 		self.thisptr = shared_ptr[ arms_cpp.base[float_t, rand_t] ] (self.tmpptr)
 		self.tmpptr = NULL	
 	def pull(self):
@@ -212,3 +289,33 @@ cdef class python(base):
 		raise ("This arm does not provide a posterior. So you either use a bandit that provides one or provide a posterior for the arm.")
 	def deactivate(self):
 		pass
+
+
+class executor(python):
+	""" A python arm evaluated asynchronously by a concurrent.futures.Executor.
+	
+	submit() schedules fn(*args) on the executor and returns the future, pull()
+	waits for its result. Policies played with play_n_rounds(n, max_pending)
+	keep up to max_pending of these evaluations running at the same time.
+	
+	Parameters
+	----------
+	executor : concurrent.futures.Executor
+		runs the evaluations, e.g. a ProcessPoolExecutor
+	fn : callable
+		called with args for every pull, returns the reward. It has to be
+		picklable if the executor uses other processes.
+	args :
+		arguments passed to fn
+	name : bytes
+		the name associated with this arm
+	"""
+	def __init__(self, executor, fn, *args, name=b"executor arm"):
+		python.__init__(self, self, name)
+		self.executor = executor
+		self.fn = fn
+		self.args = args
+	def submit(self):
+		return(self.executor.submit(self.fn, *self.args))
+	def pull(self):
+		return(self.submit().result())
@@ -2,7 +2,7 @@ import cython
 
 from libcpp cimport bool
 #from libcpp.pair cimport pair
-#from libcpp.vector cimport vector
+from libcpp.vector cimport vector
 from libcpp.string cimport string
 from libcpp.memory cimport shared_ptr
 
@@ -20,13 +20,16 @@ cimport util_cpp
 
 cdef extern from "multibeep/arm/arm.hpp" namespace "multibeep::arms":
 	cdef cppclass base[num_t, rng_t]:
-		num_t pull()
+		num_t pull() nogil
+		void pull_batch(unsigned int, num_t *) except +
 		num_t real_mean()
 		num_t real_variance()
 		string get_ident()
 		bool provides_posterior()
 		shared_ptr[util_cpp.base[num_t, rng_t] ] posterior()
 		void deactivate()
+		void save(util_cpp.writer &)
+		void load(util_cpp.reader &) except +
 
 
 cdef extern from "multibeep/arm/bernoulli.hpp" namespace "multibeep::arms":
@@ -44,16 +47,22 @@ cdef extern from "multibeep/arm/normal.hpp" namespace "multibeep::arms":
 
 cdef extern from "multibeep/arm/data.hpp" namespace "multibeep::arms":
 	cdef cppclass data_arm_bootstrap[num_t, rng_t](base[ num_t, rng_t]):
-		data_arm_bootstrap (num_t *, unsigned int, string, shared_ptr[rng_t])
+		data_arm_bootstrap (num_t *, unsigned int, string, shared_ptr[rng_t]) except +
+		data_arm_bootstrap (shared_ptr[util_cpp.data_matrix[num_t]], unsigned int, string, shared_ptr[rng_t]) except +
 	
 	cdef cppclass data_arm_sequential[num_t, rng_t](base[num_t, rng_t]):
-		data_arm_sequential(num_t *, unsigned int, string, shared_ptr[rng_t])
+		data_arm_sequential(num_t *, unsigned int, string, shared_ptr[rng_t]) except +
+		data_arm_sequential(shared_ptr[util_cpp.data_matrix[num_t]], unsigned int, string, shared_ptr[rng_t]) except +
 
 
+cdef extern from "multibeep/arm/replay.hpp" namespace "multibeep::arms":
+	vector[shared_ptr[base[num_t, rng_t]]] replay_arms_from_log[num_t, rng_t](const util_cpp.pull_records[num_t] &)
+
 ctypedef float_t (*python_pull)(void*)
 ctypedef void (*python_deactivate)(void*)
+ctypedef int (*python_pull_batch)(void*, unsigned int, float_t*) except 0
 ctypedef shared_ptr[util_cpp.base[float_t, rand_t] ] (*python_posterior)(void*)
 
 cdef extern from "multibeep/arm/python_arm.hpp" namespace "multibeep::arms":
 	cdef cppclass python_arm[num_t, rng_t] (base[num_t, rng_t]):
-		python_arm(string, void*, python_pull, python_pull, python_pull, python_posterior, python_deactivate)
+		python_arm(string, void*, python_pull, python_pull, python_pull, python_posterior, python_deactivate, python_pull_batch)
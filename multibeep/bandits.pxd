@@ -6,6 +6,8 @@ from libcpp.memory cimport shared_ptr
 
 
 cimport bandits_cpp
+cimport arms_cpp
+cimport util_cpp
 
 
 from typedefs cimport *
@@ -29,6 +31,12 @@ cdef class arm_info:
 	cdef public vector[float_t] rewards
 
 	cdef public float_t p_max
+	cdef public unsigned long p_max_version
+	cdef public unsigned int p_max_staleness
+
+	cdef public unsigned long num_timed_pulls
+	cdef public double mean_pull_seconds
+	cdef public unsigned long median_pull_ns
 
 	cdef public posterior_class posterior
 
@@ -40,6 +48,25 @@ cdef class base:
 	cdef shared_ptr[bandits_cpp.base[float_t, rand_t] ] thisptr
 	# temporary pointer, as a workaround for struggeling to write __init__ with a shared_ptr
 	cdef  bandits_cpp.base[float_t, rand_t] * tmpptr
+	# threading.RLock taken by every python entry point that accesses the bandit
+	cdef readonly object lock
+	# identifier -> python arm, keeps the python objects alive and allows asynchronous pulls
+	cdef dict python_arms
+	# constructor arguments and all add_* calls, replayed when unpickling
+	cdef object init_args
+	cdef list additions
+
+	cdef add_arm_vector(self, const vector[shared_ptr[arms_cpp.base[float_t, rand_t]]] & arm_ptrs)
+	# python arms need the GIL for every pull, so it is only released if there are none
+	cdef bint has_python_arms(self)
+
+
+cdef class pmax_scheduler:
+	cdef shared_ptr[bandits_cpp.pmax_scheduler[float_t, rand_t]] thisptr
+
+
+cdef class background_pmax:
+	cdef shared_ptr[util_cpp.background_worker[float_t, rand_t]] thisptr
 
 
 cdef class empirical(base):
@@ -1,17 +1,29 @@
 import cython
 from cython.operator cimport dereference as deref
 from libcpp cimport bool
+from libcpp.vector cimport vector
+from libcpp.string cimport string
+from libcpp.memory cimport shared_ptr
+from libc.string cimport memcpy
 
+import threading
+
+import numpy as np
+cimport numpy as np
 
 cimport bandits_cpp
 cimport bandits
+cimport arms_cpp
 
 
 from typedefs cimport *
 
 cimport arms
 from util import posterior_class
+from util cimport rng_class, data_matrix, pull_log, event_ring
+cimport util_cpp
 
+np.import_array()
 
 
 cdef class arm_info:
@@ -25,6 +37,11 @@ cdef class arm_info:
 		self.real_mean = deref(tmpptr.get_arm_ptr()).real_mean()
 		self.real_variance = deref(tmpptr.get_arm_ptr()).real_variance()
 		self.p_max = tmpptr.p_max
+		self.p_max_version = tmpptr.p_max_version
+		self.p_max_staleness = tmpptr.p_max_staleness
+		self.num_timed_pulls = tmpptr.pull_latency.count()
+		self.mean_pull_seconds = tmpptr.pull_latency.mean_seconds()
+		self.median_pull_ns = tmpptr.pull_latency.quantile_ns(0.5)
 		self.posterior = posterior_class()
 		self.posterior.thisptr = deref(tmpptr).posterior
 		self.rewards = (tmpptr.rewards)[:]
@@ -37,8 +54,23 @@ cdef class base:
 	It contains the functionality common to all subclasses. To access the 
 	arm_info objects of the contained arms, use the index operator '[]'
 	
+	A bandit can be shared by several Python threads: every method holds the
+	reentrant lock of the bandit (the attribute lock, a threading.RLock) while
+	it accesses the bandit, and waiting for it releases the GIL. The policies,
+	recommenders and pmax schedulers of a bandit take the same lock, so hold
+	it yourself to combine several calls into one atomic step.
+	min_pull_arms, sort_active_arms_by_mean and update_p_max release the GIL
+	while they hold the lock, unless a multibeep.arms.python arm is part of
+	the bandit.
+	
 	
 	"""
+	def __cinit__(self):
+		self.python_arms = {}
+		self.lock = threading.RLock()
+		self.init_args = ()
+		self.additions = []
+
 	def add_arm(self, arms.base arm):
 		""" adds an arm to the bandit
 		
@@ -52,7 +84,266 @@ cdef class base:
 		unsigned int
 			the unique identifier associated with the arm just added
 		"""
-		return(self.thisptr.get().add_arm(arm.get_arm_ptr()))
+		with self.lock:
+			ident = self.thisptr.get().add_arm(arm.get_arm_ptr())
+			if isinstance(arm, arms.python):
+				self.python_arms[ident] = arm
+			self.additions.append(('add_arm', (arm,)))
+		return(ident)
+
+	cdef add_arm_vector(self, const vector[shared_ptr[arms_cpp.base[float_t, rand_t]]] & arm_ptrs):
+		# the caller holds the lock
+		cdef unsigned int first = self.thisptr.get().add_arms(arm_ptrs)
+		return(np.arange(first, first + arm_ptrs.size(), dtype=np.uint32))
+
+	cdef bint has_python_arms(self):
+		# counted by the C++ bandit, as arms can also be added from C++, e.g. by Hyperband
+		return(self.thisptr.get().number_of_python_arms() > 0)
+
+	def add_normal_arms(self, means, variances, rng_class rng):
+		""" creates and adds many normal arms in one go
+		
+		Parameters
+		----------
+		means : 1-D array_like
+			the means of the arms
+		variances : 1-D array_like
+			the variances of the arms, same length as means
+		rng : multibeep.util.rng_class
+			a valid random number generator shared by all arms
+		
+		Returns
+		-------
+		numpy.ndarray
+			the identifiers of the new arms
+		"""
+		cdef np.ndarray[float_t, ndim=1] m = np.ascontiguousarray(means, dtype=np.double)
+		cdef np.ndarray[float_t, ndim=1] v = np.ascontiguousarray(variances, dtype=np.double)
+		if m.shape[0] != v.shape[0]:
+			raise ValueError("means and variances must have the same length")
+		cdef vector[shared_ptr[arms_cpp.base[float_t, rand_t]]] arm_ptrs
+		cdef unsigned int i
+		arm_ptrs.reserve(m.shape[0])
+		for i in range(m.shape[0]):
+			arm_ptrs.push_back(shared_ptr[arms_cpp.base[float_t, rand_t]](<arms_cpp.base[float_t, rand_t]*> new arms_cpp.normal_arm[float_t, rand_t](m[i], v[i], rng.thisptr)))
+		with self.lock:
+			self.additions.append(('add_normal_arms', (m.copy(), v.copy(), rng)))
+			return(self.add_arm_vector(arm_ptrs))
+
+	def add_bernoulli_arms(self, ps, rng_class rng):
+		""" creates and adds many bernoulli arms in one go
+		
+		Parameters
+		----------
+		ps : 1-D array_like
+			the success probabilities of the arms
+		rng : multibeep.util.rng_class
+			a valid random number generator shared by all arms
+		
+		Returns
+		-------
+		numpy.ndarray
+			the identifiers of the new arms
+		"""
+		cdef np.ndarray[float_t, ndim=1] p = np.ascontiguousarray(ps, dtype=np.double)
+		cdef vector[shared_ptr[arms_cpp.base[float_t, rand_t]]] arm_ptrs
+		cdef unsigned int i
+		arm_ptrs.reserve(p.shape[0])
+		for i in range(p.shape[0]):
+			arm_ptrs.push_back(shared_ptr[arms_cpp.base[float_t, rand_t]](<arms_cpp.base[float_t, rand_t]*> new arms_cpp.bernoulli_arm[float_t, rand_t](p[i], rng.thisptr)))
+		with self.lock:
+			self.additions.append(('add_bernoulli_arms', (p.copy(), rng)))
+			return(self.add_arm_vector(arm_ptrs))
+
+	def add_exponential_arms(self, lambdas, rng_class rng):
+		""" creates and adds many exponential arms in one go
+		
+		Parameters
+		----------
+		lambdas : 1-D array_like
+			the rate parameters of the arms
+		rng : multibeep.util.rng_class
+			a valid random number generator shared by all arms
+		
+		Returns
+		-------
+		numpy.ndarray
+			the identifiers of the new arms
+		"""
+		cdef np.ndarray[float_t, ndim=1] l = np.ascontiguousarray(lambdas, dtype=np.double)
+		cdef vector[shared_ptr[arms_cpp.base[float_t, rand_t]]] arm_ptrs
+		cdef unsigned int i
+		arm_ptrs.reserve(l.shape[0])
+		for i in range(l.shape[0]):
+			arm_ptrs.push_back(shared_ptr[arms_cpp.base[float_t, rand_t]](<arms_cpp.base[float_t, rand_t]*> new arms_cpp.exponential_arm[float_t, rand_t](l[i], rng.thisptr)))
+		with self.lock:
+			self.additions.append(('add_exponential_arms', (l.copy(), rng)))
+			return(self.add_arm_vector(arm_ptrs))
+
+	def add_data_arms(self, data, rng_class rng, names = None, bootstrap = False):
+		""" creates and adds one data arm per column of a 2-D array
+		
+		All arms view the columns of one shared matrix, the values are not copied per arm.
+		
+		Parameters
+		----------
+		data : 2-D array_like or multibeep.util.data_matrix
+			every column contains the values of one arm. Arrays are wrapped in
+			a data_matrix, see there for when a copy is made.
+		rng : multibeep.util.rng_class
+			a valid random number generator shared by all arms
+		names : list of bytes
+			one name per column. Default are the names of the data_matrix,
+			i.e. the header of the file it was loaded from or the column index.
+		bootstrap : bool
+			If true, values are drawn uniformly at random (with replacement),
+			otherwise they are returned in order. See multibeep.arms.data.
+		
+		Returns
+		-------
+		numpy.ndarray
+			the identifiers of the new arms
+		"""
+		cdef data_matrix m = data if isinstance(data, data_matrix) else data_matrix(data)
+		cdef unsigned int num_columns = m.thisptr.get().number_of_columns(), i
+		if names is None:
+			names = m.names
+		if len(names) != num_columns:
+			raise ValueError("there has to be one name per column")
+		cdef vector[shared_ptr[arms_cpp.base[float_t, rand_t]]] arm_ptrs
+		cdef string name
+		arm_ptrs.reserve(num_columns)
+		for i in range(num_columns):
+			name = names[i]
+			if bootstrap:
+				arm_ptrs.push_back(shared_ptr[arms_cpp.base[float_t, rand_t]](<arms_cpp.base[float_t, rand_t]*> new arms_cpp.data_arm_bootstrap[float_t, rand_t](m.thisptr, i, name, rng.thisptr)))
+			else:
+				arm_ptrs.push_back(shared_ptr[arms_cpp.base[float_t, rand_t]](<arms_cpp.base[float_t, rand_t]*> new arms_cpp.data_arm_sequential[float_t, rand_t](m.thisptr, i, name, rng.thisptr)))
+		with self.lock:
+			self.additions.append(('add_data_arms', (m, rng, list(names), bootstrap)))
+			return(self.add_arm_vector(arm_ptrs))
+
+	def add_replay_arms(self, filename):
+		""" adds one arm per arm of a recorded run, returning the recorded rewards in order
+		
+		The arms get the identifiers they had in the recorded run, so the bandit
+		has to be empty. Policies can then be played on the recorded rewards
+		without evaluating any arm again, see multibeep.policies.base.replay_n_rounds.
+		
+		Parameters
+		----------
+		filename : bytes
+			a log written by a multibeep.util.pull_log
+		
+		Returns
+		-------
+		numpy.ndarray
+			the identifiers of the new arms
+		"""
+		cdef vector[shared_ptr[arms_cpp.base[float_t, rand_t]]] arm_ptrs = arms_cpp.replay_arms_from_log[float_t, rand_t](util_cpp.read_pull_log[float_t](filename))
+		with self.lock:
+			if self.thisptr.get().number_of_arms() > 0:
+				raise ValueError("replay arms have to be added to an empty bandit")
+			self.additions.append(('add_replay_arms', (filename,)))
+			return(self.add_arm_vector(arm_ptrs))
+
+	def set_pull_log(self, pull_log log):
+		""" records every following pull in the given log
+		
+		Parameters
+		----------
+		log : multibeep.util.pull_log or None
+			the log, can be shared by several bandits. None stops the recording.
+		"""
+		with self.lock:
+			if log is None:
+				self.thisptr.get().set_pull_log(shared_ptr[util_cpp.pull_log[float_t]]())
+			else:
+				self.thisptr.get().set_pull_log(log.thisptr)
+
+	def set_event_ring(self, event_ring ring):
+		""" pushes every following event of the bandit into the given ring
+		
+		Parameters
+		----------
+		ring : multibeep.util.event_ring or None
+			the ring read by an observer. None stops the events.
+		"""
+		with self.lock:
+			if ring is None:
+				self.thisptr.get().set_event_ring(shared_ptr[util_cpp.event_ring[float_t]]())
+			else:
+				self.thisptr.get().set_event_ring(ring.thisptr)
+
+	def set_background_pmax(self, background_pmax worker):
+		""" computes p_max on the given worker's thread from now on
+		
+		Whenever the arm_infos are accessed, finished results are picked up and,
+		if arms were pulled since the last snapshot and the worker is idle, a new
+		snapshot of the posteriors is handed to it. p_max is then never NaN after
+		the first result, but may lag behind: p_max_staleness of an arm_info is
+		the number of pulls since its p_max snapshot was taken.
+		
+		Parameters
+		----------
+		worker : multibeep.bandits.background_pmax or None
+			the worker, None returns to computing p_max in update_p_max only
+		"""
+		with self.lock:
+			if worker is None:
+				self.thisptr.get().set_background_pmax(shared_ptr[util_cpp.background_worker[float_t, rand_t]]())
+			else:
+				self.thisptr.get().set_background_pmax(worker.thisptr)
+
+	def sync_background_pmax(self):
+		""" picks up a finished result of the background worker and posts a new snapshot if needed
+		
+		If the computation on the worker's thread failed, its exception is
+		raised here (or by the next access of an arm_info) once.
+		"""
+		with self.lock:
+			self.thisptr.get().sync_background_pmax()
+
+	def measure_pull_latency(self, bool enable = True):
+		""" starts/stops recording the duration of every pull
+		
+		The arm_infos then report the number of timed pulls, their mean duration
+		(mean_pull_seconds) and an upper bound of their median (median_pull_ns).
+		Off by default, the cost-aware policies switch it on.
+		"""
+		with self.lock:
+			self.thisptr.get().measure_pull_latency(enable)
+
+	def enable_stats(self, bool enable = True):
+		""" starts/stops collecting counters and timings of the hot paths
+		
+		Off by default. Without effect if the library was compiled with
+		MULTIBEEP_NO_STATS, see multibeep.util.stats_compiled_in.
+		"""
+		with self.lock:
+			self.thisptr.get().enable_stats(enable)
+
+	def stats(self):
+		""" the counters and timings collected so far
+		
+		Returns
+		-------
+		dict
+			number of pulls and the time spent in the arms (pull_ns), updates
+			of dirty arm infos with their time and the number of new
+			posteriors, calls of update_p_max with their time and the number of
+			those that took a fast path for gaussian or beta posteriors, the
+			number of integrals, quadrature nodes (integrand calls) and pdf/cdf
+			evaluations actually computed.
+			All times are in nanoseconds.
+		"""
+		with self.lock:
+			return(self.thisptr.get().get_stats())
+
+	def reset_stats(self):
+		""" sets all counters and timings to zero"""
+		with self.lock:
+			self.thisptr.get().reset_stats()
 
 	def deactivate_by_index(self, unsigned int index):
 		""" deactivates an arm based on its current index
@@ -64,7 +355,8 @@ cdef class base:
 			other arms might change, so don't use this in succession!
 			See deactivate_by_identifier for deactivating multiple arms.
 		"""
-		self.thisptr.get().deactivate_by_index(index)
+		with self.lock:
+			self.thisptr.get().deactivate_by_index(index)
 
 	def deactivate_by_identifier(self, unsigned int ident):
 		""" deactivates an arm based on its unique identifier
@@ -75,7 +367,8 @@ cdef class base:
 			the identifier that should be deactivated. In contrast to indices,
 			the identifiers are constant over the lifetime of a bandit.
 		"""
-		self.thisptr.get().deactivate_by_identifier(ident)
+		with self.lock:
+			self.thisptr.get().deactivate_by_identifier(ident)
 
 	def deactivate_by_confidence_gap(self, float_t delta, bool consider_inactive_arms = True):
 		""" deactivates arms based on the posteriors by comparing the confidence bounds computed from the posteriors
@@ -88,7 +381,8 @@ cdef class base:
 		consider_inactive_arms : bool
 			If True, the bounds of the inactive arms are also considered to find the largest lower bound.
 		"""
-		self.thisptr.get().deactivate_by_confidence_gap(delta, consider_inactive_arms)
+		with self.lock:
+			self.thisptr.get().deactivate_by_confidence_gap(delta, consider_inactive_arms)
 
 	def deactivate_n_worst(self, unsigned int n):
 		""" deactivates arms solely based on their estimated mean
@@ -98,12 +392,15 @@ cdef class base:
 		n : unsigned int
 			the number of arms to deactivate
 		"""
-		self.tihsptr.get().deactivate_n_worst(n)
+		with self.lock:
+			self.thisptr.get().deactivate_n_worst(n)
 
 	def reactivate_by_index(self, unsigned int index):
-		self.thisptr.get().reactivate_by_index(index)
+		with self.lock:
+			self.thisptr.get().reactivate_by_index(index)
 	def reactivate_by_identifier(self, unsigned int ident):
-		self.thisptr.get().reactivate_by_identifier(ident)
+		with self.lock:
+			self.thisptr.get().reactivate_by_identifier(ident)
 	def pull_by_index(self, unsigned int index):
 		"""
 		use this function to pull an arm. Note the index of an arm might
@@ -114,7 +411,52 @@ cdef class base:
 		index : unsigned int
 			the index of the arm to pull
 		"""
-		return(self.thisptr.get().pull_by_index(index))
+		with self.lock:
+			return(self.thisptr.get().pull_by_index(index))
+
+	def add_reward_by_identifier(self, unsigned int ident, float_t reward):
+		"""
+		records the reward of a pull that was evaluated outside of the bandit,
+		e.g. the result of an asynchronous pull of a multibeep.arms.executor arm
+		
+		Parameters
+		----------
+		ident : unsigned int
+			the identifier of the arm that was pulled
+		reward : float
+			the received reward
+		"""
+		with self.lock:
+			self.thisptr.get().add_reward_by_identifier(ident, reward)
+
+	def python_arm(self, unsigned int ident):
+		"""
+		Returns
+		-------
+		multibeep.arms.python or None
+			the python arm with the given identifier, None for arms implemented in C++
+		"""
+		return(self.python_arms.get(ident))
+
+	def pull_batch_by_index(self, unsigned int index, unsigned int n):
+		"""
+		pulls an arm n times in one go. Python arms providing a pull_batch
+		method deliver all rewards in a single call.
+		
+		Parameters
+		----------
+		index : unsigned int
+			the index of the arm to pull
+		n : unsigned int
+			number of pulls
+		
+		Returns
+		-------
+		numpy.ndarray
+			the n rewards, empty if the arm is inactive
+		"""
+		with self.lock:
+			return(np.array(self.thisptr.get().pull_batch_by_index(index, n), dtype=np.double))
 
 	def pull_by_identifier(self, unsigned int ident):
 		"""
@@ -125,7 +467,8 @@ cdef class base:
 		ident : unsigned int
 			the identifier of the arm to pull
 		"""
-		return(self.thisptr.get().pull_by_identifier(ident))
+		with self.lock:
+			return(self.thisptr.get().pull_by_identifier(ident))
 
 	def min_pull_arms(self, unsigned int min_num_pulls):
 		"""
@@ -136,7 +479,13 @@ cdef class base:
 		min_num_pulls : unsigned int
 			minimum number of pull required for every active arm
 		"""
-		self.thisptr.get().min_pull_arms(min_num_pulls)
+		cdef bandits_cpp.base[float_t, rand_t] * b = self.thisptr.get()
+		with self.lock:
+			if self.has_python_arms():
+				b.min_pull_arms(min_num_pulls)
+			else:
+				with nogil:
+					b.min_pull_arms(min_num_pulls)
 	
 	def number_of_arms(self):
 		"""
@@ -145,20 +494,34 @@ cdef class base:
 		unsigned int
 			total number of arms associated with the bandit
 		"""
-		return(self.thisptr.get().number_of_arms())
+		with self.lock:
+			return(self.thisptr.get().number_of_arms())
 	def number_of_active_arms(self):
-		return(self.thisptr.get().number_of_active_arms())
+		with self.lock:
+			return(self.thisptr.get().number_of_active_arms())
 	def number_of_pulls(self):
-		return(self.thisptr.get().number_of_pulls())
+		with self.lock:
+			return(self.thisptr.get().number_of_pulls())
 	def number_of_pulled_arms(self):
-		return(self.thisptr.get().number_of_pulled_arms())
+		with self.lock:
+			return(self.thisptr.get().number_of_pulled_arms())
+	def epoch(self):
+		""" increases whenever the rewards of an arm change, e.g. to detect changes cheaply"""
+		with self.lock:
+			return(self.thisptr.get().epoch())
 
 	def sort_active_arms_by_mean(self):
 		"""
 		Sorts the remaining active arms by the estimated mean. The values
 		are in descending order such that the 'best' arms has index zero.
 		"""
-		self.thisptr.get().sort_active_arms_by_mean()
+		cdef bandits_cpp.base[float_t, rand_t] * b = self.thisptr.get()
+		with self.lock:
+			if self.has_python_arms():
+				b.sort_active_arms_by_mean()
+			else:
+				with nogil:
+					b.sort_active_arms_by_mean()
 
 
 	def update_p_max(self, bool consider_inactive=False, float_t delta = 0.01, unsigned int GL_num_points = 64 ):
@@ -175,13 +538,193 @@ cdef class base:
 		GL_num_points : unsigned int
 			number of point used during the Gauss-Legendre integration.
 		"""
-		self.thisptr.get().update_p_max(consider_inactive, delta, GL_num_points)
+		cdef bandits_cpp.base[float_t, rand_t] * b = self.thisptr.get()
+		with self.lock:
+			if self.has_python_arms():
+				b.update_p_max(consider_inactive, delta, GL_num_points)
+			else:
+				with nogil:
+					b.update_p_max(consider_inactive, delta, GL_num_points)
+
+	def state(self):
+		"""
+		The state of all arms in one go, much cheaper than accessing every arm_info.
+		
+		Returns
+		-------
+		dict of numpy.ndarray
+			identifier, is_active, num_pulls, estimated_mean, estimated_variance
+			and p_max of all arms, ordered by the current index
+		"""
+		cdef unsigned int n
+		cdef np.ndarray[np.uint32_t, ndim=1] identifiers
+		cdef np.ndarray[np.npy_bool, ndim=1, cast=True] is_active
+		cdef np.ndarray[float_t, ndim=1] num_pulls, means, variances, p_maxs
+		with self.lock:
+			n = self.thisptr.get().number_of_arms()
+			identifiers = np.empty(n, dtype=np.uint32)
+			is_active = np.empty(n, dtype=np.bool_)
+			num_pulls = np.empty(n, dtype=np.double)
+			means = np.empty(n, dtype=np.double)
+			variances = np.empty(n, dtype=np.double)
+			p_maxs = np.empty(n, dtype=np.double)
+			if n > 0:
+				self.thisptr.get().get_state(<unsigned int*> &identifiers[0], <bool*> &is_active[0], &num_pulls[0], &means[0], &variances[0], &p_maxs[0])
+		return({'identifier': identifiers, 'is_active': is_active, 'num_pulls': num_pulls,
+				'estimated_mean': means, 'estimated_variance': variances, 'p_max': p_maxs})
+
+	def rewards(self, unsigned int index):
+		"""
+		all rewards an arm received so far
+		
+		Parameters
+		----------
+		index : unsigned int
+			the current index of the arm
+		
+		Returns
+		-------
+		numpy.ndarray
+			a copy of the rewards in the order they were received
+		"""
+		cdef const vector[float_t] * r
+		cdef np.ndarray[float_t, ndim=1] rewards
+		with self.lock:
+			if index >= self.thisptr.get().number_of_arms():
+				raise IndexError("arm index out of range")
+			# a copy: the vector is reallocated by the next pull and moves with every reordering of the arms
+			r = self.thisptr.get().rewards_ptr(index)
+			rewards = np.empty(r.size(), dtype=np.double)
+			if r.size() > 0:
+				memcpy(&rewards[0], r.data(), r.size()*sizeof(float_t))
+		return(rewards)
+
+	def checkpoint(self):
+		""" a binary snapshot of the bandit's state
+		
+		It contains the state of all arm infos (rewards, statistics, activation)
+		and the internal state of the arms, but neither the arms' parameters
+		nor any random number generator. See restore.
+		
+		Returns
+		-------
+		bytes
+			the snapshot
+		"""
+		cdef bytes snapshot
+		with self.lock:
+			snapshot = self.thisptr.get().checkpoint()
+		return(snapshot)
+
+	def restore(self, const unsigned char[::1] snapshot):
+		""" restores a snapshot created by checkpoint
+		
+		The bandit must contain the same arms, added in the same order, as the
+		one the snapshot was taken from. If the snapshot is rejected, the
+		bandit must not be used anymore.
+		
+		Parameters
+		----------
+		snapshot : bytes-like
+			e.g. bytes, a bytearray or a memory mapped file
+		"""
+		if snapshot.shape[0] == 0:
+			raise RuntimeError("Data is not a multibeep snapshot")
+		with self.lock:
+			self.thisptr.get().restore(<const char*> &snapshot[0], snapshot.shape[0])
+
+	def __reduce__(self):
+		# the arms are recreated by replaying the add calls, python arms raise a TypeError
+		return(type(self), self.init_args, (self.additions, self.checkpoint()))
+
+	def __setstate__(self, state):
+		additions, snapshot = state
+		with self.lock:
+			for method, args in additions:
+				getattr(self, method)(*args)
+			self.restore(snapshot)
 
 	def __getitem__( self, int index):
 		ai = arm_info()
-		ai.fill_attributes(&(deref(self.thisptr)[index]), index)
+		with self.lock:
+			ai.fill_attributes(self.thisptr.get().arm_info_ptr(index), index)
 		return(ai)
 
+cdef class pmax_scheduler:
+	""" decides when the p_max values are worth recomputing while a policy plays
+	
+	p_max is refreshed once refresh_every pulls happened since the last
+	refresh, or once the estimated mean of an active arm moved by more than
+	max_drift of its standard error, but only while the time spent refreshing
+	stays below max_fraction of the time since the scheduler was created.
+	See multibeep.policies.base.set_pmax_scheduler.
+	
+	Parameters
+	----------
+	refresh_every : unsigned int
+		maximum number of pulls between two refreshes, 0 disables this
+	max_drift : double
+		change of an estimated mean in standard errors that triggers a refresh, 0 disables this
+	max_fraction : double
+		maximum fraction of the wall-clock time spent refreshing. Default is 0.1.
+	delta, GL_num_points, consider_inactive:
+		see base.update_p_max
+	deactivation_threshold : double
+		arms with a lower p_max are deactivated after every refresh. Default is 0 (no deactivation).
+	"""
+	def __init__(self, unsigned int refresh_every, float_t max_drift = 0, double max_fraction = 0.1,
+				float_t delta = 0.01, unsigned int GL_num_points = 64, bool consider_inactive = False,
+				float_t deactivation_threshold = 0):
+		self.thisptr = shared_ptr[bandits_cpp.pmax_scheduler[float_t, rand_t]](new bandits_cpp.pmax_scheduler[float_t, rand_t](
+			refresh_every, max_drift, max_fraction, delta, GL_num_points, consider_inactive, deactivation_threshold))
+
+	def update(self, base b):
+		""" refreshes p_max of the bandit if it is due, returns whether it did"""
+		with b.lock:
+			return(self.thisptr.get().update(deref(b.thisptr.get())))
+
+	def refresh(self, base b):
+		""" refreshes p_max of the bandit regardless of the schedule"""
+		with b.lock:
+			self.thisptr.get().refresh(deref(b.thisptr.get()))
+
+	@property
+	def number_of_refreshes(self):
+		return(self.thisptr.get().number_of_refreshes())
+
+	@property
+	def time_fraction(self):
+		""" fraction of the wall-clock time since construction spent refreshing"""
+		return(self.thisptr.get().time_fraction())
+
+
+cdef class background_pmax:
+	""" computes p_max on its own thread, see base.set_background_pmax
+	
+	Parameters
+	----------
+	delta, GL_num_points, consider_inactive:
+		see base.update_p_max
+	"""
+	def __init__(self, float_t delta = 0.01, unsigned int GL_num_points = 64, bool consider_inactive = False):
+		self.thisptr = shared_ptr[util_cpp.background_worker[float_t, rand_t]](new util_cpp.background_worker[float_t, rand_t](
+			delta, GL_num_points, consider_inactive))
+
+	@property
+	def is_busy(self):
+		return(self.thisptr.get().is_busy())
+
+	@property
+	def latest_version(self):
+		""" version of the latest finished snapshot, 0 if there is none"""
+		return(self.thisptr.get().latest_version())
+
+	def wait(self):
+		""" blocks until the worker is idle"""
+		with nogil:
+			self.thisptr.get().wait()
+
+
 cdef class empirical(base):
 	"""
 	This bandit automatically provides a gaussian posterior based on the returned rewards.
@@ -214,6 +757,7 @@ cdef class last_n_pulls(base):
 	
 	"""
 	def __init__(self, unsigned int n = 1):
+		self.init_args = (n,)
 		self.tmpptr = new bandits_cpp.last_n_pulls[float_t, rand_t](n)
 		self.thisptr = shared_ptr[bandits_cpp.base[float_t, rand_t] ] (self.tmpptr)
 		self.tmpptr = NULL
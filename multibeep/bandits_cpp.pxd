@@ -4,6 +4,7 @@ from libcpp cimport bool
 from libcpp.vector cimport vector
 from libcpp.string cimport string
 from libcpp.memory cimport shared_ptr
+from libc.stdint cimport uint64_t
 
 
 # TODO: check for const methods in the c++ code and add the keyword here!
@@ -15,6 +16,7 @@ from typedefs cimport *
 
 cimport arms_cpp
 cimport util_cpp
+cimport recommenders_cpp
 
 
 ####################################################################
@@ -30,15 +32,19 @@ cdef extern from "multibeep/bandit/arm_info.hpp" namespace "multibeep::bandits":
 		vector[num_t]   rewards
 		num_t           p_max
 		num_t           p_min
+		uint64_t        p_max_version
+		unsigned int    p_max_staleness
 		shared_ptr[util_cpp.base[num_t, rng_t] ] posterior
 		num_t estimated_mean
 		num_t estimated_variance
+		util_cpp.latency_histogram pull_latency
 		shared_ptr[const arms_cpp.base[num_t, rng_t] ] get_arm_ptr()
 
 cdef extern from "multibeep/bandit/bandit.hpp" namespace "multibeep::bandits":
 	cdef cppclass base[num_t, rng_t]:
 		base                                ()
 		unsigned int add_arm                (shared_ptr[arms_cpp.base])
+		unsigned int add_arms               (const vector[shared_ptr[arms_cpp.base[num_t, rng_t]]] &)
 		void deactivate_by_index            (unsigned int)
 		void deactivate_by_identifier       (unsigned int)
 		void deactivate_by_confidence_gap   (num_t delta, bool)
@@ -48,15 +54,43 @@ cdef extern from "multibeep/bandit/bandit.hpp" namespace "multibeep::bandits":
 		void reactivate_by_identifier       (unsigned int)
 		num_t pull_by_index                 (unsigned int)
 		num_t pull_by_identifier            (int)
-		void min_pull_arms                  (unsigned int)
+		vector[num_t] pull_batch_by_index   (unsigned int, unsigned int) except +
+		void add_reward_by_identifier       (unsigned int, num_t) except +
+		void min_pull_arms                  (unsigned int) except + nogil
 		unsigned int number_of_arms         ()
 		unsigned int number_of_active_arms  ()
 		unsigned int number_of_pulls        ()
 		unsigned int number_of_pulled_arms  ()
+		unsigned int number_of_python_arms  () const
+		uint64_t epoch                      () const
 		const arm_info & operator[]         (unsigned int)
+		const arm_info * arm_info_ptr       (unsigned int) except +
+		const vector[num_t] * rewards_ptr   (unsigned int) except +
 		void update_arm_info                (unsigned int)
-		void sort_active_arms_by_mean       ()
-		void update_p_max					(bool, num_t, unsigned int)
+		void sort_active_arms_by_mean       () except + nogil
+		void update_p_max					(bool, num_t, unsigned int) except + nogil
+		void get_state                      (unsigned int *, bool *, num_t *, num_t *, num_t *, num_t *) except + nogil
+		string checkpoint                   ()
+		void set_pull_log                   (shared_ptr[util_cpp.pull_log[num_t]])
+		void set_event_ring                 (shared_ptr[util_cpp.event_ring[num_t]])
+		void measure_pull_latency           (bool)
+		void set_background_pmax            (shared_ptr[util_cpp.background_worker[num_t, rng_t]])
+		void sync_background_pmax           () except +
+		void add_recommender                (shared_ptr[recommenders_cpp.base[num_t, rng_t]])
+		void remove_recommender             (shared_ptr[recommenders_cpp.base[num_t, rng_t]])
+		void enable_stats                   (bool)
+		const util_cpp.bandit_stats & get_stats ()
+		void reset_stats                    ()
+		void restore                        (const char *, size_t) except +
+
+
+cdef extern from "multibeep/bandit/pmax_scheduler.hpp" namespace "multibeep::bandits":
+	cdef cppclass pmax_scheduler[num_t, rng_t]:
+		pmax_scheduler(unsigned int, num_t, double, num_t, unsigned int, bool, num_t)
+		bool update(base[num_t, rng_t] &) except + nogil
+		void refresh(base[num_t, rng_t] &) except + nogil
+		unsigned int number_of_refreshes()
+		double time_fraction()
 
 
 cdef extern from "multibeep/bandit/empirical_bandits.hpp" namespace "multibeep::bandits":
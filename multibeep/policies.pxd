@@ -7,6 +7,7 @@ from libcpp.memory cimport shared_ptr
 
 cimport bandits_cpp
 cimport policies_cpp
+cimport bandits
 
 from typedefs cimport *
 
@@ -14,6 +15,15 @@ from typedefs cimport *
 
 cdef class base:
 	cdef policies_cpp.base[float_t, rand_t]* thisptr
+	# the python bandit, to know whether the GIL can be released and for its lock
+	cdef bandits.base bandit
+	# lock of policies without a python bandit, see get_lock
+	cdef object own_lock
+	# constructor arguments for pickling, None if the policy cannot be pickled
+	cdef object init_args
+
+	cdef object get_lock(self)
+	cdef play_n_rounds_asynchronously(self, unsigned int n, unsigned int max_pending)
 
 
 
@@ -23,6 +33,19 @@ cdef class UCB_p(base):
 	pass
 cdef class prob_match(base):
 	pass
+cdef class cost_aware_UCB_p(base):
+	pass
+cdef class cost_aware_prob_match(base):
+	pass
 cdef class successive_halving(base):
 	pass
+cdef class hyperband(base):
+	# keeps the python callables alive as long as the C++ object uses them
+	cdef object callbacks
 
+cdef class asynchronous_successive_halving(base):
+	pass
+cdef class f_race(base):
+	pass
+cdef class LUCB(base):
+	pass
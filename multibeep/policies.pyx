@@ -1,19 +1,37 @@
 import cython
+from cython.operator cimport dereference as deref
 from libcpp.memory cimport shared_ptr
 
+import concurrent.futures
+import threading
+
 
 cimport policies_cpp
+cimport bandits_cpp
+cimport arms_cpp
 
 from typedefs cimport *
 
 cimport policies
 cimport bandits
+cimport arms
 from util cimport rng_class
 
 
 cdef class base:
+	""" Base class for all policies.
+	
+	The methods of a policy hold the lock of its bandit, see
+	multibeep.bandits.base, so a policy and its bandit can be used from
+	several Python threads. Policies without a Python bandit, i.e. Hyperband,
+	have a lock of their own.
+	"""
+	def __cinit__(self):
+		self.own_lock = threading.RLock()
 	def __dealloc__(self):
 		del self.thisptr
+	cdef object get_lock(self):
+		return(self.own_lock if self.bandit is None else self.bandit.lock)
 	def select_next_arm(self):
 		"""
 		policy suggests the next arm to pull
@@ -23,9 +41,10 @@ cdef class base:
 		unsigned int
 			the current *index* of the arm to pull
 		"""
-		return(self.thisptr.select_next_arm())
+		with self.get_lock():
+			return(self.thisptr.select_next_arm())
 
-	def play_n_rounds(self, cython.uint n):
+	def play_n_rounds(self, cython.uint n, cython.uint max_pending = 0):
 		"""
 		automatically pull multiple times.
 		
@@ -36,11 +55,200 @@ cdef class base:
 		----------
 		n : unsigned int
 			number of round to be played
-		
+		max_pending : unsigned int
+			maximum number of asynchronous pulls of multibeep.arms.executor arms
+			running at the same time. While they run, the policy keeps selecting
+			other arms; an arm is not pulled again before its result has arrived.
+			If the policy selects a running arm, no further arm is selected until
+			that pull has finished and the arm was submitted again.
+			Requires a policy that implements select_next_arm and plays a single
+			bandit, i.e. not Hyperband. If an evaluation raises an exception, the
+			pulls that have not started are cancelled, the results of the running
+			ones are still recorded and the exception is raised. Default is 0,
+			which means every pull waits for its result.
 		"""
-		self.thisptr.play_n_rounds(n)
+		cdef policies_cpp.base[float_t, rand_t] * p = self.thisptr
+		with self.get_lock():
+			if max_pending > 0:
+				self.play_n_rounds_asynchronously(n, max_pending)
+			# python arms reacquire the GIL in every callback, so only keep it if they are involved anyway
+			elif (self.bandit is not None) and self.bandit.has_python_arms():
+				p.play_n_rounds(n)
+			else:
+				with nogil:
+					p.play_n_rounds(n)
 	
 
+	def play_for(self, double seconds):
+		""" plays rounds until the given wall-clock time has passed
+		
+		The time is checked between rounds, so the last round can exceed
+		the duration by the time it takes.
+		
+		Parameters
+		----------
+		seconds : double
+			the duration
+		
+		Returns
+		-------
+		unsigned int
+			the number of rounds played
+		"""
+		cdef policies_cpp.base[float_t, rand_t] * p = self.thisptr
+		cdef unsigned int n
+		with self.get_lock():
+			if (self.bandit is not None) and self.bandit.has_python_arms():
+				n = p.play_for(policies_cpp.seconds_t(seconds))
+			else:
+				with nogil:
+					n = p.play_for(policies_cpp.seconds_t(seconds))
+		return(n)
+
+	def play_until(self, predicate, cython.uint max_rounds = 4294967295):
+		""" plays rounds until predicate() returns True or max_rounds were played
+		
+		The predicate is called before every round.
+		
+		Returns
+		-------
+		unsigned int
+			the number of rounds played
+		"""
+		cdef unsigned int n = 0
+		with self.get_lock():
+			while (n < max_rounds) and (not predicate()):
+				self.thisptr.play_round()
+				n += 1
+		return(n)
+
+	def set_pmax_scheduler(self, bandits.pmax_scheduler scheduler):
+		""" refreshes p_max according to the given schedule while playing
+		
+		The scheduler is consulted after every round of play_n_rounds,
+		play_for and play_until. None stops it.
+		"""
+		with self.get_lock():
+			if scheduler is None:
+				self.thisptr.set_pmax_scheduler(shared_ptr[bandits_cpp.pmax_scheduler[float_t, rand_t]]())
+			else:
+				self.thisptr.set_pmax_scheduler(scheduler.thisptr)
+
+	def replay_n_rounds(self, cython.uint n):
+		"""
+		plays n rounds on a bandit of replay arms, see multibeep.bandits.base.add_replay_arms
+		
+		Parameters
+		----------
+		n : unsigned int
+			number of rounds to be played
+		
+		Returns
+		-------
+		bool
+			True if all rounds were played, False if the policy wanted to pull an
+			arm more often than in the recorded run
+		"""
+		cdef policies_cpp.base[float_t, rand_t] * p = self.thisptr
+		cdef bint done
+		with self.get_lock():
+			with nogil:
+				done = policies_cpp.replay_n_rounds[float_t, rand_t](deref(p), n)
+		return(done)
+
+	def enable_stats(self, bint enable = True):
+		""" starts/stops timing the selections made in play_n_rounds
+		
+		The pulls themselves are counted by the bandit, see multibeep.bandits.base.enable_stats.
+		"""
+		with self.get_lock():
+			self.thisptr.enable_stats(enable)
+
+	def stats(self):
+		""" the number of selections and the time spent in them (selection_ns, in nanoseconds) as a dict"""
+		with self.get_lock():
+			return(self.thisptr.get_stats())
+
+	def reset_stats(self):
+		""" sets all counters and timings to zero"""
+		with self.get_lock():
+			self.thisptr.reset_stats()
+
+	def checkpoint(self):
+		""" a binary snapshot of the policy's internal state, e.g. its random number generator
+		
+		Together with the checkpoint of the bandit, this allows to resume a run.
+		
+		Returns
+		-------
+		bytes
+			the snapshot
+		"""
+		cdef bytes snapshot
+		with self.get_lock():
+			snapshot = self.thisptr.checkpoint()
+		return(snapshot)
+
+	def restore(self, const unsigned char[::1] snapshot):
+		""" restores a snapshot created by checkpoint of a policy with the same parameters
+		
+		Parameters
+		----------
+		snapshot : bytes-like
+			e.g. bytes, a bytearray or a memory mapped file
+		"""
+		if snapshot.shape[0] == 0:
+			raise RuntimeError("Data is not a multibeep snapshot")
+		with self.get_lock():
+			self.thisptr.restore(<const char*> &snapshot[0], snapshot.shape[0])
+
+	def __reduce__(self):
+		# the bandit is part of the constructor arguments, so it is pickled (and restored) first
+		if self.init_args is None:
+			raise TypeError("%s policies cannot be pickled"%type(self).__name__)
+		return(type(self), self.init_args, self.checkpoint())
+
+	def __setstate__(self, snapshot):
+		self.restore(snapshot)
+
+	cdef play_n_rounds_asynchronously(self, unsigned int n, unsigned int max_pending):
+		cdef bandits.base b = self.bandit
+		cdef unsigned int index
+		if b is None:
+			raise ValueError("asynchronous pulls require a policy playing a single bandit")
+		# future -> identifier of the pulled arm
+		pending = {}
+		# identifier of the last selection, None once it is submitted
+		selected = None
+		try:
+			while (n > 0) or pending:
+				while (n > 0) and (len(pending) < max_pending):
+					if selected is None:
+						index = self.thisptr.select_next_arm()
+						selected = b.thisptr.get().arm_info_ptr(index).identifier
+					# the policy wants to pull a running arm again, keep the choice until its result is in
+					if selected in pending.values():
+						break
+					arm = b.python_arm(selected)
+					if hasattr(arm, 'submit'):
+						pending[arm.submit()] = selected
+					else:
+						b.pull_by_identifier(selected)
+					selected = None
+					n -= 1
+				if not pending:
+					continue
+				done, _ = concurrent.futures.wait(pending, return_when=concurrent.futures.FIRST_COMPLETED)
+				for f in done:
+					b.add_reward_by_identifier(pending.pop(f), f.result())
+		finally:
+			# only left with pending pulls after an exception: cancel what has not started, keep the other results
+			for f in pending:
+				f.cancel()
+			for f in concurrent.futures.as_completed(pending):
+				if (not f.cancelled()) and (f.exception() is None):
+					b.add_reward_by_identifier(pending[f], f.result())
+
 cdef class random(base):
 	""" the random policy just picks an arm uniformly at random among all active arms
 	
@@ -52,6 +260,8 @@ cdef class random(base):
 		a valid random number generator
 	"""
 	def __init__ (self, bandits.base b, rng_class rng):
+		self.bandit = b
+		self.init_args = (b, rng)
 		self.thisptr = new policies_cpp.random[float_t, rand_t] (b.thisptr, rng.thisptr)
 
 cdef class UCB_p(base):
@@ -67,6 +277,8 @@ cdef class UCB_p(base):
 		prefactor to the standard deviation in the equation above. Controlls exploration vs. exploitation.
 	"""
 	def __init__ (self, bandits.base b, rng_class rng, float_t p):
+		self.bandit = b
+		self.init_args = (b, rng, p)
 		self.thisptr = new policies_cpp.UCB_p[float_t, rand_t] (b.thisptr, rng.thisptr, p)
 
 cdef class prob_match(base):
@@ -80,8 +292,50 @@ cdef class prob_match(base):
 		a valid random number generator
 	"""
 	def __init__ (self, bandits.base b, rng_class rng):
+		self.bandit = b
+		self.init_args = (b, rng)
 		self.thisptr = new policies_cpp.prob_match[float_t, rand_t] (b.thisptr, rng.thisptr)
 
+cdef class cost_aware_UCB_p(base):
+	""" UCB_p variant picking the arm with the largest (UCB - best estimated mean) per second of pull time
+	
+	Makes the bandit measure the duration of every pull (see
+	multibeep.bandits.base.measure_pull_latency) and uses the mean duration
+	of an arm as its cost. Arms that were never timed are pulled first. If
+	no arm promises an improvement, the choice of UCB_p is made.
+	
+	Parameters
+	----------
+	b : multibeep.bandits.bandit
+		the bandit to be played
+	rng : multibeep.util.rng_class
+		a valid random number generator
+	p : double
+		prefactor to the standard deviation, see UCB_p
+	"""
+	def __init__ (self, bandits.base b, rng_class rng, float_t p):
+		self.bandit = b
+		self.init_args = (b, rng, p)
+		self.thisptr = new policies_cpp.cost_aware_UCB_p[float_t, rand_t] (b.thisptr, rng.thisptr, p)
+
+cdef class cost_aware_prob_match(base):
+	""" Probability Match variant picking the arm with the largest (posterior sample - best estimated mean) per second of pull time
+	
+	See cost_aware_UCB_p for how the cost is measured. If no sample beats
+	the best mean, the arm with the largest sample is pulled as in prob_match.
+	
+	Parameters
+	----------
+	b : multibeep.bandits.bandit
+		the bandit to be played
+	rng: multibeep.util.rng_class
+		a valid random number generator
+	"""
+	def __init__ (self, bandits.base b, rng_class rng):
+		self.bandit = b
+		self.init_args = (b, rng)
+		self.thisptr = new policies_cpp.cost_aware_prob_match[float_t, rand_t] (b.thisptr, rng.thisptr)
+
 cdef class successive_halving(base):
 	""" pulls 
 	
@@ -99,7 +353,292 @@ cdef class successive_halving(base):
 		of pulls per round is constant.
 	"""
 	def __init__ (self, bandits.base b, unsigned int min_num_pulls, float_t frac_arms, float_t factor_pulls = 0):
+		self.init_args = (b, min_num_pulls, frac_arms, factor_pulls)
 		if factor_pulls <= 0 :
+			self.bandit = b
 			self.thisptr = new policies_cpp.successive_halving[float_t, rand_t] (b.thisptr, min_num_pulls, frac_arms)
 		else:
+			self.bandit = b
 			self.thisptr = new policies_cpp.successive_halving[float_t, rand_t] (b.thisptr, min_num_pulls, frac_arms, factor_pulls)
+
+	def number_of_rounds(self):
+		""" number of rounds played so far; play_n_rounds continues with the next one"""
+		with self.get_lock():
+			return((<policies_cpp.successive_halving[float_t, rand_t]*> self.thisptr).number_of_rounds())
+
+
+cdef class asynchronous_successive_halving(base):
+	""" asynchronous successive halving (ASHA) for a pool of workers
+	
+	An arm is promoted to the next rung as soon as it is in the top 1/eta of all arms
+	that finished the current rung. Free workers ask for a job with next_job, pull the
+	arm job[2] times with pull_job and report back with complete_job. Workers must
+	not pull the bandit directly, as (de)activations reorder its arms. The pulls of
+	different workers run at the same time, so arms must not share state.
+	
+	Parameters
+	----------
+	b : multibeep.bandits.bandit
+		the bandit to be played
+	min_num_pulls : unsigned int
+		number of pulls for every arm in the lowest rung
+	eta : double
+		only the top 1/eta of the arms in a rung get promoted; every rung has eta times the pulls of the previous one
+	max_pulls : unsigned int
+		maximum number of pulls for a single arm, determines the number of rungs
+	"""
+	def __init__ (self, bandits.base b, unsigned int min_num_pulls, float_t eta, unsigned int max_pulls):
+		self.bandit = b
+		self.init_args = (b, min_num_pulls, eta, max_pulls)
+		self.thisptr = new policies_cpp.asynchronous_successive_halving[float_t, rand_t] (b.thisptr, min_num_pulls, eta, max_pulls)
+
+	def next_job(self):
+		"""
+		Returns
+		-------
+		tuple or None
+			(identifier, rung, number of pulls) of the next job, or None if there is nothing to do right now
+		"""
+		cdef policies_cpp.rung_job job
+		with self.get_lock():
+			job = (<policies_cpp.asynchronous_successive_halving[float_t, rand_t]*> self.thisptr).next_job()
+		if not job.valid():
+			return(None)
+		return((job.identifier, job.rung, job.num_pulls))
+
+	def pull_job(self, job):
+		"""
+		pulls the arm of a running job once
+		
+		Only the bookkeeping holds the lock of the bandit, the pull itself runs
+		without it (and, for arms implemented in C++, without the GIL), so the
+		pulls of several workers overlap.
+		
+		Parameters
+		----------
+		job : tuple
+			a job returned by next_job and not completed yet
+		
+		Returns
+		-------
+		double
+			the reward
+		"""
+		cdef policies_cpp.rung_job j = policies_cpp.rung_job(job[0], job[1], job[2])
+		cdef shared_ptr[arms_cpp.base[float_t, rand_t]] arm
+		cdef float_t reward
+		with self.get_lock():
+			arm = (<policies_cpp.asynchronous_successive_halving[float_t, rand_t]*> self.thisptr).job_arm(j)
+		# python arms take the GIL back in their callback
+		with nogil:
+			reward = arm.get().pull()
+		with self.get_lock():
+			(<policies_cpp.asynchronous_successive_halving[float_t, rand_t]*> self.thisptr).record_pull(j, reward)
+		return(reward)
+
+	def complete_job(self, job):
+		"""
+		reports a job as finished after all its pulls have been done
+		
+		Raises a ValueError for jobs that were not handed out or are already completed.
+		
+		Parameters
+		----------
+		job : tuple
+			a job returned by next_job
+		"""
+		cdef policies_cpp.rung_job j = policies_cpp.rung_job(job[0], job[1], job[2])
+		with self.get_lock():
+			(<policies_cpp.asynchronous_successive_halving[float_t, rand_t]*> self.thisptr).complete_job(j)
+
+	def number_of_arms_in_rung(self, unsigned int rung):
+		with self.get_lock():
+			return((<policies_cpp.asynchronous_successive_halving[float_t, rand_t]*> self.thisptr).number_of_arms_in_rung(rung))
+
+	def number_of_running_jobs(self):
+		with self.get_lock():
+			return((<policies_cpp.asynchronous_successive_halving[float_t, rand_t]*> self.thisptr).number_of_running_jobs())
+
+	def best_identifier(self):
+		"""
+		Returns
+		-------
+		unsigned int
+			identifier of the best arm in the highest rung reached so far
+		"""
+		with self.get_lock():
+			return((<policies_cpp.asynchronous_successive_halving[float_t, rand_t]*> self.thisptr).best_identifier())
+
+
+cdef class f_race(base):
+	""" F-Race pulls every surviving arm once per round and eliminates arms based on the Friedman test.
+	
+	The race consists of the arms that are active when play_n_rounds is called
+	for the first time. Rank statistics are updated incrementally, and all arms that
+	perform significantly worse than the best one are deactivated at once.
+	
+	Parameters
+	----------
+	b : multibeep.bandits.bandit
+		the bandit to be played
+	alpha : double
+		significance level for the Friedman test and the post hoc comparison. Default is 0.05.
+	min_num_rounds : unsigned int
+		number of rounds played before the first test is performed. Default is 5.
+	"""
+	def __init__ (self, bandits.base b, float_t alpha = 0.05, unsigned int min_num_rounds = 5):
+		self.bandit = b
+		self.init_args = (b, alpha, min_num_rounds)
+		self.thisptr = new policies_cpp.f_race[float_t, rand_t] (b.thisptr, alpha, min_num_rounds)
+
+	def number_of_racers(self):
+		with self.get_lock():
+			return((<policies_cpp.f_race[float_t, rand_t]*> self.thisptr).number_of_racers())
+
+	def number_of_rounds(self):
+		with self.get_lock():
+			return((<policies_cpp.f_race[float_t, rand_t]*> self.thisptr).number_of_rounds())
+
+
+cdef class LUCB(base):
+	""" LUCB identifies the best arm with a fixed confidence by pulling the empirical leader and its strongest challenger.
+	
+	play_n_rounds stops early once the confidence bounds of the leader and the challenger are separated.
+	
+	Parameters
+	----------
+	b : multibeep.bandits.bandit
+		the bandit to be played
+	delta : double
+		probability that the identified arm is not epsilon-optimal
+	epsilon : double
+		tolerance of the identification. Default is 0.
+	"""
+	def __init__ (self, bandits.base b, float_t delta, float_t epsilon = 0):
+		self.bandit = b
+		self.init_args = (b, delta, epsilon)
+		self.thisptr = new policies_cpp.LUCB[float_t, rand_t] (b.thisptr, delta, epsilon)
+
+	def finished(self):
+		"""
+		Returns
+		-------
+		bool
+			True if the lower bound of the leader exceeds the upper bound of every other arm (minus epsilon)
+		"""
+		with self.get_lock():
+			return((<policies_cpp.LUCB[float_t, rand_t]*> self.thisptr).finished())
+
+	def best_identifier(self):
+		"""
+		Returns
+		-------
+		unsigned int
+			identifier of the current empirical leader
+		"""
+		with self.get_lock():
+			return((<policies_cpp.LUCB[float_t, rand_t]*> self.thisptr).best_identifier())
+
+
+
+# moderator functions between C++ and python
+
+# The C++ caller cannot handle a python exception, so it is stored in the
+# third entry of the callbacks and an empty pointer is returned instead. The
+# policy turns that into a C++ exception and hyperband.play_n_rounds raises
+# the stored exception again.
+
+cdef shared_ptr[bandits_cpp.base[float_t, rand_t] ] bandit_factory_wrapper(void *obj) noexcept with gil:
+	o = <object> obj
+	cdef bandits.base b
+	try:
+		b = <bandits.base?> o[0]()
+		return(b.thisptr)
+	except BaseException as e:
+		o[2] = e
+		return(shared_ptr[bandits_cpp.base[float_t, rand_t] ]())
+
+cdef shared_ptr[arms_cpp.base[float_t, rand_t] ] arm_sampler_wrapper(void *obj, shared_ptr[rand_t] rng) noexcept with gil:
+	o = <object> obj
+	cdef rng_class r = rng_class.__new__(rng_class)
+	cdef arms.base a
+	r.thisptr = rng
+	try:
+		a = <arms.base?> o[1](r)
+		return(a.get_arm_ptr())
+	except BaseException as e:
+		o[2] = e
+		return(shared_ptr[arms_cpp.base[float_t, rand_t] ]())
+
+
+cdef class hyperband(base):
+	""" Hyperband plays several brackets of successive halving, each with its own bandit and arms.
+	
+	All arms are created up front in the calling thread, the brackets are played concurrently
+	afterwards without holding the GIL. Python arms work, but their pulls are serialized by the GIL.
+	
+	Parameters
+	----------
+	bandit_factory : callable
+		called without arguments, returns a new (empty) multibeep.bandits.base object for every bracket
+	arm_sampler : callable
+		called with the multibeep.util.rng_class of the bracket, returns a new multibeep.arms.base object.
+		The arm should use the provided generator, so brackets don't share any state.
+	rng : multibeep.util.rng_class
+		a valid random number generator used to seed the generators of the brackets
+	max_pulls : double
+		maximum number of pulls a single arm receives in one bracket (R in the paper)
+	eta : double
+		only 1/eta of the arms survive each round of successive halving. Default is 3.
+	num_threads : unsigned int
+		number of worker threads playing the brackets. Default is 0, which means one per core.
+	"""
+	def __init__ (self, bandit_factory, arm_sampler, rng_class rng, float_t max_pulls, float_t eta = 3, unsigned int num_threads = 0):
+		# the last entry holds an exception raised by one of the callables
+		self.callbacks = [bandit_factory, arm_sampler, None]
+		self.thisptr = new policies_cpp.hyperband[float_t, rand_t] (&bandit_factory_wrapper, &arm_sampler_wrapper, <void*> self.callbacks, rng.thisptr, max_pulls, eta, num_threads)
+
+	def play_n_rounds(self, cython.uint n, cython.uint max_pending = 0):
+		""" plays n full iterations of Hyperband, see multibeep.policies.base.play_n_rounds
+		
+		An exception raised by the bandit factory or the arm sampler (including
+		a TypeError if they return the wrong type) is raised here, and the
+		brackets of the failed iteration are discarded.
+		"""
+		self.callbacks[2] = None
+		try:
+			base.play_n_rounds(self, n, max_pending)
+		except RuntimeError:
+			e = self.callbacks[2]
+			self.callbacks[2] = None
+			if e is None:
+				raise
+			raise e
+
+	def number_of_brackets(self):
+		"""
+		Returns
+		-------
+		unsigned int
+			number of brackets played so far. Every call to play_n_rounds adds s_max + 1 brackets.
+		"""
+		with self.get_lock():
+			return((<policies_cpp.hyperband[float_t, rand_t]*> self.thisptr).number_of_brackets())
+
+	def get_bracket(self, unsigned int i):
+		""" access to the bandit of a played bracket
+		
+		Parameters
+		----------
+		i : unsigned int
+			index of the bracket in the order they were created
+		
+		Returns
+		-------
+		multibeep.bandits.base
+			the bandit containing all arms of that bracket
+		"""
+		cdef bandits.base b = bandits.base()
+		with self.get_lock():
+			b.thisptr = (<policies_cpp.hyperband[float_t, rand_t]*> self.thisptr).get_bracket(i)
+		return(b)
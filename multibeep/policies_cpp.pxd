@@ -1,23 +1,42 @@
 import cython
 
+from libcpp cimport bool
 from libcpp.memory cimport shared_ptr
+from libcpp.string cimport string
 
 # TODO: check for const methods in the c++ code and add the keyword here!
 #       also, check for exceptions
 
 from typedefs cimport *
+cimport arms_cpp
 cimport bandits_cpp
+cimport util_cpp
 
 
 ####################################################################
 # policy section
 ####################################################################
 
+cdef extern from "<chrono>" namespace "std::chrono" nogil:
+	cdef cppclass seconds_t "std::chrono::duration<double>":
+		seconds_t(double)
+
 cdef extern from "multibeep/policy/policy.hpp" namespace "multibeep::policies":
 	cdef cppclass base[num_t, rng_t]:
 		policy_base (shared_ptr[bandits_cpp.base[num_t, rng_t] ])
 		unsigned int select_next_arm()
-		void play_n_rounds (unsigned int)
+		void play_n_rounds (unsigned int) except + nogil
+		void play_round () except + nogil
+		unsigned int play_for (seconds_t) except + nogil
+		void set_pmax_scheduler (shared_ptr[bandits_cpp.pmax_scheduler[num_t, rng_t]])
+		string checkpoint() except +
+		void restore(const char *, size_t) except +
+		void enable_stats(bool)
+		const util_cpp.policy_stats & get_stats()
+		void reset_stats()
+
+cdef extern from "multibeep/policy/replay.hpp" namespace "multibeep::policies":
+	bool replay_n_rounds[num_t, rng_t](base[num_t, rng_t] &, unsigned int) except + nogil
 
 cdef extern from "multibeep/policy/random.hpp" namespace "multibeep::policies":
 	cdef cppclass random[num_t, rng_t] (base[num_t, rng_t]):
@@ -35,8 +54,62 @@ cdef extern from "multibeep/policy/prob_match.hpp" namespace "multibeep::policie
 	cdef cppclass prob_match[num_t, rng_t] (base[num_t, rng_t]):
 		prob_match(shared_ptr[bandits_cpp.base[num_t, rng_t] ], shared_ptr[rng_t])
 
+cdef extern from "multibeep/policy/cost_aware.hpp" namespace "multibeep::policies":
+	cdef cppclass cost_aware_UCB_p[num_t, rng_t] (UCB_p[num_t, rng_t]):
+		cost_aware_UCB_p(shared_ptr[bandits_cpp.base[num_t, rng_t] ], shared_ptr[rng_t], num_t)
+
+	cdef cppclass cost_aware_prob_match[num_t, rng_t] (prob_match[num_t, rng_t]):
+		cost_aware_prob_match(shared_ptr[bandits_cpp.base[num_t, rng_t] ], shared_ptr[rng_t])
+
 cdef extern from "multibeep/policy/successive_halving.hpp" namespace "multibeep::policies":
 	cdef cppclass successive_halving[num_t, rng_t] (base[num_t, rng_t]):
 		successive_halving(shared_ptr[bandits_cpp.base[num_t, rng_t] ], unsigned int, num_t, num_t)
 		successive_halving(shared_ptr[bandits_cpp.base[num_t, rng_t] ], unsigned int, num_t)
+		unsigned int number_of_rounds()
+
+
+ctypedef shared_ptr[bandits_cpp.base[float_t, rand_t] ] (*python_bandit_factory)(void*)
+ctypedef shared_ptr[arms_cpp.base[float_t, rand_t] ] (*python_arm_sampler)(void*, shared_ptr[rand_t])
+
+cdef extern from "multibeep/policy/hyperband.hpp" namespace "multibeep::policies":
+	cdef cppclass hyperband[num_t, rng_t] (base[num_t, rng_t]):
+		hyperband(python_bandit_factory, python_arm_sampler, void*, shared_ptr[rng_t], num_t, num_t, unsigned int) except +
+		unsigned int number_of_arms(unsigned int)
+		unsigned int number_of_pulls(unsigned int)
+		unsigned int get_s_max()
+		unsigned int number_of_brackets()
+		shared_ptr[bandits_cpp.base[num_t, rng_t] ] get_bracket(unsigned int) except +
+
+cdef extern from "multibeep/policy/asynchronous_successive_halving.hpp" namespace "multibeep::policies":
+	cdef cppclass rung_job:
+		rung_job()
+		rung_job(unsigned int, unsigned int, unsigned int)
+		unsigned int identifier
+		unsigned int rung
+		unsigned int num_pulls
+		bool valid()
+
+	cdef cppclass asynchronous_successive_halving[num_t, rng_t] (base[num_t, rng_t]):
+		asynchronous_successive_halving(shared_ptr[bandits_cpp.base[num_t, rng_t] ], unsigned int, num_t, unsigned int) except +
+		unsigned int number_of_pulls(unsigned int)
+		unsigned int get_max_rung()
+		unsigned int number_of_arms_in_rung(unsigned int) except +
+		unsigned int number_of_running_jobs()
+		rung_job next_job()
+		shared_ptr[arms_cpp.base[num_t, rng_t]] job_arm(const rung_job &) except +
+		void record_pull(const rung_job &, num_t) except +
+		num_t pull_job(const rung_job &) except +
+		void complete_job(const rung_job &) except +
+		unsigned int best_identifier()
+
+cdef extern from "multibeep/policy/f_race.hpp" namespace "multibeep::policies":
+	cdef cppclass f_race[num_t, rng_t] (base[num_t, rng_t]):
+		f_race(shared_ptr[bandits_cpp.base[num_t, rng_t] ], num_t, unsigned int)
+		unsigned int number_of_racers()
+		unsigned int number_of_rounds()
 
+cdef extern from "multibeep/policy/lucb.hpp" namespace "multibeep::policies":
+	cdef cppclass LUCB[num_t, rng_t] (base[num_t, rng_t]):
+		LUCB(shared_ptr[bandits_cpp.base[num_t, rng_t] ], num_t, num_t)
+		bool finished()
+		unsigned int best_identifier()
@@ -0,0 +1,30 @@
+import cython
+from libcpp.memory cimport shared_ptr
+
+cimport recommenders_cpp
+cimport bandits
+
+from typedefs cimport *
+
+
+cdef class base:
+	cdef shared_ptr[recommenders_cpp.base[float_t, rand_t]] thisptr
+	# the bandit reporting to this recommender
+	cdef readonly bandits.base bandit
+	# lock of a detached recommender, see get_lock
+	cdef object own_lock
+
+	cdef object get_lock(self)
+	cdef attach(self, bandits.base b)
+
+
+cdef class highest_mean(base):
+	pass
+cdef class most_pulled(base):
+	pass
+cdef class highest_lower_bound(base):
+	pass
+cdef class highest_pmax(base):
+	pass
+cdef class top_k(base):
+	pass
@@ -0,0 +1,172 @@
+import cython
+from libcpp.memory cimport shared_ptr
+
+import threading
+
+import numpy as np
+
+cimport recommenders_cpp
+cimport bandits_cpp
+
+from typedefs cimport *
+
+cimport bandits
+
+
+cdef class base:
+	""" Base class for all recommenders.
+	
+	A recommender is attached to a bandit when it is created and keeps its
+	recommendation up-to-date with every pull, so querying it is cheap at
+	any time (anytime reporting). Arms keep their score when they are
+	deactivated.
+	
+	While it is attached, the methods hold the lock of the bandit, see
+	multibeep.bandits.base.
+	"""
+	def __cinit__(self):
+		self.own_lock = threading.RLock()
+
+	cdef object get_lock(self):
+		return(self.own_lock if self.bandit is None else self.bandit.lock)
+
+	cdef attach(self, bandits.base b):
+		# 'not None' is not allowed in cdef methods, b is dereferenced below
+		if b is None:
+			raise TypeError("a recommender needs a bandit, not None")
+		with b.lock:
+			self.bandit = b
+			b.thisptr.get().add_recommender(self.thisptr)
+
+	def detach(self):
+		""" stops following the bandit; the recommendation stays as it is"""
+		with self.get_lock():
+			if self.bandit is not None:
+				self.bandit.thisptr.get().remove_recommender(self.thisptr)
+				self.bandit = None
+
+	def get_ident(self):
+		cdef bytes ident = self.thisptr.get().get_ident()
+		return(ident.decode())
+
+	def has_recommendation(self):
+		with self.get_lock():
+			return(self.thisptr.get().has_recommendation())
+
+	def best_identifier(self):
+		""" identifier of the recommended arm, raises a RuntimeError if there is none yet"""
+		with self.get_lock():
+			return(self.thisptr.get().best_identifier())
+
+	def best_score(self):
+		""" score of the recommended arm, NaN if there is none"""
+		with self.get_lock():
+			return(self.thisptr.get().best_score())
+
+	def top_identifiers(self, unsigned int k):
+		""" identifiers of the (up to) k arms with the highest scores, best first, as a numpy array"""
+		with self.get_lock():
+			return(np.array(self.thisptr.get().top_identifiers(k), dtype=np.uintc))
+
+	def number_of_ranked_arms(self):
+		""" number of arms with a score"""
+		with self.get_lock():
+			return(self.thisptr.get().number_of_ranked_arms())
+
+	def score_by_identifier(self, unsigned int identifier):
+		""" score of the arm with the given identifier, NaN if it has none"""
+		with self.get_lock():
+			return(self.thisptr.get().score_by_identifier(identifier))
+
+	def recommendation_distribution(self):
+		""" probability of recommending each arm, as a numpy array indexed by identifier"""
+		with self.get_lock():
+			return(np.array(self.thisptr.get().recommendation_distribution(), dtype=np.double))
+
+	def instantaneous_regret(self):
+		""" best real mean minus the expected real mean of the recommendation, NaN without one"""
+		with self.get_lock():
+			return(self.thisptr.get().instantaneous_regret())
+
+
+cdef class highest_mean(base):
+	""" recommends the arm with the highest estimated mean
+	
+	Parameters
+	----------
+	bandit : multibeep.bandits.base
+		the bandit to follow
+	"""
+	def __init__(self, bandits.base bandit not None):
+		self.thisptr = shared_ptr[recommenders_cpp.base[float_t, rand_t]](new recommenders_cpp.highest_mean[float_t, rand_t]())
+		self.attach(bandit)
+
+
+cdef class most_pulled(base):
+	""" recommends the arm pulled most often
+	
+	Parameters
+	----------
+	bandit : multibeep.bandits.base
+		the bandit to follow
+	"""
+	def __init__(self, bandits.base bandit not None):
+		self.thisptr = shared_ptr[recommenders_cpp.base[float_t, rand_t]](new recommenders_cpp.most_pulled[float_t, rand_t]())
+		self.attach(bandit)
+
+
+cdef class highest_lower_bound(base):
+	""" recommends the arm with the highest lower confidence bound
+	
+	Parameters
+	----------
+	bandit : multibeep.bandits.base
+		the bandit to follow
+	delta : double
+		the bound is the delta/2 quantile of the posterior, see
+		multibeep.util.posterior_class.support
+	"""
+	def __init__(self, bandits.base bandit not None, float_t delta = 0.05):
+		self.thisptr = shared_ptr[recommenders_cpp.base[float_t, rand_t]](new recommenders_cpp.highest_lower_bound[float_t, rand_t](delta))
+		self.attach(bandit)
+
+
+cdef class highest_pmax(base):
+	""" recommends the arm with the highest p_max
+	
+	The recommendation only changes when the p_max values of the bandit are
+	updated (update_p_max, a pmax_scheduler or set_background_pmax). The
+	recommendation distribution is p_max itself.
+	
+	Parameters
+	----------
+	bandit : multibeep.bandits.base
+		the bandit to follow
+	"""
+	def __init__(self, bandits.base bandit not None):
+		self.thisptr = shared_ptr[recommenders_cpp.base[float_t, rand_t]](new recommenders_cpp.highest_pmax[float_t, rand_t]())
+		self.attach(bandit)
+
+
+cdef class top_k(base):
+	""" ranks the active arms by their estimated mean or a lower confidence bound
+	
+	The ranking is updated only for the pulled arm, so top_identifiers(k)
+	is an incremental alternative to bandits.base.sort_active_arms_by_mean
+	that leaves the order of the arms in the bandit untouched. Deactivated
+	arms drop out of the ranking.
+	
+	Parameters
+	----------
+	bandit : multibeep.bandits.base
+		the bandit to follow
+	delta : double or None
+		None ranks by the estimated mean, otherwise by the delta/2 quantile
+		of the posterior, see multibeep.util.posterior_class.support
+	"""
+	def __init__(self, bandits.base bandit not None, delta = None):
+		if delta is None:
+			self.thisptr = shared_ptr[recommenders_cpp.base[float_t, rand_t]](new recommenders_cpp.top_k[float_t, rand_t]())
+		else:
+			self.thisptr = shared_ptr[recommenders_cpp.base[float_t, rand_t]](new recommenders_cpp.top_k[float_t, rand_t](<float_t> delta))
+		self.attach(bandit)
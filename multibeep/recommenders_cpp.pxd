@@ -0,0 +1,45 @@
+import cython
+
+from libcpp cimport bool
+from libcpp.vector cimport vector
+from libcpp.string cimport string
+
+from typedefs cimport *
+
+
+####################################################################
+# recommender section
+####################################################################
+
+cdef extern from "multibeep/recommender/recommender.hpp" namespace "multibeep::recommender":
+	cdef cppclass base[num_t, rng_t]:
+		string get_ident()
+		bool has_recommendation() const
+		unsigned int best_identifier() except +
+		num_t best_score() const
+		vector[unsigned int] top_identifiers(unsigned int) const
+		unsigned int number_of_ranked_arms() const
+		num_t score_by_identifier(unsigned int) except +
+		vector[num_t] recommendation_distribution() const
+		num_t instantaneous_regret() const
+
+cdef extern from "multibeep/recommender/highest_mean.hpp" namespace "multibeep::recommender":
+	cdef cppclass highest_mean[num_t, rng_t](base[num_t, rng_t]):
+		highest_mean()
+
+cdef extern from "multibeep/recommender/most_pulled.hpp" namespace "multibeep::recommender":
+	cdef cppclass most_pulled[num_t, rng_t](base[num_t, rng_t]):
+		most_pulled()
+
+cdef extern from "multibeep/recommender/highest_lower_bound.hpp" namespace "multibeep::recommender":
+	cdef cppclass highest_lower_bound[num_t, rng_t](base[num_t, rng_t]):
+		highest_lower_bound(num_t)
+
+cdef extern from "multibeep/recommender/highest_pmax.hpp" namespace "multibeep::recommender":
+	cdef cppclass highest_pmax[num_t, rng_t](base[num_t, rng_t]):
+		highest_pmax()
+
+cdef extern from "multibeep/recommender/top_k.hpp" namespace "multibeep::recommender":
+	cdef cppclass top_k[num_t, rng_t](base[num_t, rng_t]):
+		top_k()
+		top_k(num_t)
@@ -1,5 +1,6 @@
 import cython
 from libcpp.memory cimport shared_ptr
+from libcpp.vector cimport vector
 
 
 import numpy as np
@@ -22,3 +23,17 @@ cdef class posterior_class:
 
 cdef class gaussian_posterior(posterior_class):
 	pass
+
+
+cdef class pull_log:
+	cdef shared_ptr[util_cpp.pull_log[float_t]] thisptr
+
+
+cdef class event_ring:
+	cdef shared_ptr[util_cpp.event_ring[float_t]] thisptr
+	cdef vector[util_cpp.event[float_t]] buffer
+	cdef size_t position, num_buffered
+
+
+cdef class data_matrix:
+	cdef shared_ptr[util_cpp.data_matrix[float_t]] thisptr
@@ -1,5 +1,9 @@
 cimport numpy as np
 import numpy as np
+from cython.operator cimport dereference as deref
+from libcpp cimport bool
+from libcpp.vector cimport vector
+from cpython.ref cimport Py_INCREF, Py_DECREF
 from typedefs cimport *
 
 
@@ -23,6 +27,30 @@ cdef class rng_class:
 	cdef shared_ptr[rand_t] get_shared_ptr(self):
 		return(self.thisptr)
 
+	def get_state(self):
+		""" the complete state of the generator as bytes, see set_state"""
+		cdef util_cpp.writer w
+		w.write_rng(deref(self.thisptr))
+		cdef bytes state = w.data()
+		return(state)
+
+	def set_state(self, const unsigned char[::1] state):
+		""" continues with the state returned by get_state
+		
+		All arms and policies using this generator are affected.
+		"""
+		cdef util_cpp.reader * r = new util_cpp.reader(<const char*> &state[0] if state.shape[0] > 0 else NULL, state.shape[0])
+		try:
+			r.read_rng(deref(self.thisptr))
+		finally:
+			del r
+
+	def __reduce__(self):
+		return(rng_class, (0,), self.get_state())
+
+	def __setstate__(self, state):
+		self.set_state(state)
+
 
 cdef class posterior_class:
 	""" base class for all posteriors"""
@@ -116,3 +144,297 @@ cdef class gaussian_posterior(posterior_class):
 			self.thisptr = shared_ptr[util_cpp.base[float_t, rand_t]] (NULL)
 			self.tmpptr = NULL
 			
+
+
+
+cdef void release_array(void *obj) with gil:
+	# the last arm viewing the array is gone
+	Py_DECREF(<object> obj)
+
+
+cdef class data_matrix:
+	""" read-only, column-major matrix shared by many data arms without copying it
+	
+	Every column contains the values of one arm. The mean and variance of all
+	columns are computed once, in parallel. The matrix (and the underlying
+	memory) stays alive as long as any arm uses it.
+	
+	Parameters
+	----------
+	data : numpy.ndarray (1d or 2d)
+		the values, a 1d array is treated as a single column. The array is
+		viewed directly if it is a Fortran ordered array of doubles, otherwise
+		one copy is made. It must not be modified afterwards.
+	num_threads : unsigned int
+		number of threads computing the column statistics. Default is 0, which means one per core.
+	"""
+	def __init__(self, data, unsigned int num_threads = 0):
+		if np.ndim(data) == 1:
+			data = np.reshape(data, (-1, 1))
+		cdef np.ndarray[float_t, ndim=2, mode='fortran'] d = np.asfortranarray(data, dtype=np.double)
+		if d.shape[0] == 0 or d.shape[1] == 0:
+			raise ValueError("the matrix must not be empty")
+		# the C++ matrix owns one reference, released by release_array
+		Py_INCREF(d)
+		self.thisptr = shared_ptr[util_cpp.data_matrix[float_t]] (new util_cpp.data_matrix[float_t](&d[0,0], d.shape[0], d.shape[1], <void*> d, &release_array, num_threads))
+
+	@staticmethod
+	def from_file(filename, unsigned int num_rows, unsigned int num_columns, size_t offset = 0, unsigned int num_threads = 0):
+		""" memory maps a binary file of doubles in column-major order
+		
+		Parameters
+		----------
+		filename : bytes
+			the file to map
+		num_rows : unsigned int
+			number of values per column
+		num_columns : unsigned int
+			number of columns
+		offset : unsigned int
+			position of the first value in bytes, e.g. to skip a header
+		num_threads : unsigned int
+			number of threads computing the column statistics. Default is 0, which means one per core.
+		"""
+		cdef data_matrix m = data_matrix.__new__(data_matrix)
+		m.thisptr = util_cpp.data_matrix[float_t].map_file(filename, num_rows, num_columns, offset, num_threads)
+		return(m)
+
+	@staticmethod
+	def from_csv(filename, delimiter = b',', unsigned int skip_columns = 0, bool header = True,
+				float_t missing_value = np.nan, float_t cutoff = np.inf, float_t cutoff_value = np.nan,
+				float_t scale = 1, unsigned int num_threads = 0):
+		""" reads a CSV file with one row per instance and one column per arm
+		
+		The values are written directly into one column-major buffer, without
+		an intermediate row-major copy.
+		
+		Parameters
+		----------
+		filename : bytes
+			the CSV file
+		delimiter : bytes
+			single character separating the fields. Default is b','.
+		skip_columns : unsigned int
+			number of leading columns to ignore, e.g. instance names. Default is 0.
+		header : bool
+			whether the first row contains the column names. Default is True.
+		missing_value : float
+			replaces empty or unparsable fields. Default is NaN.
+		cutoff : float
+			values >= cutoff are replaced by cutoff_value, e.g. for timeouts. Default is inf.
+		cutoff_value : float
+			see cutoff
+		scale : float
+			all values (after the substitutions) are multiplied by it, e.g. -1 to turn runtimes into rewards. Default is 1.
+		num_threads : unsigned int
+			number of threads computing the column statistics. Default is 0, which means one per core.
+		"""
+		cdef util_cpp.substitution[float_t] *subs = new util_cpp.substitution[float_t](missing_value, cutoff, cutoff_value, scale)
+		cdef data_matrix m = data_matrix.__new__(data_matrix)
+		try:
+			m.thisptr = util_cpp.read_csv[float_t](filename, (<bytes> delimiter)[0], skip_columns, header, deref(subs), num_threads)
+		finally:
+			del subs
+		return(m)
+
+	@staticmethod
+	def from_binary(filename, unsigned int num_threads = 0):
+		""" memory maps a file written by to_binary
+		
+		Parameters
+		----------
+		filename : bytes
+			the file
+		num_threads : unsigned int
+			number of threads computing the column statistics. Default is 0, which means one per core.
+		"""
+		cdef data_matrix m = data_matrix.__new__(data_matrix)
+		m.thisptr = util_cpp.read_binary[float_t](filename, num_threads)
+		return(m)
+
+	def to_binary(self, filename):
+		""" stores the matrix and the column names in a compact binary columnar format that can be memory mapped
+		
+		Parameters
+		----------
+		filename : bytes
+			the file
+		"""
+		util_cpp.write_binary[float_t](filename, deref(self.thisptr))
+
+	@property
+	def names(self):
+		""" the names of the columns, e.g. from the header of a file"""
+		return([self.thisptr.get().column_name(j) for j in range(self.thisptr.get().number_of_columns())])
+
+	@names.setter
+	def names(self, names):
+		self.thisptr.get().set_column_names(names)
+
+	@property
+	def shape(self):
+		return((self.thisptr.get().number_of_rows(), self.thisptr.get().number_of_columns()))
+
+	def to_numpy(self):
+		""" a copy of the values as a Fortran ordered array with one column per arm"""
+		cdef unsigned int rows = self.thisptr.get().number_of_rows(), cols = self.thisptr.get().number_of_columns(), i, j
+		cdef np.ndarray[float_t, ndim=2, mode='fortran'] d = np.empty((rows, cols), dtype=np.double, order='F')
+		cdef const float_t * c
+		for j in range(cols):
+			c = self.thisptr.get().column(j)
+			for i in range(rows):
+				d[i,j] = c[i]
+		return(d)
+
+	def __reduce__(self):
+		# memory mapped matrices are copied, too
+		return(data_matrix, (self.to_numpy(),), self.names)
+
+	def __setstate__(self, names):
+		self.names = names
+
+	def column_means(self):
+		return(np.array([self.thisptr.get().column_mean(j) for j in range(self.thisptr.get().number_of_columns())]))
+
+	def column_variances(self):
+		return(np.array([self.thisptr.get().column_variance(j) for j in range(self.thisptr.get().number_of_columns())]))
+
+
+
+cdef class pull_log:
+	""" append-only binary log of all pulls of one or more bandits
+	
+	Every pull is recorded with its index, the arm's identifier, the reward
+	and a timestamp (nanoseconds since the epoch). Records are buffered and
+	written in blocks, see multibeep.bandits.base.set_pull_log.
+	
+	Parameters
+	----------
+	filename : bytes
+		the log file
+	buffer_size : unsigned int
+		number of records kept in memory before they are written. Default is 4096.
+	append : bool
+		continue an existing log instead of overwriting it. Default is False.
+	"""
+	def __init__(self, filename, unsigned int buffer_size = 4096, bool append = False):
+		self.thisptr = shared_ptr[util_cpp.pull_log[float_t]] (new util_cpp.pull_log[float_t](filename, buffer_size, append))
+
+	def flush(self):
+		""" writes all buffered records"""
+		self.thisptr.get().flush()
+
+
+event_type_names = ('arm_added', 'arm_pulled', 'arm_deactivated', 'arm_reactivated', 'pmax_updated')
+
+
+cdef class event_ring:
+	""" lock-free queue of the events of a bandit, see multibeep.bandits.base.set_event_ring
+	
+	The bandit pushes an event whenever an arm is added, pulled, deactivated
+	or reactivated and whenever p_max is updated. If the events are not
+	consumed fast enough, new ones are dropped instead of slowing down the
+	bandit. Iterating yields the events available so far as tuples
+	(num_pulls, type, identifier, value), where type is one of
+	event_type_names and value is the reward of a pull (NaN otherwise).
+	The events are copied out in chunks without holding the GIL, so a
+	Python thread can observe a bandit played in another thread.
+	
+	Parameters
+	----------
+	capacity : unsigned int
+		maximum number of events kept, rounded up to a power of two. Default is 4096.
+	"""
+	def __init__(self, unsigned int capacity = 4096):
+		self.thisptr = shared_ptr[util_cpp.event_ring[float_t]] (new util_cpp.event_ring[float_t](capacity))
+		self.buffer.resize(256)
+		self.position = 0
+		self.num_buffered = 0
+
+	def __iter__(self):
+		return(self)
+
+	def __next__(self):
+		cdef util_cpp.event_ring[float_t] * r = self.thisptr.get()
+		if self.position == self.num_buffered:
+			with nogil:
+				self.num_buffered = r.pop(self.buffer.data(), self.buffer.size())
+			self.position = 0
+			if self.num_buffered == 0:
+				raise StopIteration
+		cdef util_cpp.event[float_t] * e = &self.buffer[self.position]
+		self.position += 1
+		return((e.num_pulls, event_type_names[e.type], e.identifier, e.value))
+
+	def drain(self, size_t max_events = 1 << 16):
+		""" removes up to max_events of the events available at once
+		
+		Returns
+		-------
+		dict
+			numpy arrays 'num_pulls', 'type' (index into event_type_names), 'identifier' and 'value'
+		"""
+		cdef vector[util_cpp.event[float_t]] events
+		cdef size_t n = self.num_buffered - self.position, i
+		n = min(n, max_events)
+		events.assign(self.buffer.begin() + self.position, self.buffer.begin() + self.position + n)
+		self.position += n
+		cdef util_cpp.event_ring[float_t] * r = self.thisptr.get()
+		# events pushed after this point are left for the next call
+		events.resize(min(max_events, n + r.size()))
+		with nogil:
+			n += r.pop(events.data() + n, events.size() - n)
+		cdef np.ndarray[np.uint64_t, ndim=1] num_pulls = np.empty(n, dtype=np.uint64)
+		cdef np.ndarray[np.uint32_t, ndim=1] types = np.empty(n, dtype=np.uint32)
+		cdef np.ndarray[np.uint32_t, ndim=1] identifier = np.empty(n, dtype=np.uint32)
+		cdef np.ndarray[float_t, ndim=1] value = np.empty(n, dtype=np.double)
+		for i in range(n):
+			num_pulls[i] = events[i].num_pulls
+			types[i] = events[i].type
+			identifier[i] = events[i].identifier
+			value[i] = events[i].value
+		return({'num_pulls': num_pulls, 'type': types, 'identifier': identifier, 'value': value})
+
+	def __len__(self):
+		""" number of events not consumed yet"""
+		return(self.thisptr.get().size() + self.num_buffered - self.position)
+
+	@property
+	def capacity(self):
+		return(self.thisptr.get().capacity())
+
+	@property
+	def dropped(self):
+		""" number of events dropped because the ring was full"""
+		return(self.thisptr.get().dropped())
+
+
+def read_pull_log(filename):
+	""" reads all records of a pull log
+	
+	Parameters
+	----------
+	filename : bytes
+		the log file
+	
+	Returns
+	-------
+	dict
+		numpy arrays 'pull_index', 'identifier', 'reward' and 'timestamp'
+	"""
+	cdef util_cpp.pull_records[float_t] records = util_cpp.read_pull_log[float_t](filename)
+	cdef size_t n = records.size(), i
+	cdef np.ndarray[np.uint64_t, ndim=1] pull_index = np.empty(n, dtype=np.uint64)
+	cdef np.ndarray[np.uint32_t, ndim=1] identifier = np.empty(n, dtype=np.uint32)
+	cdef np.ndarray[float_t, ndim=1] reward = np.empty(n, dtype=np.double)
+	cdef np.ndarray[np.int64_t, ndim=1] timestamp = np.empty(n, dtype=np.int64)
+	for i in range(n):
+		pull_index[i] = records.pull_index[i]
+		identifier[i] = records.identifier[i]
+		reward[i] = records.reward[i]
+		timestamp[i] = records.timestamp[i]
+	return({'pull_index': pull_index, 'identifier': identifier, 'reward': reward, 'timestamp': timestamp})
+
+
+# whether the bandits and policies can collect stats, see multibeep.bandits.base.enable_stats
+stats_compiled_in = util_cpp.compiled_in
@@ -3,6 +3,9 @@ import cython
 from libcpp cimport bool
 from libcpp.pair cimport pair
 from libcpp.memory cimport shared_ptr
+from libcpp.string cimport string
+from libcpp.vector cimport vector
+from libc.stdint cimport uint64_t, int64_t
 
 
 # TODO: check for const methods in the c++ code and add the keyword here!
@@ -30,3 +33,100 @@ cdef extern from "multibeep/util/posteriors.hpp" namespace "multibeep::util::pos
 	
 	cdef cppclass gaussian_posterior[num_t, rng_t] (base[num_t, rng_t]):
 		gaussian_posterior (num_t, num_t) except+
+
+
+ctypedef void (*python_release)(void*)
+
+cdef extern from "multibeep/util/serialization.hpp" namespace "multibeep::util::serialization":
+	cdef cppclass writer:
+		writer()
+		void write_rng[T](const T &)
+		const string & data()
+
+	cdef cppclass reader:
+		reader(const char *, size_t)
+		void read_rng[T](T &) except +
+
+
+cdef extern from "multibeep/util/data_matrix.hpp" namespace "multibeep::util":
+	cdef cppclass data_matrix[num_t]:
+		data_matrix(const num_t *, unsigned int, unsigned int, void *, python_release, unsigned int) except +
+		@staticmethod
+		shared_ptr[data_matrix[num_t]] map_file(const string &, unsigned int, unsigned int, size_t, unsigned int) except +
+		unsigned int number_of_rows()
+		unsigned int number_of_columns()
+		const num_t * column(unsigned int)
+		num_t column_mean(unsigned int) except +
+		num_t column_variance(unsigned int) except +
+		string column_name(unsigned int) except +
+		void set_column_names(const vector[string] &) except +
+
+cdef extern from "multibeep/util/pull_log.hpp" namespace "multibeep::util":
+	cdef cppclass pull_records[num_t]:
+		vector[uint64_t] pull_index
+		vector[unsigned int] identifier
+		vector[num_t] reward
+		vector[int64_t] timestamp
+		size_t size()
+
+	cdef cppclass pull_log[num_t]:
+		pull_log(const string &, unsigned int, bool) except +
+		void flush() except +
+
+	pull_records[num_t] read_pull_log[num_t](const string &) except +
+
+cdef extern from "multibeep/util/event_ring.hpp" namespace "multibeep::util":
+	cdef cppclass event[num_t]:
+		uint64_t num_pulls
+		unsigned int type
+		unsigned int identifier
+		num_t value
+
+	cdef cppclass event_ring[num_t]:
+		event_ring(unsigned int) except +
+		size_t pop(event[num_t] *, size_t) nogil
+		unsigned int capacity()
+		size_t size()
+		uint64_t dropped()
+
+cdef extern from "multibeep/util/background_pmax.hpp" namespace "multibeep::util::pmax":
+	cdef cppclass background_worker[num_t, rng_t]:
+		background_worker(num_t, unsigned int, bool) except +
+		bool consider_inactive() const
+		bool is_busy() const
+		uint64_t latest_version() const
+		void wait() nogil const
+
+cdef extern from "multibeep/util/latency_histogram.hpp" namespace "multibeep::util":
+	cdef cppclass latency_histogram:
+		uint64_t count() const
+		double mean_seconds() const
+		uint64_t quantile_ns(double) const
+
+cdef extern from "multibeep/util/instrumentation.hpp" namespace "multibeep::util::instrumentation":
+	bool compiled_in
+
+	cdef struct bandit_stats:
+		uint64_t num_pulls
+		uint64_t pull_ns
+		uint64_t num_arm_info_updates
+		uint64_t arm_info_update_ns
+		uint64_t num_posterior_allocations
+		uint64_t num_pmax_updates
+		uint64_t pmax_ns
+		uint64_t num_pmax_fast_paths
+		uint64_t num_pmax_integrals
+		uint64_t num_quadrature_nodes
+		uint64_t num_posterior_evaluations
+
+	cdef struct policy_stats:
+		uint64_t num_selections
+		uint64_t selection_ns
+
+cdef extern from "multibeep/util/columnar_loader.hpp" namespace "multibeep::util::columnar":
+	cdef cppclass substitution[num_t]:
+		substitution(num_t, num_t, num_t, num_t)
+
+	shared_ptr[data_matrix[num_t]] read_csv[num_t](const string &, char, unsigned int, bool, substitution[num_t], unsigned int) except +
+	shared_ptr[data_matrix[num_t]] read_binary[num_t](const string &, unsigned int) except +
+	void write_binary[num_t](const string &, const data_matrix[num_t] &) except +
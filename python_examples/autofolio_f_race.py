@@ -14,61 +14,22 @@ rng = mb.util.rng_class(51)
 N_init=40
 N = 2000
 delta = 0.001
-bandit = mb.bandits.empirical_bandit()
+bandit = mb.bandits.empirical()
 
 
 
-with open('../data/autofolio.csv', 'r') as f:
-    first_line = f.readline()
-
-
-data = -np.loadtxt('../data/autofolio.csv', skiprows=1, delimiter=',', converters= {0: lambda s: 0})[:,1:]
-
-
-np.random.shuffle(data)
-
+# runtimes of every algorithm (column) on every instance (row), timeouts are
+# counted as 1200 and everything is negated to turn runtimes into rewards
+data = mb.util.data_matrix.from_csv(b'../data/autofolio.csv', skip_columns=1,
+				cutoff=12000, cutoff_value=1200, scale=-1)
 print(data.shape)
-data[data == -12000] = -1200
-
-names = first_line.strip().split(',')[1:]
-names = list(map(lambda s: bytes(s, 'utf-8'), names))
-
-
-arms = []
-
-for i in range(data.shape[1]):
-	arms.append(mb.arms.data(data[:,i], names[i], rng, True))
-
-
-
-
-
-
-[bandit.add_arm(a) for a in  arms]
-print( list(bandit.pull_by_index(i) for i in range(len(arms))))
-
-bandit.min_pull_arms(N_init)
-
-print([ bandit[i].num_pulls for i in range(bandit.number_of_active_arms())])
-print([ bandit[i].is_active for i in range(bandit.number_of_active_arms())])
-
-# create a policy that will play the bandit
-#policy = mb.policies.random(bandit, rng)
-#policy = mb.policies.UCB_p(bandit, rng, 2)
-policy = mb.policies.prob_match(bandit, rng)
-
-
-
-
-print([ bandit[i].num_pulls for i in range(bandit.number_of_active_arms())])
-print([ bandit[i].is_active for i in range(bandit.number_of_active_arms())])
 
+names = data.names
+bandit.add_data_arms(data, rng)
 
-for i in range(N//10):
-	policy.play_n_rounds(10)
-	bandit.deactivate_by_confidence_gap(delta)
-	if bandit.number_of_active_arms() == 1:
-		break
+# the race pulls every arm once per round, i.e. every instance is a block
+policy = mb.policies.f_race(bandit, 0.05, N_init)
+policy.play_n_rounds(N)
 
 print("finished playing")
 
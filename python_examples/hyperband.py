@@ -23,8 +23,7 @@ variances = np.random.rand(1024)/10
 
 print(means,variances)
 
-arms = [mb.arms.normal(m,v,rng) for (m,v) in zip(means, variances)]
-[bandit.add_arm(a) for a in arms]
+bandit.add_normal_arms(means, variances, rng)
 
 
 # create a policy that will play the bandit
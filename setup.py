@@ -29,6 +29,7 @@ extensions = cythonize( list(
 					('multibeep.arms',		['multibeep/arms.pyx']),
 					('multibeep.bandits',	['multibeep/bandits.pyx']),
 					('multibeep.policies',	['multibeep/policies.pyx']),
+					('multibeep.recommenders',	['multibeep/recommenders.pyx']),
 				]
 
 		)), compiler_directives={'embedsignature':True})
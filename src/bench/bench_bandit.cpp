@@ -0,0 +1,211 @@
+/* Microbenchmarks of the bandits' hot paths: adding arms, pulling, updating
+ * the arm infos, accessing them and computing p_max. All seeds are fixed.
+ */
+
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "multibeep/arm/normal.hpp"
+#include "multibeep/arm/bernoulli.hpp"
+#include "multibeep/arm/exponential.hpp"
+#include "multibeep/arm/data.hpp"
+#include "multibeep/bandit/empirical_bandits.hpp"
+#include "multibeep/bandit/posterior_bandit.hpp"
+
+#include "bench_util.hpp"
+
+
+typedef double num_t;
+typedef std::mt19937 rng_t;
+typedef std::shared_ptr<multibeep::arms::base<num_t, rng_t> > arm_ptr_t;
+
+
+std::vector<arm_ptr_t> normal_arms(unsigned int K, std::shared_ptr<rng_t> rng_ptr, num_t spread = 1){
+	std::vector<arm_ptr_t> arms;
+	for (auto k=0u; k < K; ++k)
+		arms.emplace_back(new multibeep::arms::normal_arm<num_t, rng_t>(spread*k/K, 1, rng_ptr));
+	return(arms);
+}
+
+
+template <typename bandit_t, typename ... T>
+std::shared_ptr<bandit_t> filled_bandit(unsigned int K, unsigned int pulls_per_arm, std::shared_ptr<rng_t> rng_ptr, num_t spread, T ... t){
+	auto b = std::make_shared<bandit_t>(t...);
+	b->add_arms(normal_arms(K, rng_ptr, spread));
+	b->min_pull_arms(pulls_per_arm);
+	return(b);
+}
+
+
+void bench_add_arm(bench_reporter &rep){
+	auto rng_ptr = std::make_shared<rng_t>(1234u);
+	for (auto K: {16u, 256u, 4096u}){
+		auto arms = normal_arms(K, rng_ptr);
+		rep.run("add_arm", "K=" + std::to_string(K), K, [&] (){
+			multibeep::bandits::empirical<num_t, rng_t> b;
+			for (auto &a: arms) b.add_arm(a);
+			do_not_optimize(b.number_of_arms());
+		});
+		rep.run("add_arms", "K=" + std::to_string(K), K, [&] (){
+			multibeep::bandits::empirical<num_t, rng_t> b;
+			b.add_arms(arms);
+			do_not_optimize(b.number_of_arms());
+		});
+	}
+}
+
+
+void bench_pull_by_index(bench_reporter &rep){
+	auto rng_ptr = std::make_shared<rng_t>(1234u);
+	std::vector<num_t> values(1000);
+	std::normal_distribution<num_t> n(0,1);
+	for (auto &v: values) v = n(*rng_ptr);
+
+	std::vector<std::pair<std::string, arm_ptr_t> > arms {
+		{"normal",				arm_ptr_t(new multibeep::arms::normal_arm<num_t, rng_t>(0, 1, rng_ptr))},
+		{"bernoulli",			arm_ptr_t(new multibeep::arms::bernoulli_arm<num_t, rng_t>(0.5, rng_ptr))},
+		{"exponential",			arm_ptr_t(new multibeep::arms::exponential_arm<num_t, rng_t>(1, rng_ptr))},
+		{"data_sequential",		arm_ptr_t(new multibeep::arms::data_arm_sequential<num_t, rng_t>(values, "data", rng_ptr))},
+		{"data_bootstrap",		arm_ptr_t(new multibeep::arms::data_arm_bootstrap<num_t, rng_t>(values, "data", rng_ptr))}
+	};
+
+	const unsigned int N = 100000;
+	for (auto &a: arms){
+		// a new bandit per repetition, so the reward history does not grow without bounds
+		rep.run("pull_by_index", "arm=" + a.first, N, [&] (){
+			multibeep::bandits::empirical<num_t, rng_t> b;
+			b.add_arm(a.second);
+			num_t sum = 0;
+			for (auto i=0u; i < N; ++i) sum += b.pull_by_index(0);
+			do_not_optimize(sum);
+		});
+	}
+}
+
+
+template <typename bandit_t, typename ... T>
+void bench_update_arm_info_for(bench_reporter &rep, const std::string &name, T ... t){
+	auto rng_ptr = std::make_shared<rng_t>(1234u);
+	auto b = filled_bandit<bandit_t>(16, 10, rng_ptr, 1, t...);
+	std::normal_distribution<num_t> n(0,1);
+
+	const unsigned int N = 20000;
+	// the reward marks the arm dirty without pulling it, the update itself is what is timed
+	rep.run("update_arm_info", "bandit=" + name, N, [&] (){
+		for (auto i=0u; i < N; ++i){
+			b->add_reward_by_identifier(0, n(*rng_ptr));
+			b->update_arm_info(0);
+		}
+		do_not_optimize((*b)[0].estimated_mean);
+	});
+}
+
+
+void bench_update_arm_info(bench_reporter &rep){
+	bench_update_arm_info_for<multibeep::bandits::empirical<num_t, rng_t> >(rep, "empirical");
+	bench_update_arm_info_for<multibeep::bandits::posterior<num_t, rng_t> >(rep, "posterior");
+	bench_update_arm_info_for<multibeep::bandits::last_n_pulls<num_t, rng_t> >(rep, "last_n_pulls", 16u);
+}
+
+
+void bench_operator_access(bench_reporter &rep){
+	auto rng_ptr = std::make_shared<rng_t>(1234u);
+	for (auto K: {16u, 1024u}){
+		auto b = filled_bandit<multibeep::bandits::empirical<num_t, rng_t> >(K, 10, rng_ptr, 1);
+		const unsigned int N = 100000;
+		// all arm infos are up to date
+		rep.run("operator[]", "K=" + std::to_string(K) + ";clean", N, [&] (){
+			num_t sum = 0;
+			for (auto i=0u; i < N; ++i) sum += (*b)[i%K].estimated_mean;
+			do_not_optimize(sum);
+		});
+		// one pull before every access, so one arm info is dirty
+		rep.run("operator[]", "K=" + std::to_string(K) + ";after_pull", N, [&] (){
+			num_t sum = 0;
+			for (auto i=0u; i < N; ++i){
+				b->pull_by_index(i%K);
+				sum += (*b)[i%K].estimated_mean;
+			}
+			do_not_optimize(sum);
+		});
+	}
+}
+
+
+// the posteriors of all active arms, for timing the generic p_max path against the family fast paths
+template <typename bandit_t>
+multibeep::util::pmax::post_vector_t<num_t, rng_t> active_posteriors(bandit_t &b){
+	multibeep::util::pmax::post_vector_t<num_t, rng_t> posts;
+	for (auto i=0u; i < b.number_of_active_arms(); ++i)
+		posts.push_back(b[i].posterior);
+	return(posts);
+}
+
+
+void bench_update_p_max(bench_reporter &rep){
+	auto rng_ptr = std::make_shared<rng_t>(1234u);
+	for (auto K: {4u, 16u, 64u}){
+		// gaussian posteriors
+		auto b = filled_bandit<multibeep::bandits::empirical<num_t, rng_t> >(K, 10, rng_ptr, 1);
+		// beta posteriors
+		auto bb = std::make_shared<multibeep::bandits::posterior<num_t, rng_t> >();
+		for (auto k=0u; k < K; ++k)
+			bb->add_arm(arm_ptr_t(new multibeep::arms::bernoulli_arm<num_t, rng_t>(0.2 + 0.6*k/K, rng_ptr)));
+		bb->min_pull_arms(50);
+
+		auto posts = active_posteriors(*b);
+		auto bposts = active_posteriors(*bb);
+		for (auto GL: {16u, 64u, 256u}){
+			auto params = "K=" + std::to_string(K) + ";GL=" + std::to_string(GL);
+			rep.run("update_p_max", params, 1, [&] (){
+				b->update_p_max(false, 0.01, GL);
+				do_not_optimize((*b)[0].p_max);
+			});
+			rep.run("update_p_max_generic", params, 1, [&] (){
+				do_not_optimize(multibeep::util::pmax::compute_pmax_generic<num_t, rng_t>(posts, 0.01, GL)[0]);
+			});
+			rep.run("update_p_max_beta", params, 1, [&] (){
+				bb->update_p_max(false, 0.01, GL);
+				do_not_optimize((*bb)[0].p_max);
+			});
+			rep.run("update_p_max_beta_generic", params, 1, [&] (){
+				do_not_optimize(multibeep::util::pmax::compute_pmax_generic<num_t, rng_t>(bposts, 0.01, GL)[0]);
+			});
+		}
+	}
+}
+
+
+void bench_deactivate_by_confidence_gap(bench_reporter &rep){
+	auto rng_ptr = std::make_shared<rng_t>(1234u);
+	for (auto K: {16u, 1024u}){
+		// identical means: no arm gets deactivated, so every call does the same work
+		auto b = filled_bandit<multibeep::bandits::empirical<num_t, rng_t> >(K, 10, rng_ptr, 0);
+		const unsigned int N = 100;
+		rep.run("deactivate_by_confidence_gap", "K=" + std::to_string(K), N, [&] (){
+			for (auto i=0u; i < N; ++i)
+				b->deactivate_by_confidence_gap(0.01, false);
+			do_not_optimize(b->number_of_active_arms());
+		});
+	}
+}
+
+
+int main(int argc, char ** argv){
+	try{
+		bench_reporter rep(argc, argv);
+		bench_add_arm(rep);
+		bench_pull_by_index(rep);
+		bench_update_arm_info(rep);
+		bench_operator_access(rep);
+		bench_update_p_max(rep);
+		bench_deactivate_by_confidence_gap(rep);
+	}
+	catch (const std::exception &e){
+		std::cerr << e.what() << std::endl;
+		return(1);
+	}
+	return(0);
+}
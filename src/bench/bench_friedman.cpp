@@ -0,0 +1,76 @@
+/* Microbenchmarks of the Friedman test used by F-Race: the batch test over
+ * complete reward vectors and the incremental version adding single rounds.
+ * All seeds are fixed.
+ */
+
+#include <random>
+#include <string>
+#include <vector>
+
+#include "multibeep/util/friedman_test.hpp"
+
+#include "bench_util.hpp"
+
+
+typedef double num_t;
+
+
+std::vector<std::vector<num_t> > random_rewards(unsigned int m, unsigned int k, unsigned int seed){
+	std::mt19937 rng(seed);
+	std::normal_distribution<num_t> n(0,1);
+	std::vector<std::vector<num_t> > rewards(m, std::vector<num_t>(k));
+	for (auto j=0u; j < m; ++j)
+		for (auto &r: rewards[j]) r = n(rng) + num_t(j)/m;
+	return(rewards);
+}
+
+
+void bench_friedman_test(bench_reporter &rep){
+	for (auto m: {4u, 16u, 64u}){
+		for (auto k: {10u, 100u, 1000u}){
+			auto rewards = random_rewards(m, k, 1234u);
+			std::vector<std::vector<num_t>*> performances;
+			for (auto &r: rewards) performances.push_back(&r);
+
+			rep.run("friedman_test", "m=" + std::to_string(m) + ";k=" + std::to_string(k), 1, [&] (){
+				auto rv = multibeep::util::friedman::friedman_test(performances, num_t(0.05));
+				do_not_optimize(rv.size());
+			});
+		}
+	}
+}
+
+
+void bench_incremental_friedman(bench_reporter &rep){
+	for (auto m: {4u, 16u, 64u}){
+		const unsigned int k = 1000;
+		auto rewards = random_rewards(k, m, 1234u);
+
+		rep.run("incremental_friedman_add_round", "m=" + std::to_string(m), k, [&] (){
+			multibeep::util::friedman::incremental_friedman<num_t> f(m);
+			for (auto &r: rewards) f.add_round(r);
+			do_not_optimize(f.rank_sums().front());
+		});
+
+		multibeep::util::friedman::incremental_friedman<num_t> f(m);
+		for (auto &r: rewards) f.add_round(r);
+		rep.run("incremental_friedman_test", "m=" + std::to_string(m) + ";k=" + std::to_string(k), 1, [&] (){
+			auto rv = f.test(0.05);
+			do_not_optimize(rv.size());
+		});
+	}
+}
+
+
+int main(int argc, char ** argv){
+	try{
+		bench_reporter rep(argc, argv);
+		bench_friedman_test(rep);
+		bench_incremental_friedman(rep);
+	}
+	catch (const std::exception &e){
+		std::cerr << e.what() << std::endl;
+		return(1);
+	}
+	return(0);
+}
@@ -0,0 +1,133 @@
+/* Microbenchmarks of the policies: the cost of selecting the next arm on a
+ * fixed bandit and of playing complete rounds. All seeds are fixed.
+ */
+
+#include <algorithm>
+#include <functional>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "multibeep/arm/normal.hpp"
+#include "multibeep/bandit/empirical_bandits.hpp"
+#include "multibeep/policy/random.hpp"
+#include "multibeep/policy/ucbp.hpp"
+#include "multibeep/policy/prob_match.hpp"
+#include "multibeep/policy/lucb.hpp"
+#include "multibeep/policy/f_race.hpp"
+#include "multibeep/simulation/arms.hpp"
+#include "multibeep/simulation/policies.hpp"
+
+#include "bench_util.hpp"
+
+
+typedef double num_t;
+typedef std::mt19937 rng_t;
+typedef multibeep::bandits::base<num_t, rng_t> bandit_t;
+typedef multibeep::policies::base<num_t, rng_t> policy_t;
+typedef std::function<std::shared_ptr<policy_t> (std::shared_ptr<bandit_t>, std::shared_ptr<rng_t>)> policy_factory_t;
+
+
+std::shared_ptr<bandit_t> normal_bandit(unsigned int K, std::shared_ptr<rng_t> rng_ptr){
+	auto b = std::make_shared<multibeep::bandits::empirical<num_t, rng_t> >();
+	for (auto k=0u; k < K; ++k)
+		b->add_arm(std::make_shared<multibeep::arms::normal_arm<num_t, rng_t> >(num_t(k)/K, 1, rng_ptr));
+	return(b);
+}
+
+
+std::vector<std::pair<std::string, policy_factory_t> > policy_factories(){
+	return {
+		{"random",		[] (std::shared_ptr<bandit_t> b, std::shared_ptr<rng_t> r) {return(std::shared_ptr<policy_t>(new multibeep::policies::random<num_t, rng_t>(b, r)));}},
+		{"UCB_p",		[] (std::shared_ptr<bandit_t> b, std::shared_ptr<rng_t> r) {return(std::shared_ptr<policy_t>(new multibeep::policies::UCB_p<num_t, rng_t>(b, r, 0.01)));}},
+		{"prob_match",	[] (std::shared_ptr<bandit_t> b, std::shared_ptr<rng_t> r) {return(std::shared_ptr<policy_t>(new multibeep::policies::prob_match<num_t, rng_t>(b, r)));}},
+		{"LUCB",		[] (std::shared_ptr<bandit_t> b, std::shared_ptr<rng_t>)   {return(std::shared_ptr<policy_t>(new multibeep::policies::LUCB<num_t, rng_t>(b, 0.05)));}},
+		{"f_race",		[] (std::shared_ptr<bandit_t> b, std::shared_ptr<rng_t>)   {return(std::shared_ptr<policy_t>(new multibeep::policies::f_race<num_t, rng_t>(b, 0.05)));}}
+	};
+}
+
+
+void bench_select_next_arm(bench_reporter &rep){
+	// only the policies whose choice does not depend on the previous one
+	std::vector<std::string> stateless {"random", "UCB_p", "prob_match"};
+
+	for (auto &pf: policy_factories()){
+		if (std::find(stateless.begin(), stateless.end(), pf.first) == stateless.end()) continue;
+		for (auto K: {16u, 256u, 4096u}){
+			auto rng_ptr = std::make_shared<rng_t>(1234u);
+			auto b = normal_bandit(K, rng_ptr);
+			b->min_pull_arms(10);
+			auto p = pf.second(b, rng_ptr);
+
+			const unsigned int N = std::max(10u, 1000000u/K);
+			rep.run("select_next_arm", "policy=" + pf.first + ";K=" + std::to_string(K), N, [&] (){
+				unsigned int sum = 0;
+				for (auto i=0u; i < N; ++i) sum += p->select_next_arm();
+				do_not_optimize(sum);
+			});
+		}
+	}
+}
+
+
+void bench_play_n_rounds(bench_reporter &rep){
+	for (auto &pf: policy_factories()){
+		for (auto K: {16u, 256u}){
+			const unsigned int N = 20*K;
+			// a new bandit per repetition, so every repetition plays the same rounds
+			rep.run("play_n_rounds", "policy=" + pf.first + ";K=" + std::to_string(K), N, [&] (){
+				auto rng_ptr = std::make_shared<rng_t>(1234u);
+				auto b = normal_bandit(K, rng_ptr);
+				auto p = pf.second(b, rng_ptr);
+				p->play_n_rounds(N);
+				do_not_optimize(b->number_of_active_arms());
+			});
+		}
+	}
+}
+
+
+// the same rounds as play_n_rounds, with the compile-time compositions
+void bench_static_play_n_rounds(bench_reporter &rep){
+	typedef multibeep::simulation::empirical<multibeep::simulation::normal_arm<num_t>, num_t, rng_t> static_bandit_t;
+	auto static_bandit = [] (unsigned int K, std::shared_ptr<rng_t> rng_ptr){
+		auto b = std::make_shared<static_bandit_t>(rng_ptr);
+		for (auto k=0u; k < K; ++k)
+			b->add_arm(multibeep::simulation::normal_arm<num_t>(num_t(k)/K, 1));
+		return(b);
+	};
+
+	for (auto K: {16u, 256u}){
+		const unsigned int N = 20*K;
+		rep.run("static_play_n_rounds", "policy=UCB_p;K=" + std::to_string(K), N, [&] (){
+			auto rng_ptr = std::make_shared<rng_t>(1234u);
+			auto b = static_bandit(K, rng_ptr);
+			multibeep::simulation::UCB_p<static_bandit_t> p(b, rng_ptr, 0.01);
+			p.play_n_rounds(N);
+			do_not_optimize(b->number_of_pulls());
+		});
+		rep.run("static_play_n_rounds", "policy=prob_match;K=" + std::to_string(K), N, [&] (){
+			auto rng_ptr = std::make_shared<rng_t>(1234u);
+			auto b = static_bandit(K, rng_ptr);
+			multibeep::simulation::prob_match<static_bandit_t> p(b, rng_ptr);
+			p.play_n_rounds(N);
+			do_not_optimize(b->number_of_pulls());
+		});
+	}
+}
+
+
+int main(int argc, char ** argv){
+	try{
+		bench_reporter rep(argc, argv);
+		bench_select_next_arm(rep);
+		bench_play_n_rounds(rep);
+		bench_static_play_n_rounds(rep);
+	}
+	catch (const std::exception &e){
+		std::cerr << e.what() << std::endl;
+		return(1);
+	}
+	return(0);
+}
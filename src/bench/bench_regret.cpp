@@ -0,0 +1,354 @@
+/* Regret benchmark: plays many independent, seeded bandit problems with every
+ * policy and reports the mean simple and cumulative regret over the number of
+ * pulls, together with the throughput of each policy.
+ *
+ * Every replicate only depends on the seed and its own number, so the output
+ * does not depend on the number of threads.
+ *
+ * usage: bench_regret [--replicates N] [--pulls N] [--arms K] [--threads N]
+ *                     [--seed N] [--points N] [--format csv|json] [--output file]
+ *                     [--problems normal,bernoulli,exponential,data]
+ *                     [--policies random,UCB_p,prob_match,successive_halving]
+ *                     [--data file.csv] [--skip-columns N]
+ */
+
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "multibeep/arm/normal.hpp"
+#include "multibeep/arm/bernoulli.hpp"
+#include "multibeep/arm/exponential.hpp"
+#include "multibeep/arm/data.hpp"
+#include "multibeep/bandit/empirical_bandits.hpp"
+#include "multibeep/policy/random.hpp"
+#include "multibeep/policy/ucbp.hpp"
+#include "multibeep/policy/prob_match.hpp"
+#include "multibeep/policy/successive_halving.hpp"
+#include "multibeep/util/columnar_loader.hpp"
+
+
+typedef double num_t;
+typedef std::mt19937 rng_t;
+typedef std::shared_ptr<multibeep::arms::base<num_t, rng_t> > arm_ptr_t;
+typedef std::vector<std::pair<unsigned int, num_t> > trace_t;
+
+
+struct options{
+	unsigned int replicates = 1000;
+	unsigned int pulls = 1000;
+	unsigned int arms = 16;
+	unsigned int threads = 0;
+	unsigned int seed = 1;
+	unsigned int points = 10;
+	unsigned int skip_columns = 0;
+	std::string format = "csv";
+	std::string output;
+	std::string data;
+	std::vector<std::string> problems {"normal", "bernoulli", "exponential", "data"};
+	std::vector<std::string> policies {"random", "UCB_p", "prob_match", "successive_halving"};
+};
+
+
+std::vector<std::string> split_list(const std::string &s){
+	std::vector<std::string> v;
+	std::stringstream ss(s);
+	std::string item;
+	while (std::getline(ss, item, ','))
+		if (!item.empty()) v.push_back(item);
+	return(v);
+}
+
+
+options parse(int argc, char ** argv){
+	options o;
+	for (int i=1; i < argc; ++i){
+		std::string arg(argv[i]);
+		if (i+1 >= argc)
+			throw std::invalid_argument("Missing value for " + arg);
+		std::string value(argv[++i]);
+
+		if		(arg == "--replicates")		o.replicates = std::stoul(value);
+		else if	(arg == "--pulls")			o.pulls = std::stoul(value);
+		else if	(arg == "--arms")			o.arms = std::stoul(value);
+		else if	(arg == "--threads")		o.threads = std::stoul(value);
+		else if	(arg == "--seed")			o.seed = std::stoul(value);
+		else if	(arg == "--points")			o.points = std::stoul(value);
+		else if	(arg == "--skip-columns")	o.skip_columns = std::stoul(value);
+		else if	(arg == "--format")			o.format = value;
+		else if	(arg == "--output")			o.output = value;
+		else if	(arg == "--data")			o.data = value;
+		else if	(arg == "--problems")		o.problems = split_list(value);
+		else if	(arg == "--policies")		o.policies = split_list(value);
+		else throw std::invalid_argument("Unknown option " + arg);
+	}
+	if ((o.format != "csv") && (o.format != "json"))
+		throw std::invalid_argument("The format has to be csv or json");
+	if ((o.pulls == 0) || (o.arms < 2) || (o.points == 0))
+		throw std::invalid_argument("At least one pull, two arms and one point of the curves are required");
+	return(o);
+}
+
+
+/* records every pull of the wrapped arm in the trace of its replicate, so all
+ * policies (including successive halving, which cannot be played step by step)
+ * are evaluated the same way */
+class tracked_arm: public multibeep::arms::base<num_t, rng_t>{
+	arm_ptr_t arm_ptr;
+	unsigned int k;
+	trace_t * trace;
+  public:
+	tracked_arm(arm_ptr_t a, unsigned int k, trace_t * t): arm_ptr(a), k(k), trace(t) {}
+
+	virtual num_t pull(){
+		num_t r = arm_ptr->pull();
+		trace->emplace_back(k, r);
+		return(r);
+	}
+	virtual num_t real_mean()		const {return(arm_ptr->real_mean());}
+	virtual num_t real_variance()	const {return(arm_ptr->real_variance());}
+	virtual std::string get_ident()	const {return(arm_ptr->get_ident());}
+	virtual bool provides_posterior() const {return(arm_ptr->provides_posterior());}
+	virtual std::shared_ptr<multibeep::util::posteriors::base<num_t, rng_t> > posterior() const {return(arm_ptr->posterior());}
+};
+
+
+/* the arms of one problem instance; the parameters are drawn from instance_rng,
+ * the rewards from reward_rng */
+std::vector<arm_ptr_t> make_arms(	const std::string &problem, const options &o, rng_t &instance_rng, std::shared_ptr<rng_t> reward_rng,
+									std::shared_ptr<multibeep::util::data_matrix<num_t> > data){
+	std::vector<arm_ptr_t> arms;
+	std::uniform_real_distribution<num_t> u(0,1);
+
+	for (auto k=0u; k < o.arms; ++k){
+		if (problem == "normal")
+			arms.emplace_back(new multibeep::arms::normal_arm<num_t, rng_t>(u(instance_rng), 1, reward_rng));
+		else if (problem == "bernoulli")
+			arms.emplace_back(new multibeep::arms::bernoulli_arm<num_t, rng_t>(u(instance_rng), reward_rng));
+		else if (problem == "exponential")
+			arms.emplace_back(new multibeep::arms::exponential_arm<num_t, rng_t>(0.5 + 1.5*u(instance_rng), reward_rng));
+		else if (problem == "data"){
+			// a random subset of the columns, drawn with replacement
+			std::uniform_int_distribution<unsigned int> c(0, data->number_of_columns()-1);
+			arms.emplace_back(new multibeep::arms::data_arm_bootstrap<num_t, rng_t>(data, c(instance_rng), "", reward_rng));
+		}
+		else throw std::invalid_argument("Unknown problem " + problem);
+	}
+	return(arms);
+}
+
+
+void play(const std::string &policy, const options &o, std::shared_ptr<multibeep::bandits::base<num_t, rng_t> > b, std::shared_ptr<rng_t> rng){
+	if (policy == "random")
+		multibeep::policies::random<num_t, rng_t>(b, rng).play_n_rounds(o.pulls);
+	else if (policy == "UCB_p")
+		multibeep::policies::UCB_p<num_t, rng_t>(b, rng, 1).play_n_rounds(o.pulls);
+	else if (policy == "prob_match")
+		multibeep::policies::prob_match<num_t, rng_t>(b, rng).play_n_rounds(o.pulls);
+	else if (policy == "successive_halving"){
+		// halving the arms every round, with a budget of about o.pulls in total
+		unsigned int rounds = std::ceil(std::log2(o.arms));
+		unsigned int min_pulls = std::max(1u, o.pulls/(o.arms*rounds));
+		multibeep::policies::successive_halving<num_t, rng_t>(b, min_pulls, 2).play_n_rounds(rounds);
+	}
+	else throw std::invalid_argument("Unknown policy " + policy);
+}
+
+
+struct result{
+	// mean regret after every point of the curve
+	std::vector<num_t> simple_regret, cumulative_regret;
+	unsigned long long pulls = 0;
+	double seconds = 0;
+};
+
+
+/* plays one replicate and turns its trace into regret curves */
+result run(const std::string &problem, const std::string &policy, unsigned int problem_index, unsigned int policy_index,
+			unsigned int replicate, const options &o, std::shared_ptr<multibeep::util::data_matrix<num_t> > data){
+
+	std::seed_seq instance_seed {o.seed, replicate, problem_index};
+	std::seed_seq reward_seed {o.seed, replicate, problem_index, policy_index+1};
+	rng_t instance_rng(instance_seed);
+	auto rng = std::make_shared<rng_t>(reward_seed);
+
+	auto arms = make_arms(problem, o, instance_rng, rng, data);
+	std::vector<num_t> mu(arms.size());
+	num_t mu_star = std::numeric_limits<num_t>::lowest();
+	for (auto k=0u; k < arms.size(); ++k){
+		mu[k] = arms[k]->real_mean();
+		mu_star = std::max(mu_star, mu[k]);
+	}
+
+	trace_t trace;
+	trace.reserve(o.pulls + o.arms);
+	auto b = std::make_shared<multibeep::bandits::empirical<num_t, rng_t> >();
+	for (auto k=0u; k < arms.size(); ++k)
+		b->add_arm(arm_ptr_t(new tracked_arm(arms[k], k, &trace)));
+
+	result res;
+	auto start = std::chrono::steady_clock::now();
+	play(policy, o, b, rng);
+	res.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	res.pulls = trace.size();
+
+	// the recommendation after t pulls is the arm with the highest empirical mean so far
+	std::vector<num_t> sums(arms.size(), 0);
+	std::vector<unsigned int> counts(arms.size(), 0);
+	num_t cumulative = 0;
+	auto t = 0u;
+	for (auto j=1u; j <= o.points; ++j){
+		unsigned int t_j = ((unsigned long long) o.pulls)*j/o.points;
+		for (; (t < t_j) && (t < trace.size()); ++t){
+			sums[trace[t].first] += trace[t].second;
+			counts[trace[t].first]++;
+			cumulative += mu_star - mu[trace[t].first];
+		}
+		unsigned int best = 0;
+		num_t best_mean = std::numeric_limits<num_t>::lowest();
+		for (auto k=0u; k < arms.size(); ++k){
+			if ((counts[k] > 0) && (sums[k]/counts[k] > best_mean)){
+				best_mean = sums[k]/counts[k];
+				best = k;
+			}
+		}
+		res.simple_regret.push_back(mu_star - mu[best]);
+		res.cumulative_regret.push_back(cumulative);
+	}
+	return(res);
+}
+
+
+void write_output(std::ostream &out, const options &o, const std::vector<result> &results, double wall_time){
+	auto num_policies = o.policies.size();
+
+	if (o.format == "json") out << "{\"replicates\": " << o.replicates << ", \"pulls\": " << o.pulls
+								<< ", \"arms\": " << o.arms << ", \"seed\": " << o.seed
+								<< ", \"wall_time\": " << wall_time << ", \"results\": [";
+	else out << "problem,policy,pulls,simple_regret,cumulative_regret,pulls_per_second,seconds\n";
+
+	for (auto p=0u; p < o.problems.size(); ++p){
+		for (auto q=0u; q < num_policies; ++q){
+			// reduced in replicate order, so the numbers do not depend on the threads
+			std::vector<num_t> simple(o.points, 0), cumulative(o.points, 0);
+			unsigned long long pulls = 0;
+			double seconds = 0;
+			for (auto r=0u; r < o.replicates; ++r){
+				auto &res = results[(((size_t) r)*o.problems.size() + p)*num_policies + q];
+				for (auto j=0u; j < o.points; ++j){
+					simple[j] += res.simple_regret[j]/o.replicates;
+					cumulative[j] += res.cumulative_regret[j]/o.replicates;
+				}
+				pulls += res.pulls;
+				seconds += res.seconds;
+			}
+			double pps = (seconds > 0) ? pulls/seconds : 0;
+
+			if (o.format == "json"){
+				out << ((p+q > 0) ? ", " : "") << "{\"problem\": \"" << o.problems[p] << "\", \"policy\": \"" << o.policies[q]
+					<< "\", \"pulls_per_second\": " << pps << ", \"seconds\": " << seconds << ", \"points\": [";
+				for (auto j=0u; j < o.points; ++j)
+					out << (j ? ", " : "") << ((unsigned long long) o.pulls)*(j+1)/o.points;
+				out << "], \"simple_regret\": [";
+				for (auto j=0u; j < o.points; ++j)
+					out << (j ? ", " : "") << simple[j];
+				out << "], \"cumulative_regret\": [";
+				for (auto j=0u; j < o.points; ++j)
+					out << (j ? ", " : "") << cumulative[j];
+				out << "]}";
+			}
+			else{
+				for (auto j=0u; j < o.points; ++j)
+					out << o.problems[p] << "," << o.policies[q] << "," << ((unsigned long long) o.pulls)*(j+1)/o.points << ","
+						<< simple[j] << "," << cumulative[j] << "," << pps << "," << seconds << "\n";
+			}
+		}
+	}
+	if (o.format == "json") out << "]}\n";
+}
+
+
+int main(int argc, char ** argv){
+	options o;
+	try{ o = parse(argc, argv);}
+	catch (const std::exception &e){
+		std::cerr << e.what() << std::endl;
+		return(1);
+	}
+
+	// data problems use the columns of a CSV file, or a synthetic matrix
+	std::shared_ptr<multibeep::util::data_matrix<num_t> > data;
+	if (!o.data.empty())
+		data = multibeep::util::columnar::read_csv<num_t>(o.data, ',', o.skip_columns);
+	else{
+		rng_t rng(o.seed);
+		std::normal_distribution<num_t> n(0,1);
+		unsigned int rows = 1000, cols = 4*o.arms;
+		std::vector<num_t> values(((size_t) rows)*cols);
+		for (auto j=0u; j < cols; ++j){
+			num_t mean = ((num_t) j)/cols;
+			for (auto i=0u; i < rows; ++i)
+				values[((size_t) j)*rows + i] = mean + n(rng);
+		}
+		data = std::make_shared<multibeep::util::data_matrix<num_t> >(std::move(values), rows, cols);
+	}
+
+	// one job per (replicate, problem, policy), distributed over the threads
+	size_t num_jobs = ((size_t) o.replicates)*o.problems.size()*o.policies.size();
+	std::vector<result> results(num_jobs);
+	std::atomic<size_t> next(0);
+	std::vector<std::exception_ptr> errors;
+
+	unsigned int num_threads = o.threads ? o.threads : std::max(1u, std::thread::hardware_concurrency());
+	errors.resize(num_threads);
+
+	auto start = std::chrono::steady_clock::now();
+	std::vector<std::thread> pool;
+	for (auto i=0u; i < num_threads; ++i){
+		pool.emplace_back([&, i] (){
+			try{
+				for (size_t job = next++; job < num_jobs; job = next++){
+					unsigned int q = job % o.policies.size();
+					unsigned int p = (job / o.policies.size()) % o.problems.size();
+					unsigned int r = job / (o.policies.size()*o.problems.size());
+					results[job] = run(o.problems[p], o.policies[q], p, q, r, o, data);
+				}
+			}
+			catch (...){
+				errors[i] = std::current_exception();
+				next = num_jobs;
+			}
+		});
+	}
+	for (auto &t: pool) t.join();
+	double wall_time = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	for (auto &e: errors){
+		if (!e) continue;
+		try{ std::rethrow_exception(e);}
+		catch (const std::exception &ex){
+			std::cerr << ex.what() << std::endl;
+			return(1);
+		}
+	}
+
+	if (o.output.empty())
+		write_output(std::cout, o, results, wall_time);
+	else{
+		std::ofstream out(o.output);
+		write_output(out, o, results, wall_time);
+	}
+	std::cerr << num_jobs << " runs on " << num_threads << " threads in " << wall_time << "s" << std::endl;
+	return(0);
+}
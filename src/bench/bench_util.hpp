@@ -0,0 +1,78 @@
+#ifndef MULTIBEEP_BENCH_UTIL
+#define MULTIBEEP_BENCH_UTIL
+
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+
+/* Minimal harness for the microbenchmarks
+ *
+ * Every benchmark is a function performing a fixed number of operations. It is
+ * run once to warm up and then repeated; the minimum and the median time per
+ * operation are reported as CSV (default) or JSON on stdout.
+ *
+ * usage: bench_* [--format csv|json] [--repetitions N] [--filter substring]
+ */
+class bench_reporter{
+	std::string format = "csv";
+	std::string filter;
+	unsigned int repetitions = 7;
+	bool first = true;
+
+  public:
+	bench_reporter(int argc, char ** argv){
+		for (int i=1; i+1 < argc; i+=2){
+			std::string arg(argv[i]), value(argv[i+1]);
+			if		(arg == "--format")			format = value;
+			else if	(arg == "--repetitions")	repetitions = std::max(1ul, std::stoul(value));
+			else if	(arg == "--filter")			filter = value;
+			else throw std::invalid_argument("Unknown option " + arg);
+		}
+		if ((format != "csv") && (format != "json"))
+			throw std::invalid_argument("The format has to be csv or json");
+
+		if (format == "csv") std::cout << "benchmark,parameters,operations,ns_per_op_min,ns_per_op_median" << std::endl;
+		else std::cout << "[";
+	}
+
+	~bench_reporter(){
+		if (format == "json") std::cout << "]" << std::endl;
+	}
+
+	/* \brief times body, which performs num_operations operations */
+	void run(const std::string &name, const std::string &parameters, unsigned long num_operations, std::function<void ()> body){
+		if ((!filter.empty()) && (name.find(filter) == std::string::npos)) return;
+
+		body();
+		std::vector<double> ns;
+		for (auto r=0u; r < repetitions; ++r){
+			auto start = std::chrono::steady_clock::now();
+			body();
+			ns.push_back(std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count()/num_operations);
+		}
+		std::sort(ns.begin(), ns.end());
+
+		if (format == "csv")
+			std::cout << name << "," << parameters << "," << num_operations << "," << ns.front() << "," << ns[ns.size()/2] << std::endl;
+		else{
+			std::cout << (first ? "" : ",") << "\n{\"benchmark\": \"" << name << "\", \"parameters\": \"" << parameters
+				<< "\", \"operations\": " << num_operations << ", \"ns_per_op_min\": " << ns.front()
+				<< ", \"ns_per_op_median\": " << ns[ns.size()/2] << "}";
+		}
+		first = false;
+	}
+};
+
+
+/* keeps the compiler from optimizing away computations whose result is unused */
+template <typename T>
+inline void do_not_optimize(const T &value){
+	asm volatile("" : : "r,m"(value) : "memory");
+}
+
+#endif
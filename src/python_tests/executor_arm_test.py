@@ -0,0 +1,55 @@
+import sys
+sys.path.append("../../")
+
+import concurrent.futures
+
+import multibeep as mb
+
+
+def reward(m):
+	return(m)
+
+def failure(m):
+	raise ValueError("evaluation %f failed"%m)
+
+
+means = [0.1, 0.5, 0.9]
+N = 60
+
+with concurrent.futures.ThreadPoolExecutor(4) as executor:
+
+	# every selection of the policy is pulled, even if the arm was still running:
+	# the random policy pulls the same arms as without asynchronous pulls
+	counts = []
+	for max_pending in [0, 4]:
+		rng = mb.util.rng_class(42)
+		bandit = mb.bandits.empirical()
+		for m in means:
+			bandit.add_arm(mb.arms.executor(executor, reward, m))
+		policy = mb.policies.random(bandit, rng)
+		policy.play_n_rounds(N, max_pending)
+		assert(bandit.number_of_pulls() == N)
+		counts.append(sorted((bandit[i].identifier, bandit[i].num_pulls) for i in range(bandit.number_of_arms())))
+	assert(counts[0] == counts[1])
+
+	# a failing evaluation is raised, the pulls still running are recorded
+	bandit = mb.bandits.empirical()
+	bandit.add_arm(mb.arms.executor(executor, failure, 0.))
+	for m in means:
+		bandit.add_arm(mb.arms.executor(executor, reward, m))
+	policy = mb.policies.random(bandit, mb.util.rng_class(1))
+	try:
+		policy.play_n_rounds(N, 4)
+		assert(False)
+	except ValueError:
+		pass
+	assert(bandit.number_of_pulls() < N)
+	assert(bandit[0].num_pulls == 0)
+
+	# Hyperband plays many bandits, so it cannot pull asynchronously
+	hb = mb.policies.hyperband(mb.bandits.empirical, lambda r: mb.arms.normal(0, 1, r), mb.util.rng_class(1), 9)
+	try:
+		hb.play_n_rounds(1, 4)
+		assert(False)
+	except ValueError:
+		pass
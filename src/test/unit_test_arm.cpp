@@ -1,6 +1,13 @@
 #include <memory>
 #include <random>
 #include <cmath>
+#include <cstdio>
+#include <vector>
+#include <fstream>
+#include <string>
+#include <stdexcept>
+#include <stdlib.h>
+#include <unistd.h>
 
 #include <boost/test/unit_test.hpp>
 
@@ -10,6 +17,8 @@
 #include "multibeep/arm/exponential.hpp"
 #include "multibeep/arm/bernoulli.hpp"
 #include "multibeep/arm/normal.hpp"
+#include "multibeep/arm/data.hpp"
+#include "multibeep/util/columnar_loader.hpp"
 
 
 
@@ -17,6 +26,20 @@ typedef std::default_random_engine rng_type;
 typedef double num_t;
 
 
+// a new, empty file that is removed at the end of the scope, even if a check fails
+struct temporary_file{
+	std::string name;
+	temporary_file(){
+		char tmp[] = "/tmp/multibeep_test_XXXXXX";
+		int fd = mkstemp(tmp);
+		if (fd == -1) throw std::runtime_error("Could not create a temporary file");
+		close(fd);
+		name = tmp;
+	}
+	~temporary_file(){ std::remove(name.c_str());}
+};
+
+
 BOOST_AUTO_TEST_CASE(test_exponential_arm){
 	std::shared_ptr<rng_type> rng_ptr = std::make_shared<rng_type> (rng_type () );
 	int N = 1000000;
@@ -113,3 +136,117 @@ BOOST_AUTO_TEST_CASE(test_normal_arm){
 	BOOST_REQUIRE_CLOSE(p->mean(), arm.real_mean(), 1e-0);
 }
 
+
+BOOST_AUTO_TEST_CASE(test_data_arm){
+	std::shared_ptr<rng_type> rng_ptr = std::make_shared<rng_type> (rng_type () );
+
+	// 3 columns with 4 values each, column-major
+	std::vector<num_t> values {1,2,3,4, 0,0,0,0, -1,1,-1,1};
+	auto m_ptr = std::make_shared<multibeep::util::data_matrix<num_t> > (std::vector<num_t>(values), 4, 3, 2);
+
+	BOOST_REQUIRE_CLOSE(m_ptr->column_mean(0), 2.5, 1e-10);
+	BOOST_REQUIRE_CLOSE(m_ptr->column_variance(0), 5./3, 1e-10);
+	BOOST_REQUIRE_EQUAL(m_ptr->column_variance(1), 0);
+
+	multibeep::arms::data_arm_sequential<num_t, rng_type> arm (m_ptr, 2, "third", rng_ptr);
+	BOOST_REQUIRE_EQUAL(arm.real_mean(), 0);
+	for (auto i=0u; i < 8; i++)
+		BOOST_REQUIRE_EQUAL(arm.pull(), values[8 + i%4]);
+
+	// the arm views the matrix, so it keeps it alive
+	BOOST_REQUIRE(arm.pull() == m_ptr->column(2)[0]);
+
+	multibeep::arms::data_arm_bootstrap<num_t, rng_type> arm2 (m_ptr, 0, "first", rng_ptr);
+	for (auto i=0u; i < 100; i++){
+		auto r = arm2.pull();
+		BOOST_REQUIRE((r >= 1) && (r <= 4));
+	}
+
+	BOOST_REQUIRE_THROW((multibeep::arms::data_arm_bootstrap<num_t, rng_type> (m_ptr, 3, "none", rng_ptr)), std::out_of_range);
+
+	// an arm without values has nothing to return
+	auto empty_ptr = std::make_shared<multibeep::util::data_matrix<num_t> > (std::vector<num_t>(), 0, 2, 1);
+	BOOST_REQUIRE_THROW((multibeep::arms::data_arm_sequential<num_t, rng_type> (empty_ptr, 0, "empty", rng_ptr)), std::invalid_argument);
+	BOOST_REQUIRE_THROW((multibeep::arms::data_arm_bootstrap<num_t, rng_type> (empty_ptr, 1, "empty", rng_ptr)), std::invalid_argument);
+
+	// the same matrix mapped from a file behind a small header
+	temporary_file tmp;
+	std::string fn = tmp.name;
+	FILE * f = std::fopen(fn.c_str(), "wb");
+	num_t header = 42;
+	std::fwrite(&header, sizeof(num_t), 1, f);
+	std::fwrite(values.data(), sizeof(num_t), values.size(), f);
+	std::fclose(f);
+
+	auto mm_ptr = multibeep::util::data_matrix<num_t>::map_file(fn, 4, 3, sizeof(num_t));
+	for (auto j=0u; j < 3; j++){
+		BOOST_REQUIRE_EQUAL(mm_ptr->column_mean(j), m_ptr->column_mean(j));
+		BOOST_REQUIRE_EQUAL(mm_ptr->column(j)[3], values[4*j+3]);
+	}
+	BOOST_REQUIRE_THROW(multibeep::util::data_matrix<num_t>::map_file(fn, 4, 4), std::runtime_error);
+}
+
+
+BOOST_AUTO_TEST_CASE(test_columnar_loader){
+	std::shared_ptr<rng_type> rng_ptr = std::make_shared<rng_type> (rng_type () );
+
+	temporary_file csv_file, bin_file;
+	std::string csv = csv_file.name;
+	{
+		std::ofstream out(csv);
+		out << "instance, algo_a, algo_b\n";
+		out << "i1, 1, 2\n";
+		out << "i2, , 3\n";
+		out << "\n";
+		out << "i3, 12000, 4\r\n";
+	}
+
+	// missing values count as 100, timeouts (>=12000) as 1200, and runtimes are negated
+	multibeep::util::columnar::substitution<num_t> subs(100, 12000, 1200, -1);
+	auto m_ptr = multibeep::util::columnar::read_csv<num_t>(csv, ',', 1, true, subs, 1);
+
+	BOOST_REQUIRE_EQUAL(m_ptr->number_of_rows(), 3);
+	BOOST_REQUIRE_EQUAL(m_ptr->number_of_columns(), 2);
+	BOOST_REQUIRE_EQUAL(m_ptr->column_name(0), "algo_a");
+	BOOST_REQUIRE_EQUAL(m_ptr->column_name(1), "algo_b");
+	std::vector<num_t> a {-1, -100, -1200}, b {-2, -3, -4};
+	for (auto i=0u; i < 3; i++){
+		BOOST_REQUIRE_EQUAL(m_ptr->column(0)[i], a[i]);
+		BOOST_REQUIRE_EQUAL(m_ptr->column(1)[i], b[i]);
+	}
+	BOOST_REQUIRE_CLOSE(m_ptr->column_mean(1), -3, 1e-10);
+
+	// round trip through the binary format
+	std::string bin = bin_file.name;
+	multibeep::util::columnar::write_binary(bin, *m_ptr);
+	auto b_ptr = multibeep::util::columnar::read_binary<num_t>(bin);
+	BOOST_REQUIRE_EQUAL(b_ptr->number_of_rows(), 3);
+	BOOST_REQUIRE_EQUAL(b_ptr->column_name(1), "algo_b");
+	for (auto j=0u; j < 2; j++)
+		for (auto i=0u; i < 3; i++)
+			BOOST_REQUIRE_EQUAL(b_ptr->column(j)[i], m_ptr->column(j)[i]);
+
+	auto arms = multibeep::arms::data_arms_from_matrix<num_t, rng_type>(b_ptr, false, rng_ptr);
+	BOOST_REQUIRE_EQUAL(arms.size(), 2);
+	BOOST_REQUIRE_EQUAL(arms[0]->get_ident(), "Data algo_a");
+	BOOST_REQUIRE_EQUAL(arms[1]->pull(), -2);
+	BOOST_REQUIRE_EQUAL(arms[1]->real_mean(), -3);
+
+	// a header without any data rows is rejected instead of producing arms without values
+	temporary_file empty_file;
+	{
+		std::ofstream out(empty_file.name);
+		out << "instance, algo_a, algo_b\n\n";
+	}
+	BOOST_REQUIRE_THROW(multibeep::util::columnar::read_csv<num_t>(empty_file.name, ',', 1, true, subs, 1), std::runtime_error);
+	BOOST_REQUIRE_THROW(multibeep::util::data_matrix<num_t>::map_file(bin, 0, 2), std::runtime_error);
+
+	// the same for a binary file whose header announces zero rows
+	{
+		std::fstream io(bin, std::ios::in | std::ios::out | std::ios::binary);
+		uint32_t zero = 0;
+		io.seekp(sizeof(multibeep::util::columnar::binary_magic) + sizeof(uint32_t));
+		io.write(reinterpret_cast<const char*>(&zero), sizeof(zero));
+	}
+	BOOST_REQUIRE_THROW(multibeep::util::columnar::read_binary<num_t>(bin), std::runtime_error);
+}
@@ -1,4 +1,10 @@
 #include <random>
+#include <memory>
+#include <vector>
+#include <string>
+#include <stdexcept>
+#include <thread>
+#include <cstring>
 
 #include <boost/test/unit_test.hpp>
 
@@ -8,6 +14,7 @@
 #include "multibeep/arm/exponential.hpp"
 #include "multibeep/arm/bernoulli.hpp"
 #include "multibeep/arm/normal.hpp"
+#include "multibeep/arm/python_arm.hpp"
 //#include "multibeep/arm/data.hpp"
 //#include "multibeep/arm/arm_generator_csv.hpp"
 
@@ -71,7 +78,24 @@ void basic_test (T ... t){
 	BOOST_REQUIRE_EQUAL(bandit.number_of_pulled_arms(), 2);
 	BOOST_REQUIRE_EQUAL(bandit[0].num_pulls, 2);
 	BOOST_REQUIRE_EQUAL(bandit[1].num_pulls, 1);
-	
+
+	auto batch = bandit.pull_batch_by_index(1, 4);
+	BOOST_REQUIRE_EQUAL(batch.size(), 4);
+	BOOST_REQUIRE_EQUAL(bandit.number_of_pulls(), 7);
+	BOOST_REQUIRE_EQUAL(bandit[1].num_pulls, 5);
+	BOOST_REQUIRE_EQUAL(bandit[1].reward_stats.number_of_points(), 5);
+
+	// rewards of pulls that happened outside of the bandit
+	bandit.add_reward_by_identifier(0, 0.25);
+	// the history can be read without refreshing the estimates
+	BOOST_REQUIRE_EQUAL(bandit.rewards_ptr(0)->back(), 0.25);
+	BOOST_REQUIRE_EQUAL(bandit.number_of_dirty_arms(), 1);
+	BOOST_REQUIRE_THROW(bandit.rewards_ptr(2), std::out_of_range);
+	BOOST_REQUIRE_EQUAL(bandit.number_of_pulls(), 8);
+	BOOST_REQUIRE_EQUAL(bandit[0].num_pulls, 3);
+	BOOST_REQUIRE_EQUAL(bandit[0].rewards.back(), 0.25);
+	BOOST_REQUIRE_THROW(bandit.add_reward_by_identifier(42, 0.), std::invalid_argument);
+
 	bandit.add_arm(std::shared_ptr<multibeep::arms::base<num_t, rng_t> > (new multibeep::arms::exponential_arm<num_t, rng_t> (0.1, rng_ptr)));
 	bandit.add_arm(std::shared_ptr<multibeep::arms::base<num_t, rng_t> > (new multibeep::arms::bernoulli_arm<num_t, rng_t> (0.5, rng_ptr)));
 	
@@ -85,6 +109,21 @@ void basic_test (T ... t){
 		bandit.pull_by_index(i%bandit.number_of_active_arms());
 
 	bandit.update_p_max(false, 0.01, 64);
+
+	// the bulk state agrees with the individual arm infos
+	auto n = bandit.number_of_arms();
+	std::vector<unsigned int> ids(n);
+	std::unique_ptr<bool[]> active(new bool[n]);
+	std::vector<num_t> pulls(n), means(n), variances(n), pmaxs(n);
+	bandit.get_state(ids.data(), active.get(), pulls.data(), means.data(), variances.data(), pmaxs.data());
+	for (auto i=0u; i < n; i++){
+		BOOST_REQUIRE_EQUAL(ids[i], bandit[i].identifier);
+		BOOST_REQUIRE_EQUAL(active[i], bandit[i].is_active);
+		BOOST_REQUIRE_EQUAL(pulls[i], bandit[i].num_pulls);
+		BOOST_REQUIRE((means[i] == bandit[i].estimated_mean) || std::isnan(means[i]));
+		BOOST_REQUIRE((pmaxs[i] == bandit[i].p_max) || std::isnan(pmaxs[i]));
+	}
+
 	bandit.deactivate_by_confidence_gap(0.01, false);
 	
 }
@@ -105,3 +144,460 @@ BOOST_AUTO_TEST_CASE(test_n_last_pulls_bandit){
 	basic_test< multibeep::bandits::last_n_pulls<num_t, rng_t>	>(5);
 }
 
+
+
+BOOST_AUTO_TEST_CASE(test_add_arms){
+	std::shared_ptr<rng_t> rng_ptr = std::make_shared<rng_t> (rng_t () );
+	multibeep::bandits::empirical<num_t,rng_t> bandit;
+
+	std::vector<std::shared_ptr<multibeep::arms::base<num_t, rng_t> > > arms;
+	for (auto i=0u; i < 2; i++)
+		arms.emplace_back(new multibeep::arms::normal_arm<num_t, rng_t> (i, 1., rng_ptr));
+
+	BOOST_REQUIRE_EQUAL(bandit.add_arms(arms), 0);
+	bandit.deactivate_by_identifier(0);
+
+	arms.clear();
+	for (auto i=0u; i < 3; i++)
+		arms.emplace_back(new multibeep::arms::bernoulli_arm<num_t, rng_t> (0.1*i, rng_ptr));
+	BOOST_REQUIRE_EQUAL(bandit.add_arms(arms), 2);
+
+	BOOST_REQUIRE_EQUAL(bandit.number_of_arms(), 5);
+	BOOST_REQUIRE_EQUAL(bandit.number_of_active_arms(), 4);
+	// all active arms come first
+	for (auto i=0u; i < bandit.number_of_arms(); i++)
+		BOOST_REQUIRE_EQUAL(bandit[i].is_active, i < 4);
+	BOOST_REQUIRE_EQUAL(bandit[4].identifier, 0);
+}
+
+
+num_t constant_reward(void*){return(1);}
+// what the python wrapper returns if pull_batch raised an exception
+int failing_pull_batch(void*, unsigned int, num_t* rewards){
+	rewards[0] = 1;
+	return(0);
+}
+
+BOOST_AUTO_TEST_CASE(test_failing_pull_batch){
+	multibeep::bandits::empirical<num_t,rng_t> bandit;
+	bandit.add_arm(std::make_shared<multibeep::arms::python_arm<num_t, rng_t> >("failing", nullptr,
+		constant_reward, constant_reward, constant_reward, nullptr, nullptr, failing_pull_batch));
+
+	BOOST_REQUIRE_THROW(bandit.pull_batch_by_index(0, 4), std::runtime_error);
+	BOOST_REQUIRE_THROW(bandit.min_pull_arms(4), std::runtime_error);
+	// no partial batch is recorded
+	BOOST_REQUIRE_EQUAL(bandit.number_of_pulls(), 0);
+	BOOST_REQUIRE_EQUAL(bandit[0].num_pulls, 0);
+	BOOST_REQUIRE(bandit[0].rewards.empty());
+
+	// single pulls are not affected
+	BOOST_REQUIRE_EQUAL(bandit.pull_by_index(0), 1);
+}
+
+
+BOOST_AUTO_TEST_CASE(test_dirty_tracking){
+	std::shared_ptr<rng_t> rng_ptr = std::make_shared<rng_t> (rng_t () );
+	multibeep::bandits::last_n_pulls<num_t,rng_t> b(4);
+	for (auto i=0u; i < 4; i++)
+		b.add_arm(std::shared_ptr<multibeep::arms::base<num_t, rng_t> > (new multibeep::arms::normal_arm<num_t, rng_t> (0.1*i, 1., rng_ptr)));
+	BOOST_REQUIRE_EQUAL(b.number_of_dirty_arms(), 4);
+
+	b.min_pull_arms(3);
+	b.update_active_arm_infos();
+	BOOST_REQUIRE_EQUAL(b.number_of_dirty_arms(), 0);
+
+	// repeated pulls of the same arm count it once
+	auto epoch = b.epoch();
+	b.pull_by_index(0);
+	b.pull_by_index(0);
+	BOOST_REQUIRE_EQUAL(b.epoch(), epoch + 2);
+	BOOST_REQUIRE_EQUAL(b.number_of_dirty_arms(), 1);
+	BOOST_REQUIRE(b[0].version == b[0].updated_version);
+	BOOST_REQUIRE_EQUAL(b.number_of_dirty_arms(), 0);
+
+	// accessing clean arms does not update them
+	b.enable_stats(true);
+	for (auto i=0u; i < 4; i++) b[i];
+	BOOST_REQUIRE_EQUAL(b.get_stats().num_arm_info_updates, 0);
+
+	// only active arms are counted
+	b.pull_by_index(1);
+	b.pull_by_index(2);
+	auto id = b[3].identifier;
+	b.deactivate_by_index(1);
+	BOOST_REQUIRE_EQUAL(b.number_of_dirty_arms(), 1);
+	b.reactivate_by_index(3);
+	BOOST_REQUIRE_EQUAL(b.number_of_dirty_arms(), 2);
+	b.deactivate_by_identifier(id);
+	b.update_active_arm_infos();
+	BOOST_REQUIRE_EQUAL(b.number_of_dirty_arms(), 0);
+	BOOST_REQUIRE(b[3].dirty() == false);
+	if (multibeep::util::instrumentation::compiled_in)
+		BOOST_REQUIRE_EQUAL(b.get_stats().num_arm_info_updates, 2);
+}
+
+
+BOOST_AUTO_TEST_CASE(test_changed_arms){
+	std::shared_ptr<rng_t> rng_ptr = std::make_shared<rng_t> (rng_t () );
+	std::uniform_int_distribution<unsigned int> dist(0, 1000);
+	multibeep::bandits::empirical<num_t,rng_t> b;
+	for (auto i=0u; i < 50; i++)
+		b.add_arm(std::shared_ptr<multibeep::arms::base<num_t, rng_t> > (new multibeep::arms::normal_arm<num_t, rng_t> (0.1*i, 1., rng_ptr)));
+
+	// only the arms that changed are refreshed, wherever the reordering moved them
+	for (auto round=0u; round < 500; round++){
+		auto k = dist(*rng_ptr);
+		auto active = b.number_of_active_arms();
+		if ((k % 7 == 0) && (active > 1)) b.deactivate_by_index(k % active);
+		else if (k % 7 == 1) b.reactivate_by_identifier(k % b.number_of_arms());
+		else if (k % 7 == 2) b.sort_active_arms_by_mean();
+		else if (k % 7 == 3) b.add_arm(std::shared_ptr<multibeep::arms::base<num_t, rng_t> > (new multibeep::arms::normal_arm<num_t, rng_t> (0., 1., rng_ptr)));
+		else if (active > 0) b.pull_by_index(k % active);
+
+		// operator[] refreshes the arms as well, so changes pile up between the checks
+		if (round % 10 == 9){
+			b.update_active_arm_infos();
+			BOOST_REQUIRE_EQUAL(b.number_of_dirty_arms(), 0);
+			for (auto i=0u; i < b.number_of_arms(); i++)
+				BOOST_REQUIRE_EQUAL(b.index_by_identifier(b[i].identifier), i);
+		}
+	}
+
+	// an arm that is inactive during an update is refreshed by the next update after its reactivation
+	auto id = b[0].identifier;
+	b.pull_by_index(0);
+	b.deactivate_by_identifier(id);
+	b.update_active_arm_infos();
+	b.reactivate_by_identifier(id);
+	BOOST_REQUIRE_EQUAL(b.number_of_dirty_arms(), 1);
+	b.update_active_arm_infos();
+	BOOST_REQUIRE_EQUAL(b.number_of_dirty_arms(), 0);
+}
+
+
+BOOST_AUTO_TEST_CASE(test_checkpoint){
+	auto make_bandit = [] (std::shared_ptr<rng_t> rng_ptr){
+		std::shared_ptr<multibeep::bandits::empirical<num_t,rng_t> > b (new multibeep::bandits::empirical<num_t,rng_t>());
+		for (auto i=0u; i < 4; i++)
+			b->add_arm(std::shared_ptr<multibeep::arms::base<num_t, rng_t> > (new multibeep::arms::normal_arm<num_t, rng_t> (0.1*i, 1., rng_ptr)));
+		b->add_arm(std::shared_ptr<multibeep::arms::base<num_t, rng_t> > (new multibeep::arms::bernoulli_arm<num_t, rng_t> (0.5, rng_ptr)));
+		return(b);
+	};
+
+	std::shared_ptr<rng_t> rng_ptr = std::make_shared<rng_t> (rng_t () );
+	auto b1 = make_bandit(rng_ptr);
+	auto b2 = make_bandit(rng_ptr);
+
+	b1->min_pull_arms(10);
+	b1->deactivate_by_identifier(1);
+	b1->pull_by_identifier(4);
+	b1->update_p_max(false, 0.01, 64);
+
+	auto snapshot = b1->checkpoint();
+	b2->restore(snapshot.data(), snapshot.size());
+
+	BOOST_REQUIRE_EQUAL(b2->number_of_pulls(), b1->number_of_pulls());
+	BOOST_REQUIRE_EQUAL(b2->number_of_active_arms(), b1->number_of_active_arms());
+	BOOST_REQUIRE_EQUAL(b2->number_of_pulled_arms(), b1->number_of_pulled_arms());
+	for (auto i=0u; i < b1->number_of_arms(); i++){
+		auto &a1 = (*b1)[i];
+		auto &a2 = (*b2)[i];
+		BOOST_REQUIRE_EQUAL(a1.identifier, a2.identifier);
+		BOOST_REQUIRE_EQUAL(a1.is_active, a2.is_active);
+		BOOST_REQUIRE_EQUAL(a1.num_pulls, a2.num_pulls);
+		BOOST_REQUIRE_EQUAL(a1.estimated_mean, a2.estimated_mean);
+		BOOST_REQUIRE((a1.p_max == a2.p_max) || (std::isnan(a1.p_max) && std::isnan(a2.p_max)));
+		BOOST_REQUIRE(a1.rewards == a2.rewards);
+		BOOST_REQUIRE_EQUAL(a1.get_arm_ptr()->real_mean(), a2.get_arm_ptr()->real_mean());
+	}
+
+	// broken snapshots are rejected
+	BOOST_REQUIRE_THROW(b2->restore(snapshot.data(), snapshot.size()/2), std::runtime_error);
+	BOOST_REQUIRE_THROW(b2->restore(snapshot.data()+1, snapshot.size()-1), std::runtime_error);
+	auto other = make_bandit(rng_ptr);
+	other->add_arm(std::shared_ptr<multibeep::arms::base<num_t, rng_t> > (new multibeep::arms::bernoulli_arm<num_t, rng_t> (0.5, rng_ptr)));
+	BOOST_REQUIRE_THROW(other->restore(snapshot.data(), snapshot.size()), std::invalid_argument);
+
+	// unpulled normal arms have identical arm infos, so the second identifier follows the snapshot of a single arm
+	auto unpulled = [&rng_ptr] (unsigned int n){
+		std::shared_ptr<multibeep::bandits::empirical<num_t,rng_t> > b (new multibeep::bandits::empirical<num_t,rng_t>());
+		for (auto i=0u; i < n; i++)
+			b->add_arm(std::shared_ptr<multibeep::arms::base<num_t, rng_t> > (new multibeep::arms::normal_arm<num_t, rng_t> (0., 1., rng_ptr)));
+		return(b);
+	};
+	auto s1 = unpulled(1)->checkpoint();
+	auto s2 = unpulled(2)->checkpoint();
+	unsigned int duplicate = 0;
+	std::memcpy(&s2[s1.size()], &duplicate, sizeof(duplicate));
+	BOOST_REQUIRE_THROW(unpulled(2)->restore(s2.data(), s2.size()), std::runtime_error);
+}
+
+
+BOOST_AUTO_TEST_CASE(test_stats){
+	std::shared_ptr<rng_t> rng_ptr = std::make_shared<rng_t> (rng_t () );
+	multibeep::bandits::empirical<num_t,rng_t> b;
+	for (auto i=0u; i < 4; i++)
+		b.add_arm(std::shared_ptr<multibeep::arms::base<num_t, rng_t> > (new multibeep::arms::normal_arm<num_t, rng_t> (0.1*i, 1., rng_ptr)));
+
+	// nothing is collected by default
+	b.min_pull_arms(10);
+	BOOST_REQUIRE_EQUAL(b.get_stats().num_pulls, 0);
+
+	b.enable_stats(true);
+	for (auto i=0u; i < 5; i++)
+		b.pull_by_index(0);
+	b[0]; b[0];
+	b.update_p_max(false, 0.01, 16);
+
+	auto &s = b.get_stats();
+	if (multibeep::util::instrumentation::compiled_in){
+		BOOST_REQUIRE_EQUAL(s.num_pulls, 5);
+		// only the first access finds a dirty arm info
+		BOOST_REQUIRE_EQUAL(s.num_arm_info_updates, 1);
+		BOOST_REQUIRE_EQUAL(s.num_posterior_allocations, 1);
+		BOOST_REQUIRE_EQUAL(s.num_pmax_updates, 1);
+		// the gaussian fast path; no arm is narrow enough to split an interval, and cdfs that are numerically 1 are skipped
+		BOOST_REQUIRE_EQUAL(s.num_pmax_fast_paths, 1);
+		BOOST_REQUIRE_EQUAL(s.num_pmax_integrals, 4);
+		BOOST_REQUIRE_EQUAL(s.num_quadrature_nodes, 4*16);
+		BOOST_REQUIRE(s.num_posterior_evaluations >= 4*16);
+		BOOST_REQUIRE(s.num_posterior_evaluations <= 4*4*16);
+		BOOST_REQUIRE(s.pmax_ns > 0);
+	}
+
+	b.reset_stats();
+	b.enable_stats(false);
+	b.pull_by_index(1);
+	BOOST_REQUIRE_EQUAL(b.get_stats().num_pulls, 0);
+	BOOST_REQUIRE_EQUAL(b.get_stats().num_pmax_updates, 0);
+}
+
+
+BOOST_AUTO_TEST_CASE(test_event_ring){
+	std::shared_ptr<rng_t> rng_ptr = std::make_shared<rng_t> (rng_t () );
+	auto ring = std::make_shared<multibeep::util::event_ring<num_t> >(5);
+	BOOST_REQUIRE_EQUAL(ring->capacity(), 8);
+
+	multibeep::bandits::empirical<num_t,rng_t> b;
+	b.set_event_ring(ring);
+	for (auto i=0u; i < 2; i++)
+		b.add_arm(std::shared_ptr<multibeep::arms::base<num_t, rng_t> > (new multibeep::arms::normal_arm<num_t, rng_t> (0.1*i, 1., rng_ptr)));
+	auto r = b.pull_by_index(1);
+	b.deactivate_by_identifier(0);
+	b.reactivate_by_identifier(0);
+	b.update_p_max(false, 0.01, 16);
+
+	std::vector<multibeep::util::event<num_t> > events(16);
+	BOOST_REQUIRE_EQUAL(ring->pop(events.data(), events.size()), 6);
+	BOOST_REQUIRE_EQUAL(events[0].type, multibeep::util::arm_added);
+	BOOST_REQUIRE_EQUAL(events[1].identifier, 1);
+	BOOST_REQUIRE_EQUAL(events[2].type, multibeep::util::arm_pulled);
+	BOOST_REQUIRE_EQUAL(events[2].identifier, 1);
+	BOOST_REQUIRE_EQUAL(events[2].value, r);
+	BOOST_REQUIRE_EQUAL(events[2].num_pulls, 0);
+	BOOST_REQUIRE_EQUAL(events[3].type, multibeep::util::arm_deactivated);
+	BOOST_REQUIRE_EQUAL(events[3].num_pulls, 1);
+	BOOST_REQUIRE_EQUAL(events[4].type, multibeep::util::arm_reactivated);
+	BOOST_REQUIRE_EQUAL(events[5].type, multibeep::util::pmax_updated);
+	BOOST_REQUIRE_EQUAL(events[5].identifier, 2);
+
+	// a full ring drops the newest events
+	b.pull_batch_by_index(0, 10);
+	BOOST_REQUIRE_EQUAL(ring->size(), 8);
+	BOOST_REQUIRE_EQUAL(ring->dropped(), 2);
+	BOOST_REQUIRE_EQUAL(ring->pop(events.data(), 3), 3);
+	BOOST_REQUIRE_EQUAL(events[0].num_pulls, 1);
+
+	// a consumer on another thread sees every event that was not dropped in order
+	multibeep::util::event_ring<num_t> ring2(64);
+	const unsigned int n = 100000;
+	unsigned int num_received = 0;
+	bool ordered = true;
+	std::thread consumer([&] (){
+		std::vector<multibeep::util::event<num_t> > buffer(16);
+		uint64_t last = 0;
+		while (num_received + ring2.dropped() < n){
+			auto k = ring2.pop(buffer.data(), buffer.size());
+			for (auto i=0u; i < k; ++i){
+				if ((num_received > 0) && (buffer[i].num_pulls <= last)) ordered = false;
+				last = buffer[i].num_pulls;
+				++num_received;
+			}
+		}
+	});
+	for (auto i=0u; i < n; ++i)
+		ring2.push(i, multibeep::util::arm_pulled, 0, i);
+	consumer.join();
+	BOOST_REQUIRE(ordered);
+	BOOST_REQUIRE_EQUAL(num_received + ring2.dropped(), n);
+}
+
+
+BOOST_AUTO_TEST_CASE(test_background_pmax){
+	std::shared_ptr<rng_t> rng_ptr = std::make_shared<rng_t> (rng_t () );
+	multibeep::bandits::empirical<num_t,rng_t> b;
+	for (auto i=0u; i < 4; i++)
+		b.add_arm(std::shared_ptr<multibeep::arms::base<num_t, rng_t> > (new multibeep::arms::normal_arm<num_t, rng_t> (0.2*i, 1., rng_ptr)));
+
+	auto w = std::make_shared<multibeep::util::pmax::background_worker<num_t, rng_t> >(0.01, 32);
+	b.set_background_pmax(w);
+	b.min_pull_arms(10);
+
+	// the first access starts a computation, the next one after it finished picks up the result
+	b[0];
+	w->wait();
+	b[0];
+	w->wait();
+	BOOST_REQUIRE_GT(b[0].p_max_version, 0);
+	BOOST_REQUIRE_EQUAL(b[0].p_max_staleness, 0);
+
+	std::vector<num_t> background(4);
+	for (auto i=0u; i < 4; i++)
+		background[b[i].identifier] = b[i].p_max;
+
+	// same posteriors, same values as the synchronous computation
+	auto version = b[0].p_max_version;
+	b.update_p_max(false, 0.01, 32);
+	for (auto i=0u; i < 4; i++){
+		BOOST_REQUIRE_CLOSE(b[i].p_max, background[b[i].identifier], 1e-10);
+		BOOST_REQUIRE_GT(b[i].p_max_version, version);
+	}
+
+	// an outdated value is reported with its staleness instead of NAN
+	b.pull_by_index(0);
+	auto &ai = b[1];
+	BOOST_REQUIRE(!std::isnan(ai.p_max));
+	BOOST_REQUIRE_EQUAL(ai.p_max_staleness, 1);
+
+	w->wait();
+	b.set_background_pmax(nullptr);
+	b.pull_by_index(0);
+	BOOST_REQUIRE(std::isnan(b[1].p_max));
+}
+
+
+// a posterior that cannot be integrated, e.g. because of invalid parameters
+class failing_posterior: public multibeep::util::posteriors::base<num_t, rng_t>{
+	public:
+		virtual num_t mean() const {return(0);}
+		virtual num_t variance() const {return(1);}
+		virtual num_t pdf(num_t) const {throw std::domain_error("no pdf");}
+		virtual num_t cdf(num_t) const {throw std::domain_error("no cdf");}
+		virtual num_t quantile(num_t) const {throw std::domain_error("no quantile");}
+		virtual std::pair<num_t, num_t> support (num_t) const {return(std::pair<num_t, num_t>(-1, 1));}
+};
+
+class failing_posterior_arm: public multibeep::arms::base<num_t, rng_t>{
+	public:
+		virtual num_t pull() {return(0);}
+		virtual num_t real_mean() const {return(0);}
+		virtual num_t real_variance() const {return(1);}
+		virtual std::string get_ident() const {return("failing posterior");}
+		virtual bool provides_posterior() const {return(true);}
+		virtual std::shared_ptr<multibeep::util::posteriors::base<num_t, rng_t> > posterior() const {
+			return(std::make_shared<failing_posterior>());
+		}
+};
+
+// stands in for a python arm, which needs the GIL for its pulls
+class gil_arm: public failing_posterior_arm{
+	public:
+		virtual bool calls_python() const {return(true);}
+};
+
+BOOST_AUTO_TEST_CASE(test_number_of_python_arms){
+	std::shared_ptr<rng_t> rng_ptr = std::make_shared<rng_t> (rng_t () );
+	multibeep::bandits::empirical<num_t,rng_t> b;
+	b.add_arm(std::make_shared<multibeep::arms::normal_arm<num_t, rng_t> >(0., 1., rng_ptr));
+	BOOST_REQUIRE_EQUAL(b.number_of_python_arms(), 0);
+	b.add_arm(std::make_shared<gil_arm>());
+	b.add_arms({std::make_shared<gil_arm>(), std::make_shared<multibeep::arms::normal_arm<num_t, rng_t> >(0., 1., rng_ptr)});
+	BOOST_REQUIRE_EQUAL(b.number_of_python_arms(), 2);
+}
+
+BOOST_AUTO_TEST_CASE(test_background_pmax_error){
+	multibeep::bandits::posterior<num_t,rng_t> b;
+	for (auto i=0u; i < 2; i++)
+		b.add_arm(std::make_shared<failing_posterior_arm>());
+	auto w = std::make_shared<multibeep::util::pmax::background_worker<num_t, rng_t> >(0.01, 16);
+	b.set_background_pmax(w);
+	b.min_pull_arms(1);
+
+	// the exception of the worker thread is thrown once by the bandit
+	b.sync_background_pmax();
+	w->wait();
+	BOOST_REQUIRE_THROW(b.sync_background_pmax(), std::domain_error);
+	BOOST_REQUIRE(std::isnan(b[0].p_max));
+
+	// the worker keeps accepting snapshots
+	b.pull_by_index(0);
+	b.sync_background_pmax();
+	w->wait();
+	BOOST_REQUIRE_THROW(b[0], std::domain_error);
+	b.set_background_pmax(nullptr);
+}
+
+
+BOOST_AUTO_TEST_CASE(test_pmax_fast_paths){
+	typedef std::shared_ptr<multibeep::util::posteriors::base<num_t, rng_t> > post_t;
+	typedef multibeep::arms::bernoulli_arm<num_t, rng_t>::bernoulli_posterior beta_t;
+	typedef multibeep::util::posteriors::gaussian_posterior<num_t, rng_t> gaussian_t;
+
+	// gaussian: the closed form for two arms and Gauss-Legendre over +/- 6 sd otherwise, compared to a fine, barely truncated
+	// integration; the truncation to the 0.01 support alone costs the generic path more than 1e-3 here
+	std::vector<post_t> posts {post_t(new gaussian_t(0., 0.04)), post_t(new gaussian_t(0.1, 0.01))};
+	for (auto K=2u; K < 8; K++){
+		auto fast = multibeep::util::pmax::compute_pmax_all<num_t, rng_t>(posts, 0.01, 64);
+		auto exact = multibeep::util::pmax::compute_pmax_generic<num_t, rng_t>(posts, 1e-12, 512);
+		for (auto i=0u; i < K; i++)
+			BOOST_REQUIRE_SMALL(fast[i] - exact[i], 1e-4);
+		// an arm without a posterior is handled like in the generic path
+		posts.emplace_back(K == 4 ? post_t() : post_t(new gaussian_t(0.05*K, 0.02/K)));
+	}
+
+	// an arm 10 and 100 times narrower than the others: its steep cdf has to be resolved by splitting the interval;
+	// the references come from the trapezoidal rule on a fine grid
+	std::vector<std::vector<num_t> > references {{0.309411695, 0.690588289, 0.000000016}, {0.308546339, 0.691453647, 0.000000014}};
+	for (auto k=0u; k < 2; k++){
+		num_t sd = k == 0 ? 0.1 : 0.01;
+		posts = {post_t(new gaussian_t(0., 1.)), post_t(new gaussian_t(0.5, sd*sd)), post_t(new gaussian_t(-5., 1.))};
+		multibeep::util::pmax::pmax_report report;
+		auto fast = multibeep::util::pmax::compute_pmax_all<num_t, rng_t>(posts, 0.01, 32, &report);
+		for (auto i=0u; i < 3; i++)
+			BOOST_REQUIRE_SMALL(fast[i] - references[k][i], 1e-6);
+		// the split intervals take 32 nodes per piece
+		BOOST_REQUIRE(report.taken == multibeep::util::pmax::pmax_report::path::gaussian);
+		BOOST_REQUIRE_EQUAL(report.num_integrals, 3);
+		BOOST_REQUIRE(report.num_quadrature_nodes > 3*32);
+		BOOST_REQUIRE_EQUAL(report.num_quadrature_nodes % 32, 0);
+	}
+	// two arms take the closed form, without any node
+	multibeep::util::pmax::pmax_report closed_form;
+	posts.pop_back();
+	multibeep::util::pmax::compute_pmax_all<num_t, rng_t>(posts, 0.01, 32, &closed_form);
+	BOOST_REQUIRE(closed_form.taken == multibeep::util::pmax::pmax_report::path::gaussian_closed_form);
+	BOOST_REQUIRE_EQUAL(closed_form.num_quadrature_nodes, 0);
+
+	// beta: the same quadrature, only without the virtual calls
+	posts.clear();
+	for (auto K=1u; K < 12; K++){
+		posts.emplace_back(K == 6 ? post_t() : post_t(new beta_t(3*K, 20+K)));
+		auto fast = multibeep::util::pmax::compute_pmax_all<num_t, rng_t>(posts, 0.01, 32);
+		auto generic = multibeep::util::pmax::compute_pmax_generic<num_t, rng_t>(posts, 0.01, 32);
+		for (auto i=0u; i < K; i++)
+			BOOST_REQUIRE_SMALL(fast[i] - generic[i], 1e-12);
+	}
+
+	// mixed families take the generic path
+	posts.emplace_back(new gaussian_t(0.5, 1e-4));
+	multibeep::util::pmax::pmax_report report;
+	auto mixed = multibeep::util::pmax::compute_pmax_all<num_t, rng_t>(posts, 0.01, 32, &report);
+	auto generic = multibeep::util::pmax::compute_pmax_generic<num_t, rng_t>(posts, 0.01, 32);
+	for (auto i=0u; i < posts.size(); i++)
+		BOOST_REQUIRE_EQUAL(mixed[i], generic[i]);
+	// 11 posteriors, every node evaluates all of them
+	BOOST_REQUIRE(report.taken == multibeep::util::pmax::pmax_report::path::generic);
+	BOOST_REQUIRE_EQUAL(report.num_integrals, 11);
+	BOOST_REQUIRE_EQUAL(report.num_quadrature_nodes, 11*32);
+	BOOST_REQUIRE_EQUAL(report.num_posterior_evaluations, 11*11*32);
+}
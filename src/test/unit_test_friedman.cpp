@@ -1,5 +1,6 @@
 #include <vector>
 #include <iostream>
+#include <random>
 
 
 #include <boost/test/unit_test.hpp>
@@ -43,3 +44,67 @@ BOOST_AUTO_TEST_CASE(test_ranking){
 						true_ranks[3].begin(), true_ranks[3].end());
 }
 
+
+
+BOOST_AUTO_TEST_CASE(test_incremental_ranking){
+
+	std::vector<num_t> p1 = { 0, 0, 0, 0, 0, 0, 0, 0, 0};
+	std::vector<num_t> p2 = { 0, 1,-1, 1, 0, 1,-1, 0, 1};
+	std::vector<num_t> p3 = {-1, 1,-1, 1, 1, 1,-1, 0, 2};	
+	std::vector<num_t> p4 = { 1, 0, 1, 0, 1, 1,-1, 0, 3};
+	
+	std::vector< std::vector<num_t>* >performances = {&p1, &p2, &p3, &p4};
+
+	auto ranks = multibeep::util::friedman::compute_ranks(performances);
+
+	multibeep::util::friedman::incremental_friedman<num_t> f(4);
+	for (auto i=0u; i < p1.size(); i++)
+		f.add_round({p1[i], p2[i], p3[i], p4[i]});
+
+	BOOST_REQUIRE_EQUAL(f.number_of_rounds(), 9);
+	for (auto j=0u; j<4; j++){
+		num_t sum = 0, sum2 = 0;
+		for (auto r: ranks[j]){ sum += r; sum2 += r*r;}
+		BOOST_CHECK_EQUAL(f.rank_sums()[j], sum);
+		BOOST_CHECK_EQUAL(f.squared_rank_sums()[j], sum2);
+	}
+
+	// removing arms reranks all previous rounds among the remaining ones
+	f.remove({1,2});
+	BOOST_REQUIRE_EQUAL(f.number_of_arms(), 2);
+	std::vector< std::vector<num_t>* > remaining = {&p1, &p4};
+	ranks = multibeep::util::friedman::compute_ranks(remaining);
+	for (auto j=0u; j<2; j++){
+		num_t sum = 0;
+		for (auto r: ranks[j]) sum += r;
+		BOOST_CHECK_EQUAL(f.rank_sums()[j], sum);
+	}
+}
+
+
+BOOST_AUTO_TEST_CASE(test_friedman_test){
+
+	std::mt19937 rng(1234u);
+	std::normal_distribution<num_t> n(0,1);
+
+	// arm 2 is clearly worse, arm 0 and 1 are equivalent
+	std::vector<num_t> p1, p2, p3;
+	for (auto i=0u; i < 50; i++){
+		p1.push_back(n(rng));
+		p2.push_back(n(rng));
+		p3.push_back(n(rng) - 3);
+	}
+	std::vector< std::vector<num_t>* >performances = {&p1, &p2, &p3};
+
+	auto worse = multibeep::util::friedman::friedman_test(performances, 0.05);
+	BOOST_REQUIRE_EQUAL(worse.size(), 1);
+	BOOST_REQUIRE_EQUAL(worse[0], 2);
+
+	// no arm can be significantly worse than itself
+	std::vector< std::vector<num_t>* >same = {&p1, &p1};
+	BOOST_REQUIRE(multibeep::util::friedman::friedman_test(same, 0.05).empty());
+
+	// nothing to compare
+	BOOST_REQUIRE(multibeep::util::friedman::compute_ranks(std::vector< std::vector<num_t>* >()).empty());
+	BOOST_REQUIRE(multibeep::util::friedman::friedman_test(std::vector< std::vector<num_t>* >(), num_t(0.05)).empty());
+}
@@ -1,4 +1,11 @@
 #include <random>
+#include <cstdio>
+#include <string>
+#include <stdexcept>
+#include <stdlib.h>
+#include <unistd.h>
+#include <chrono>
+#include <thread>
 
 #include <boost/test/unit_test.hpp>
 
@@ -6,6 +13,14 @@
 #include "multibeep/policy/prob_match.hpp"
 #include "multibeep/policy/ucbp.hpp"
 #include "multibeep/policy/successive_halving.hpp"
+#include "multibeep/policy/hyperband.hpp"
+#include "multibeep/policy/asynchronous_successive_halving.hpp"
+#include "multibeep/policy/f_race.hpp"
+#include "multibeep/policy/lucb.hpp"
+#include "multibeep/policy/replay.hpp"
+#include "multibeep/policy/cost_aware.hpp"
+#include "multibeep/simulation/arms.hpp"
+#include "multibeep/simulation/policies.hpp"
 
 
 #include "multibeep/bandit/empirical_bandits.hpp"
@@ -14,10 +29,24 @@
 
 
 
-typedef boost::random::mt19937 rng_t;
+typedef std::mt19937 rng_t;
 typedef double num_t;
 
 
+// a new, empty file that is removed at the end of the scope, even if a check fails
+struct temporary_file{
+	std::string name;
+	temporary_file(){
+		char tmp[] = "/tmp/multibeep_test_XXXXXX";
+		int fd = mkstemp(tmp);
+		if (fd == -1) throw std::runtime_error("Could not create a temporary file");
+		close(fd);
+		name = tmp;
+	}
+	~temporary_file(){ std::remove(name.c_str());}
+};
+
+
 template <typename policy_t, typename bandit_t, typename ... T>
 void test (unsigned int num_arms, unsigned int num_rounds, unsigned int expected_num_pulls, T...t){
 
@@ -89,3 +118,556 @@ BOOST_AUTO_TEST_CASE(test_succesive_halving){
 }
 
 
+
+
+
+BOOST_AUTO_TEST_CASE(test_hyperband){
+
+	typedef multibeep::policies::hyperband<num_t, rng_t> hb_t;
+
+	auto bandit_factory = [] () {
+		return(hb_t::bandit_ptr_t (new multibeep::bandits::empirical<num_t, rng_t>()));
+	};
+	auto arm_sampler = [] (std::shared_ptr<rng_t> r_ptr) {
+		std::uniform_real_distribution<num_t> u (-1,1);
+		num_t mean = u(*r_ptr);
+		return(hb_t::arm_ptr_t (new multibeep::arms::normal_arm<num_t,rng_t> (mean, u(*r_ptr)+1, r_ptr)));
+	};
+
+	std::vector<unsigned int> expected_num_arms = {27, 12, 6, 4};
+	std::vector<unsigned int> expected_num_pulls = {1, 3, 9, 27};
+
+	auto rng1 = std::make_shared<rng_t> (1234u);
+	auto rng2 = std::make_shared<rng_t> (1234u);
+
+	hb_t sequential (bandit_factory, arm_sampler, rng1, 27, 3, 1);
+	hb_t concurrent (bandit_factory, arm_sampler, rng2, 27, 3, 4);
+
+	BOOST_REQUIRE_EQUAL(sequential.get_s_max(), 3);
+
+	sequential.play_n_rounds(2);
+	concurrent.play_n_rounds(2);
+
+	BOOST_REQUIRE_EQUAL(sequential.number_of_brackets(), 8);
+	BOOST_REQUIRE_EQUAL(concurrent.number_of_brackets(), 8);
+
+	for (auto i=0u; i < sequential.number_of_brackets(); ++i){
+		auto b1 = sequential.get_bracket(i);
+		auto b2 = concurrent.get_bracket(i);
+		unsigned int s = 3 - i%4;
+
+		BOOST_REQUIRE_EQUAL(b1->number_of_arms(), expected_num_arms[i%4]);
+		BOOST_REQUIRE_EQUAL(sequential.number_of_pulls(s), expected_num_pulls[i%4]);
+		BOOST_REQUIRE(b1->number_of_active_arms() >= 1);
+
+		// the schedule does not depend on the number of threads
+		BOOST_REQUIRE_EQUAL(b1->number_of_pulls(), b2->number_of_pulls());
+		BOOST_REQUIRE_EQUAL(b1->number_of_active_arms(), b2->number_of_active_arms());
+		for (auto j=0u; j < b1->number_of_active_arms(); ++j)
+			BOOST_REQUIRE_EQUAL((*b1)[j].identifier, (*b2)[j].identifier);
+	}
+
+	// callbacks that fail to deliver (e.g. the Python bindings after an exception) are reported, not dereferenced
+	hb_t no_bandit ([] () {return(hb_t::bandit_ptr_t());}, arm_sampler, rng1, 27, 3, 1);
+	BOOST_REQUIRE_THROW(no_bandit.play_n_rounds(1), std::runtime_error);
+	hb_t no_arm (bandit_factory, [] (std::shared_ptr<rng_t>) {return(hb_t::arm_ptr_t());}, rng1, 27, 3, 1);
+	BOOST_REQUIRE_THROW(no_arm.play_n_rounds(1), std::runtime_error);
+	BOOST_REQUIRE_EQUAL(no_arm.number_of_brackets(), 0);
+}
+
+
+
+BOOST_AUTO_TEST_CASE(test_asynchronous_successive_halving){
+
+	auto rng_ptr = std::make_shared<rng_t> (1234u);
+	std::uniform_real_distribution<num_t> u (-1,1);
+
+	auto bandit_ptr = std::make_shared<multibeep::bandits::empirical<num_t, rng_t> >();
+	for (auto i=0u; i < 27; i++)
+		bandit_ptr->add_arm(std::shared_ptr<multibeep::arms::base<num_t, rng_t> > (new multibeep::arms::normal_arm<num_t,rng_t> (u(*rng_ptr),u(*rng_ptr)+1, rng_ptr)));
+
+	multibeep::policies::asynchronous_successive_halving<num_t, rng_t> policy(bandit_ptr, 2, 3, 54);
+	BOOST_REQUIRE_EQUAL(policy.get_max_rung(), 3);
+
+	// two workers get different arms without waiting for each other
+	auto j1 = policy.next_job();
+	auto j2 = policy.next_job();
+	BOOST_REQUIRE(j1.valid() && j2.valid());
+	BOOST_REQUIRE(j1.identifier != j2.identifier);
+	BOOST_REQUIRE_EQUAL(j1.num_pulls, 2);
+	BOOST_REQUIRE_EQUAL(policy.number_of_running_jobs(), 2);
+
+	for (auto &j: {j2, j1}){
+		for (auto i=0u; i< j.num_pulls; i++)
+			policy.pull_job(j);
+		policy.complete_job(j);
+	}
+	BOOST_REQUIRE_EQUAL(policy.number_of_running_jobs(), 0);
+
+	// completed and made up jobs are rejected
+	BOOST_REQUIRE_THROW(policy.complete_job(j1), std::invalid_argument);
+	BOOST_REQUIRE_THROW(policy.pull_job(j1), std::invalid_argument);
+	BOOST_REQUIRE_THROW(policy.complete_job(multibeep::policies::rung_job(100, 0, 2)), std::invalid_argument);
+	BOOST_REQUIRE_EQUAL(policy.number_of_running_jobs(), 0);
+	BOOST_REQUIRE_EQUAL(policy.number_of_arms_in_rung(0), 2);
+	BOOST_REQUIRE_EQUAL(policy.number_of_arms_in_rung(0), 2);
+	BOOST_REQUIRE_EQUAL(bandit_ptr->number_of_active_arms(), 25);
+
+	// play until no more job is available
+	policy.play_n_rounds(1000);
+
+	BOOST_REQUIRE_EQUAL(policy.number_of_arms_in_rung(0), 27);
+	BOOST_REQUIRE(policy.number_of_arms_in_rung(1) >= 9);
+	BOOST_REQUIRE(policy.number_of_arms_in_rung(2) >= 3);
+	BOOST_REQUIRE(policy.number_of_arms_in_rung(3) >= 1);
+	BOOST_REQUIRE_EQUAL(bandit_ptr->number_of_active_arms(), 0);
+
+	unsigned int expected_num_pulls = 0;
+	for (auto k=0u; k <= policy.get_max_rung(); ++k)
+		expected_num_pulls += policy.number_of_arms_in_rung(k) * (policy.number_of_pulls(k) - (k>0? policy.number_of_pulls(k-1) : 0));
+	BOOST_REQUIRE_EQUAL(bandit_ptr->number_of_pulls(), expected_num_pulls);
+
+	auto best = policy.best_identifier();
+	auto &ai = (*bandit_ptr)[bandit_ptr->index_by_identifier(best)];
+	BOOST_REQUIRE_EQUAL(ai.num_pulls, policy.number_of_pulls(3));
+}
+
+
+
+BOOST_AUTO_TEST_CASE(test_asynchronous_successive_halving_threads){
+
+	// the arms are pulled concurrently, so each gets its own random number generator
+	auto bandit_ptr = std::make_shared<multibeep::bandits::empirical<num_t, rng_t> >();
+	for (auto i=0u; i < 81; i++)
+		bandit_ptr->add_arm(std::shared_ptr<multibeep::arms::base<num_t, rng_t> > (new multibeep::arms::normal_arm<num_t,rng_t> (i/81., 1, std::make_shared<rng_t>(1234u+i))));
+
+	multibeep::policies::asynchronous_successive_halving<num_t, rng_t> policy(bandit_ptr, 1, 3, 27);
+
+	// workers only touch the bandit through the policy; a worker stops once nothing is left to do
+	auto worker = [&policy] (){
+		while (true){
+			auto job = policy.next_job();
+			if (!job.valid()){
+				if (policy.number_of_running_jobs() == 0) break;
+				std::this_thread::yield();
+				continue;
+			}
+			for (auto i=0u; i < job.num_pulls; ++i)
+				policy.pull_job(job);
+			policy.complete_job(job);
+		}
+	};
+	std::vector<std::thread> pool;
+	for (auto i=0u; i < 4; ++i)
+		pool.emplace_back(worker);
+	for (auto &t: pool)
+		t.join();
+
+	BOOST_REQUIRE_EQUAL(policy.number_of_arms_in_rung(0), 81);
+	BOOST_REQUIRE_EQUAL(bandit_ptr->number_of_active_arms(), 0);
+	unsigned int expected_num_pulls = 0;
+	for (auto k=0u; k <= policy.get_max_rung(); ++k)
+		expected_num_pulls += policy.number_of_arms_in_rung(k) * (policy.number_of_pulls(k) - (k>0? policy.number_of_pulls(k-1) : 0));
+	BOOST_REQUIRE_EQUAL(bandit_ptr->number_of_pulls(), expected_num_pulls);
+}
+
+
+// an arm whose pulls take a while, like an expensive evaluation; the reward is its mean
+class sleeping_arm: public multibeep::arms::base<num_t, rng_t>{
+	protected:
+		num_t mean;
+		std::chrono::milliseconds duration;
+	public:
+		sleeping_arm(num_t m, unsigned int ms): mean(m), duration(ms) {}
+		virtual num_t pull() {std::this_thread::sleep_for(duration); return(mean);}
+		virtual num_t real_mean() const {return(mean);}
+		virtual num_t real_variance() const {return(0);}
+		virtual std::string get_ident() const {return("sleeping");}
+};
+
+BOOST_AUTO_TEST_CASE(test_asynchronous_successive_halving_overlap){
+
+	// arms of very different costs
+	auto cost = [] (unsigned int id) {return(1 + (7*id)%9);};
+	auto bandit_ptr = std::make_shared<multibeep::bandits::empirical<num_t, rng_t> >();
+	for (auto i=0u; i < 27; i++)
+		bandit_ptr->add_arm(std::make_shared<sleeping_arm>(i/27., cost(i)));
+
+	multibeep::policies::asynchronous_successive_halving<num_t, rng_t> policy(bandit_ptr, 1, 3, 9);
+
+	auto worker = [&policy] (){
+		while (true){
+			auto job = policy.next_job();
+			if (!job.valid()){
+				if (policy.number_of_running_jobs() == 0) break;
+				std::this_thread::sleep_for(std::chrono::microseconds(100));
+				continue;
+			}
+			for (auto i=0u; i < job.num_pulls; ++i)
+				policy.pull_job(job);
+			policy.complete_job(job);
+		}
+	};
+	auto start = std::chrono::steady_clock::now();
+	std::vector<std::thread> pool;
+	for (auto i=0u; i < 4; ++i)
+		pool.emplace_back(worker);
+	for (auto &t: pool)
+		t.join();
+	auto wall = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+
+	BOOST_REQUIRE_EQUAL(policy.number_of_arms_in_rung(0), 27);
+	unsigned int total_cost = 0;
+	for (auto i=0u; i < bandit_ptr->number_of_arms(); i++)
+		total_cost += (*bandit_ptr)[i].num_pulls * cost((*bandit_ptr)[i].identifier);
+	// the four workers evaluate their arms at the same time
+	BOOST_REQUIRE(wall < total_cost/2);
+}
+
+
+
+BOOST_AUTO_TEST_CASE(test_f_race){
+
+	auto rng_ptr = std::make_shared<rng_t> (1234u);
+
+	auto bandit_ptr = std::make_shared<multibeep::bandits::empirical<num_t, rng_t> >();
+	for (auto i=0u; i < 16; i++)
+		bandit_ptr->add_arm(std::shared_ptr<multibeep::arms::base<num_t, rng_t> > (new multibeep::arms::normal_arm<num_t,rng_t> (i/4., 1, rng_ptr)));
+
+	multibeep::policies::f_race<num_t, rng_t> policy(bandit_ptr, 0.05, 5);
+
+	policy.play_n_rounds(4);
+	BOOST_REQUIRE_EQUAL(policy.number_of_racers(), 16);
+	BOOST_REQUIRE_EQUAL(bandit_ptr->number_of_pulls(), 64);
+
+	policy.play_n_rounds(200);
+	BOOST_REQUIRE(policy.number_of_racers() < 16);
+	BOOST_REQUIRE_EQUAL(policy.number_of_racers(), bandit_ptr->number_of_active_arms());
+
+	// the best arm survives
+	bool best_active = false;
+	for (auto i=0u; i < bandit_ptr->number_of_active_arms(); i++)
+		best_active |= ((*bandit_ptr)[i].identifier == 15);
+	BOOST_REQUIRE(best_active);
+}
+
+
+
+BOOST_AUTO_TEST_CASE(test_lucb){
+
+	auto rng_ptr = std::make_shared<rng_t> (1234u);
+
+	auto bandit_ptr = std::make_shared<multibeep::bandits::empirical<num_t, rng_t> >();
+	for (auto i=0u; i < 8; i++)
+		bandit_ptr->add_arm(std::shared_ptr<multibeep::arms::base<num_t, rng_t> > (new multibeep::arms::normal_arm<num_t,rng_t> (i/8., 0.1, rng_ptr)));
+
+	multibeep::policies::LUCB<num_t, rng_t> policy(bandit_ptr, 0.05);
+
+	BOOST_REQUIRE(!policy.finished());
+	policy.play_n_rounds(100000);
+
+	BOOST_REQUIRE(policy.finished());
+	BOOST_REQUIRE(bandit_ptr->number_of_pulls() < 100000);
+	BOOST_REQUIRE_EQUAL(policy.best_identifier(), 7);
+
+	// the leader and the challenger get most of the pulls
+	auto &best = (*bandit_ptr)[bandit_ptr->index_by_identifier(7)];
+	auto &worst = (*bandit_ptr)[bandit_ptr->index_by_identifier(0)];
+	BOOST_REQUIRE(best.num_pulls > worst.num_pulls);
+
+	// further rounds do not pull anymore
+	auto n = bandit_ptr->number_of_pulls();
+	policy.play_n_rounds(10);
+	BOOST_REQUIRE_EQUAL(bandit_ptr->number_of_pulls(), n);
+}
+
+
+BOOST_AUTO_TEST_CASE(test_deactivate_by_confidence_gap){
+
+	auto rng_ptr = std::make_shared<rng_t> (1234u);
+
+	auto bandit_ptr = std::make_shared<multibeep::bandits::empirical<num_t, rng_t> >();
+	for (auto i=0u; i < 8; i++)
+		bandit_ptr->add_arm(std::shared_ptr<multibeep::arms::base<num_t, rng_t> > (new multibeep::arms::normal_arm<num_t,rng_t> (i, 0.1, rng_ptr)));
+
+	bandit_ptr->min_pull_arms(20);
+	bandit_ptr->deactivate_by_confidence_gap(0.01, false);
+
+	BOOST_REQUIRE_EQUAL(bandit_ptr->number_of_active_arms(), 1);
+	BOOST_REQUIRE_EQUAL((*bandit_ptr)[0].identifier, 7);
+	for (auto i=1u; i < bandit_ptr->number_of_arms(); i++)
+		BOOST_REQUIRE(!(*bandit_ptr)[i].is_active);
+}
+
+
+
+BOOST_AUTO_TEST_CASE(test_checkpoint){
+
+	// the arms and the policy share one generator, so restoring the policy restores the arms' generator, too
+	auto make_bandit = [] (std::shared_ptr<rng_t> rng_ptr){
+		auto b = std::make_shared<multibeep::bandits::empirical<num_t, rng_t> >();
+		for (auto i=0u; i < 16; i++)
+			b->add_arm(std::shared_ptr<multibeep::arms::base<num_t, rng_t> > (new multibeep::arms::normal_arm<num_t,rng_t> (i/16., 1, rng_ptr)));
+		return(b);
+	};
+
+	auto rng1 = std::make_shared<rng_t> (1234u);
+	auto rng2 = std::make_shared<rng_t> (42u);
+	auto b1 = make_bandit(rng1);
+	auto b2 = make_bandit(rng2);
+
+	multibeep::policies::UCB_p<num_t, rng_t> p1(b1, rng1, 1);
+	multibeep::policies::UCB_p<num_t, rng_t> p2(b2, rng2, 1);
+
+	p1.play_n_rounds(500);
+	auto bs = b1->checkpoint();
+	auto ps = p1.checkpoint();
+	b2->restore(bs.data(), bs.size());
+	p2.restore(ps.data(), ps.size());
+
+	// the resumed run is identical to the original one
+	p1.play_n_rounds(500);
+	p2.play_n_rounds(500);
+	BOOST_REQUIRE_EQUAL(b1->number_of_pulls(), b2->number_of_pulls());
+	for (auto id=0u; id < b1->number_of_arms(); id++){
+		auto &a1 = (*b1)[b1->index_by_identifier(id)];
+		auto &a2 = (*b2)[b2->index_by_identifier(id)];
+		BOOST_REQUIRE(a1.rewards == a2.rewards);
+	}
+
+	// a bandit snapshot is not a policy snapshot
+	BOOST_REQUIRE_THROW(p2.restore(bs.data(), bs.size()), std::runtime_error);
+
+	// F-Race resumes with the same racers and rounds
+	multibeep::policies::f_race<num_t, rng_t> r1(b1, 0.05, 5);
+	multibeep::policies::f_race<num_t, rng_t> r2(b2, 0.05, 5);
+	r1.play_n_rounds(20);
+	bs = b1->checkpoint();
+	ps = r1.checkpoint();
+	b2->restore(bs.data(), bs.size());
+	r2.restore(ps.data(), ps.size());
+	BOOST_REQUIRE_EQUAL(r2.number_of_racers(), r1.number_of_racers());
+	BOOST_REQUIRE_EQUAL(r2.number_of_rounds(), r1.number_of_rounds());
+	r2.play_n_rounds(1);
+	BOOST_REQUIRE_EQUAL(r2.number_of_rounds(), r1.number_of_rounds()+1);
+
+	// successive halving continues with the number of pulls of the interrupted round
+	auto rng3 = std::make_shared<rng_t> (1234u);
+	auto rng4 = std::make_shared<rng_t> (42u);
+	auto b3 = make_bandit(rng3);
+	auto b4 = make_bandit(rng4);
+	multibeep::policies::successive_halving<num_t, rng_t> sh1(b3, 4, 2);
+	multibeep::policies::successive_halving<num_t, rng_t> sh2(b4, 4, 2);
+	sh1.play_n_rounds(2);
+	bs = b3->checkpoint();
+	ps = sh1.checkpoint();
+	b4->restore(bs.data(), bs.size());
+	sh2.restore(ps.data(), ps.size());
+	BOOST_REQUIRE_EQUAL(sh2.number_of_rounds(), 2);
+	sh1.play_n_rounds(2);
+	sh2.play_n_rounds(2);
+	// 16*4 + 8*8 + 4*16 + 2*32 pulls, just as if all four rounds were played at once
+	BOOST_REQUIRE_EQUAL(b3->number_of_pulls(), 256);
+	BOOST_REQUIRE_EQUAL(b4->number_of_pulls(), 256);
+	BOOST_REQUIRE_EQUAL(b4->number_of_active_arms(), 1);
+}
+
+
+
+BOOST_AUTO_TEST_CASE(test_pull_log_replay){
+
+	auto arm_rng = std::make_shared<rng_t> (1u);
+	temporary_file tmp;
+	std::string fn = tmp.name;
+
+	// record a run, the small buffer results in several blocks
+	auto b1 = std::make_shared<multibeep::bandits::empirical<num_t, rng_t> >();
+	for (auto i=0u; i < 8; i++)
+		b1->add_arm(std::shared_ptr<multibeep::arms::base<num_t, rng_t> > (new multibeep::arms::normal_arm<num_t,rng_t> (i/8., 1, arm_rng)));
+	{
+		auto log_ptr = std::make_shared<multibeep::util::pull_log<num_t> > (fn, 7);
+		b1->set_pull_log(log_ptr);
+		multibeep::policies::UCB_p<num_t, rng_t> p1(b1, std::make_shared<rng_t>(2u), 1);
+		p1.play_n_rounds(100);
+		b1->pull_batch_by_index(0, 3);
+		b1->set_pull_log(nullptr);
+	}
+	b1->pull_by_index(0);
+
+	auto records = multibeep::util::read_pull_log<num_t>(fn);
+	BOOST_REQUIRE_EQUAL(records.size(), 103);
+	for (auto i=0u; i < records.size(); i++){
+		BOOST_REQUIRE_EQUAL(records.pull_index[i], i);
+		BOOST_REQUIRE(records.timestamp[i] >= records.timestamp[i>0 ? i-1 : 0]);
+	}
+	auto &a0 = (*b1)[b1->index_by_identifier(records.identifier[0])];
+	BOOST_REQUIRE_EQUAL(records.reward[0], a0.rewards[0]);
+
+	// the same policy replayed on the recorded rewards makes the same decisions
+	auto b2 = std::make_shared<multibeep::bandits::empirical<num_t, rng_t> >();
+	multibeep::policies::add_replay_arms(*b2, fn);
+	BOOST_REQUIRE_EQUAL(b2->number_of_arms(), 8);
+	multibeep::policies::UCB_p<num_t, rng_t> p2(b2, std::make_shared<rng_t>(2u), 1);
+	BOOST_REQUIRE(multibeep::policies::replay_n_rounds(p2, 100));
+	for (auto id=0u; id < 8; id++){
+		auto &r1 = (*b1)[b1->index_by_identifier(id)].rewards;
+		auto &r2 = (*b2)[b2->index_by_identifier(id)].rewards;
+		BOOST_REQUIRE(std::equal(r2.begin(), r2.end(), r1.begin()));
+	}
+
+	// eventually the recorded rewards run out, without corrupting the bandit
+	BOOST_REQUIRE(!multibeep::policies::replay_n_rounds(p2, 1000));
+	auto n = b2->number_of_pulls();
+	BOOST_REQUIRE(n < 103);
+	num_t sum = 0;
+	for (auto i=0u; i < b2->number_of_arms(); i++)
+		sum += (*b2)[i].num_pulls;
+	BOOST_REQUIRE_EQUAL(sum, n);
+}
+
+
+BOOST_AUTO_TEST_CASE(test_stats){
+	std::shared_ptr<rng_t> rng_ptr = std::make_shared<rng_t> (1234u);
+	auto b = std::make_shared<multibeep::bandits::empirical<num_t, rng_t> >();
+	for (auto i=0u; i < 8; i++)
+		b->add_arm(std::shared_ptr<multibeep::arms::base<num_t, rng_t> > (new multibeep::arms::normal_arm<num_t,rng_t> (0.1*i, 1, rng_ptr)));
+
+	multibeep::policies::UCB_p<num_t, rng_t> p(b, rng_ptr, 0.1);
+	p.enable_stats(true);
+	b->enable_stats(true);
+	p.play_n_rounds(50);
+
+	if (multibeep::util::instrumentation::compiled_in){
+		BOOST_REQUIRE_EQUAL(p.get_stats().num_selections, 50);
+		BOOST_REQUIRE_EQUAL(b->get_stats().num_pulls, 50);
+		BOOST_REQUIRE(b->get_stats().num_arm_info_updates >= 50);
+	}
+	p.reset_stats();
+	BOOST_REQUIRE_EQUAL(p.get_stats().num_selections, 0);
+}
+
+
+// normal arm whose pulls take (at least) the given time
+class slow_arm: public multibeep::arms::normal_arm<num_t, rng_t>{
+	std::chrono::microseconds duration;
+  public:
+	slow_arm(num_t mean, unsigned int microseconds, std::shared_ptr<rng_t> rng_ptr):
+		multibeep::arms::normal_arm<num_t, rng_t>(mean, 0.25, rng_ptr), duration(microseconds) {}
+
+	virtual num_t pull(){
+		auto end = std::chrono::steady_clock::now() + duration;
+		while (std::chrono::steady_clock::now() < end);
+		return(multibeep::arms::normal_arm<num_t, rng_t>::pull());
+	}
+};
+
+
+template <typename policy_t, typename ... T>
+void test_cost_aware(T ... t){
+	std::shared_ptr<rng_t> rng_ptr = std::make_shared<rng_t> (1234u);
+	auto b = std::make_shared<multibeep::bandits::empirical<num_t, rng_t> >();
+	// both arms are equally good, but one is much more expensive
+	b->add_arm(std::make_shared<slow_arm>(0, 0, rng_ptr));
+	b->add_arm(std::make_shared<slow_arm>(0, 500, rng_ptr));
+
+	policy_t p(b, rng_ptr, t...);
+	p.play_n_rounds(200);
+
+	auto cheap = b->index_by_identifier(0), expensive = b->index_by_identifier(1);
+	BOOST_REQUIRE_GT((*b)[expensive].pull_latency.mean_seconds(), 4e-4);
+	BOOST_REQUIRE_LT((*b)[cheap].pull_latency.mean_seconds(), 4e-4);
+	BOOST_REQUIRE_EQUAL((*b)[cheap].pull_latency.count(), (*b)[cheap].num_pulls);
+	BOOST_REQUIRE_GT((*b)[cheap].num_pulls, 4*(*b)[expensive].num_pulls);
+}
+
+
+BOOST_AUTO_TEST_CASE(test_cost_aware_policies){
+	multibeep::util::latency_histogram h;
+	BOOST_REQUIRE(std::isnan(h.mean_seconds()));
+	h(0); h(1000, 2); h(3000);
+	BOOST_REQUIRE_EQUAL(h.count(), 4);
+	BOOST_REQUIRE_CLOSE(h.mean_seconds(), 1.25e-6, 1e-6);
+	BOOST_REQUIRE_EQUAL(h.buckets()[0], 1);
+	BOOST_REQUIRE_EQUAL(h.quantile_ns(0.5), 1023);
+	BOOST_REQUIRE_EQUAL(h.quantile_ns(1), 4095);
+
+	test_cost_aware<multibeep::policies::cost_aware_UCB_p<num_t, rng_t> >(num_t(1));
+	test_cost_aware<multibeep::policies::cost_aware_prob_match<num_t, rng_t> >();
+}
+
+
+BOOST_AUTO_TEST_CASE(test_play_for_until_and_pmax_scheduler){
+	std::shared_ptr<rng_t> rng_ptr = std::make_shared<rng_t> (1234u);
+	auto b = std::make_shared<multibeep::bandits::empirical<num_t, rng_t> >();
+	for (auto i=0u; i < 8; i++)
+		b->add_arm(std::shared_ptr<multibeep::arms::base<num_t, rng_t> > (new multibeep::arms::normal_arm<num_t,rng_t> (i, 1, rng_ptr)));
+	multibeep::policies::UCB_p<num_t, rng_t> p(b, rng_ptr, 0.1);
+
+	BOOST_REQUIRE_EQUAL(p.play_until([&b] () {return(b->number_of_pulls() >= 100);}), 100);
+	BOOST_REQUIRE_EQUAL(p.play_until([] () {return(false);}, 10), 10);
+	BOOST_REQUIRE_EQUAL(b->number_of_pulls(), 110);
+
+	auto start = std::chrono::steady_clock::now();
+	auto n = p.play_for(std::chrono::milliseconds(20));
+	BOOST_REQUIRE(std::chrono::steady_clock::now() - start >= std::chrono::milliseconds(20));
+	BOOST_REQUIRE_GT(n, 0);
+	BOOST_REQUIRE_EQUAL(b->number_of_pulls(), 110 + n);
+
+	// a refresh every 50 pulls; the bad arms get deactivated on the way
+	auto s = std::make_shared<multibeep::bandits::pmax_scheduler<num_t, rng_t> >(50, 0, 1., 0.01, 32, false, 1e-3);
+	p.set_pmax_scheduler(s);
+	p.play_n_rounds(500);
+	BOOST_REQUIRE_EQUAL(s->number_of_refreshes(), 10);
+	BOOST_REQUIRE_LT(b->number_of_active_arms(), 8);
+
+	// without any budget, only the first refresh happens
+	auto s2 = std::make_shared<multibeep::bandits::pmax_scheduler<num_t, rng_t> >(10, 0, 0.);
+	p.set_pmax_scheduler(s2);
+	p.play_n_rounds(100);
+	BOOST_REQUIRE_EQUAL(s2->number_of_refreshes(), 1);
+
+	// drift alone triggers refreshes, but far less often than every pull
+	auto s3 = std::make_shared<multibeep::bandits::pmax_scheduler<num_t, rng_t> >(0, 1, 1.);
+	p.set_pmax_scheduler(s3);
+	for (auto i=0u; i < 200; ++i) p.play_round();
+	BOOST_REQUIRE_GT(s3->number_of_refreshes(), 0);
+	BOOST_REQUIRE_LT(s3->number_of_refreshes(), 200);
+}
+
+
+
+// plays the same rounds with a dynamic and a compile-time composition and compares the pulls
+template <typename static_policy_t, typename dynamic_policy_t, typename ... T>
+void test_static_composition(T ... t){
+	typedef multibeep::simulation::empirical<multibeep::simulation::normal_arm<num_t>, num_t, rng_t> static_bandit_t;
+	auto arm_rng1 = std::make_shared<rng_t>(42u), policy_rng1 = std::make_shared<rng_t>(7u);
+	auto arm_rng2 = std::make_shared<rng_t>(42u), policy_rng2 = std::make_shared<rng_t>(7u);
+
+	auto b1 = std::make_shared<multibeep::bandits::empirical<num_t, rng_t> >();
+	auto b2 = std::make_shared<static_bandit_t>(arm_rng2);
+	for (auto i=0u; i < 8; i++){
+		b1->add_arm(std::make_shared<multibeep::arms::normal_arm<num_t, rng_t> >(0.1*i, 1., arm_rng1));
+		b2->add_arm(multibeep::simulation::normal_arm<num_t>(0.1*i, 1.));
+	}
+
+	dynamic_policy_t p1(b1, policy_rng1, t...);
+	static_policy_t p2(b2, policy_rng2, t...);
+	p1.play_n_rounds(500);
+	p2.play_n_rounds(500);
+
+	BOOST_REQUIRE_EQUAL(b1->number_of_pulls(), b2->number_of_pulls());
+	BOOST_REQUIRE_EQUAL(b1->number_of_pulled_arms(), b2->number_of_pulled_arms());
+	for (auto i=0u; i < 8; i++){
+		BOOST_REQUIRE_EQUAL((*b1)[i].num_pulls, (*b2)[i].num_pulls);
+		BOOST_REQUIRE_CLOSE((*b1)[i].estimated_mean, (*b2)[i].estimated_mean, 1e-10);
+		BOOST_REQUIRE_EQUAL((*b2)[i].arm.real_mean(), (*b1)[i].get_arm_ptr()->real_mean());
+	}
+}
+
+
+BOOST_AUTO_TEST_CASE(test_static_compositions){
+	typedef multibeep::simulation::empirical<multibeep::simulation::normal_arm<num_t>, num_t, rng_t> static_bandit_t;
+	test_static_composition<multibeep::simulation::UCB_p<static_bandit_t>, multibeep::policies::UCB_p<num_t, rng_t> >(num_t(0.05));
+	test_static_composition<multibeep::simulation::prob_match<static_bandit_t>, multibeep::policies::prob_match<num_t, rng_t> >();
+	test_static_composition<multibeep::simulation::random<static_bandit_t>, multibeep::policies::random<num_t, rng_t> >();
+}
@@ -0,0 +1,178 @@
+#include <random>
+#include <memory>
+#include <vector>
+#include <numeric>
+#include <algorithm>
+
+#include <boost/test/unit_test.hpp>
+
+#include "multibeep/bandit/empirical_bandits.hpp"
+#include "multibeep/arm/normal.hpp"
+
+#include "multibeep/recommender/highest_mean.hpp"
+#include "multibeep/recommender/most_pulled.hpp"
+#include "multibeep/recommender/highest_lower_bound.hpp"
+#include "multibeep/recommender/highest_pmax.hpp"
+#include "multibeep/recommender/top_k.hpp"
+
+
+typedef std::default_random_engine rng_t;
+typedef double num_t;
+typedef multibeep::bandits::empirical<num_t, rng_t> bandit_t;
+
+
+std::shared_ptr<bandit_t> make_bandit(std::shared_ptr<rng_t> rng_ptr, unsigned int K){
+	auto b = std::make_shared<bandit_t>();
+	for (auto i=0u; i < K; i++)
+		b->add_arm(std::make_shared<multibeep::arms::normal_arm<num_t, rng_t> >(0.1*i, 1., rng_ptr));
+	return(b);
+}
+
+
+// the identifier with the largest value by brute force, the smaller identifier wins ties
+template <typename F>
+unsigned int brute_force_best(bandit_t &b, F f){
+	num_t best = NAN;
+	unsigned int best_id = b.number_of_arms();
+	for (auto i=0u; i < b.number_of_arms(); i++){
+		auto &ai = b[i];
+		num_t v = f(ai);
+		if (std::isnan(v)) continue;
+		if (std::isnan(best) || (v > best) || ((v == best) && (ai.identifier < best_id))){
+			best = v;
+			best_id = ai.identifier;
+		}
+	}
+	return(best_id);
+}
+
+
+BOOST_AUTO_TEST_CASE(test_recommenders_follow_the_pulls){
+	auto rng_ptr = std::make_shared<rng_t>(1234u);
+	auto b = make_bandit(rng_ptr, 6);
+
+	auto mean = std::make_shared<multibeep::recommender::highest_mean<num_t, rng_t> >();
+	auto pulled = std::make_shared<multibeep::recommender::most_pulled<num_t, rng_t> >();
+	auto lcb = std::make_shared<multibeep::recommender::highest_lower_bound<num_t, rng_t> >(0.05);
+
+	// attached before and after the first pulls
+	b->add_recommender(mean);
+	BOOST_REQUIRE(!mean->has_recommendation());
+	BOOST_REQUIRE(std::isnan(mean->instantaneous_regret()));
+	BOOST_REQUIRE_THROW(mean->best_identifier(), std::runtime_error);
+	b->min_pull_arms(3);
+	b->add_recommender(pulled);
+	b->add_recommender(lcb);
+
+	std::uniform_int_distribution<unsigned int> u(0, 5);
+	for (auto n=0u; n < 500; n++){
+		b->pull_by_index(u(*rng_ptr) % b->number_of_active_arms());
+		if (n == 250) b->deactivate_by_identifier(5);
+
+		BOOST_REQUIRE_EQUAL(mean->best_identifier(), brute_force_best(*b, [] (const multibeep::bandits::arm_info<num_t, rng_t> &ai) {return(ai.estimated_mean);}));
+		BOOST_REQUIRE_EQUAL(pulled->best_identifier(), brute_force_best(*b, [] (const multibeep::bandits::arm_info<num_t, rng_t> &ai) {return(num_t(ai.num_pulls));}));
+		BOOST_REQUIRE_EQUAL(lcb->best_identifier(), brute_force_best(*b, [] (const multibeep::bandits::arm_info<num_t, rng_t> &ai) {return(ai.posterior->support(0.05).first);}));
+	}
+
+	auto p = mean->recommendation_distribution();
+	BOOST_REQUIRE_EQUAL(p.size(), 6);
+	BOOST_REQUIRE_EQUAL(p[mean->best_identifier()], 1);
+	BOOST_REQUIRE_SMALL(mean->instantaneous_regret() - (0.5 - 0.1*mean->best_identifier()), 1e-12);
+
+	// new arms are picked up, detached recommenders stay as they are
+	b->remove_recommender(pulled);
+	auto id = b->add_arm(std::make_shared<multibeep::arms::normal_arm<num_t, rng_t> >(1., 1., rng_ptr));
+	b->pull_batch_by_index(b->index_by_identifier(id), 1000);
+	BOOST_REQUIRE_EQUAL(mean->best_identifier(), id);
+	BOOST_REQUIRE_EQUAL(mean->instantaneous_regret(), 0);
+	BOOST_REQUIRE(pulled->best_identifier() != id);
+}
+
+
+BOOST_AUTO_TEST_CASE(test_pmax_recommender){
+	auto rng_ptr = std::make_shared<rng_t>(1234u);
+	auto b = make_bandit(rng_ptr, 4);
+	auto r = std::make_shared<multibeep::recommender::highest_pmax<num_t, rng_t> >();
+	b->add_recommender(r);
+
+	b->min_pull_arms(20);
+	BOOST_REQUIRE(!r->has_recommendation());
+	b->update_p_max(false, 0.01, 64);
+
+	auto p = r->recommendation_distribution();
+	BOOST_REQUIRE_CLOSE(std::accumulate(p.begin(), p.end(), 0.), 1, 1e-6);
+	num_t expected_mean = 0, best_p = 0;
+	for (auto i=0u; i < b->number_of_arms(); i++){
+		auto &ai = (*b)[i];
+		BOOST_REQUIRE_CLOSE(r->score_by_identifier(ai.identifier), ai.p_max, 1e-10);
+		expected_mean += p[ai.identifier]*ai.get_arm_ptr()->real_mean();
+		best_p = std::max(best_p, ai.p_max);
+	}
+	BOOST_REQUIRE_EQUAL(r->best_score(), best_p);
+	BOOST_REQUIRE_SMALL(r->instantaneous_regret() - (0.3 - expected_mean), 1e-12);
+
+	// pulls do not change the recommendation, deactivated arms drop out with the next update
+	auto best = r->best_identifier();
+	b->pull_by_index(0);
+	BOOST_REQUIRE_EQUAL(r->best_identifier(), best);
+	b->deactivate_by_identifier(best);
+	b->update_p_max(false, 0.01, 64);
+	BOOST_REQUIRE(r->best_identifier() != best);
+	BOOST_REQUIRE(std::isnan(r->score_by_identifier(best)));
+
+	// a restored bandit reports everything again
+	auto snapshot = b->checkpoint();
+	auto b2 = make_bandit(rng_ptr, 4);
+	auto r2 = std::make_shared<multibeep::recommender::highest_mean<num_t, rng_t> >();
+	b2->add_recommender(r2);
+	b2->restore(snapshot.data(), snapshot.size());
+	BOOST_REQUIRE_EQUAL(r2->best_identifier(), brute_force_best(*b2, [] (const multibeep::bandits::arm_info<num_t, rng_t> &ai) {return(ai.estimated_mean);}));
+}
+
+
+BOOST_AUTO_TEST_CASE(test_top_k){
+	auto rng_ptr = std::make_shared<rng_t>(1234u);
+	auto b = make_bandit(rng_ptr, 20);
+	auto by_mean = std::make_shared<multibeep::recommender::top_k<num_t, rng_t> >();
+	auto by_lcb = std::make_shared<multibeep::recommender::top_k<num_t, rng_t> >(0.05);
+	b->add_recommender(by_mean);
+	b->add_recommender(by_lcb);
+	b->min_pull_arms(2);
+
+	// brute force: the active arms sorted by the key, the smaller identifier wins ties
+	auto brute_force_top = [&b] (unsigned int k, bool lcb) {
+		std::vector<std::pair<num_t, unsigned int> > v;
+		for (auto i=0u; i < b->number_of_active_arms(); i++){
+			auto &ai = (*b)[i];
+			v.emplace_back(lcb ? ai.posterior->support(0.05).first : ai.estimated_mean, ai.identifier);
+		}
+		std::sort(v.begin(), v.end(), [] (const std::pair<num_t, unsigned int> &a, const std::pair<num_t, unsigned int> &c)
+			{return((a.first > c.first) || ((a.first == c.first) && (a.second < c.second)));});
+		std::vector<unsigned int> ids;
+		for (auto i=0u; (i < k) && (i < v.size()); i++) ids.push_back(v[i].second);
+		return(ids);
+	};
+
+	std::uniform_int_distribution<unsigned int> u(0, 100);
+	for (auto n=0u; n < 300; n++){
+		b->pull_by_index(u(*rng_ptr) % b->number_of_active_arms());
+		if (n == 100) b->deactivate_n_worst(5);
+		if (n == 200) b->reactivate_by_identifier((*b)[b->number_of_active_arms()].identifier);
+
+		// reading the view does not reorder the bandit
+		std::vector<unsigned int> order;
+		for (auto i=0u; i < b->number_of_arms(); i++) order.push_back((*b)[i].identifier);
+		auto top_mean = by_mean->top_identifiers(5);
+		auto top_lcb = by_lcb->top_identifiers(5);
+		for (auto i=0u; i < b->number_of_arms(); i++) BOOST_REQUIRE_EQUAL(order[i], (*b)[i].identifier);
+
+		auto expected_mean = brute_force_top(5, false);
+		auto expected_lcb = brute_force_top(5, true);
+		BOOST_REQUIRE_EQUAL_COLLECTIONS(top_mean.begin(), top_mean.end(), expected_mean.begin(), expected_mean.end());
+		BOOST_REQUIRE_EQUAL_COLLECTIONS(top_lcb.begin(), top_lcb.end(), expected_lcb.begin(), expected_lcb.end());
+		BOOST_REQUIRE_EQUAL(by_mean->number_of_ranked_arms(), b->number_of_active_arms());
+	}
+
+	// asking for more arms than are ranked returns all of them
+	BOOST_REQUIRE_EQUAL(by_mean->top_identifiers(100).size(), b->number_of_active_arms());
+}